@@ -0,0 +1,145 @@
+#include "bench.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+namespace igx::rt::bench {
+
+	static volatile f32 sinkValue;
+
+	f32 sink() {
+		return sinkValue;
+	}
+
+	//Two sided 95% quantile of Student's t; the last entry is used from there on
+
+	static f64 studentT95(u32 degrees) {
+
+		static constexpr f64 table[] = {
+			12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+			2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+			2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+		};
+
+		static constexpr u32 count = u32(sizeof(table) / sizeof(table[0]));
+
+		if (!degrees)
+			return 0;
+
+		return degrees <= count ? table[degrees - 1] : 1.96;
+	}
+
+	Result run(const String &name, u64 ops, f64 raysPerOp, const std::function<f32()> &kernel, u32 runs, f64 minRunMs) {
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		runs = std::max(runs, 2u);
+
+		//Warm up and find how many batches make a run long enough to time
+
+		u32 repeat = 1;
+
+		for (;;) {
+
+			const auto start = Clock::now();
+			f32 acc{};
+
+			for (u32 i = 0; i < repeat; ++i)
+				acc += kernel();
+
+			sinkValue = sinkValue + acc;
+
+			if (std::chrono::duration<f64, std::milli>(Clock::now() - start).count() >= minRunMs || repeat >= (1u << 20))
+				break;
+
+			repeat <<= 1;
+		}
+
+		List<f64> samples(runs);
+
+		for (f64 &sample : samples) {
+
+			const auto start = Clock::now();
+			f32 acc{};
+
+			for (u32 i = 0; i < repeat; ++i)
+				acc += kernel();
+
+			sample = std::chrono::duration<f64, std::nano>(Clock::now() - start).count() / (f64(ops) * repeat);
+			sinkValue = sinkValue + acc;
+		}
+
+		f64 mean{};
+
+		for (f64 sample : samples)
+			mean += sample;
+
+		mean /= runs;
+
+		f64 variance{};
+
+		for (f64 sample : samples)
+			variance += (sample - mean) * (sample - mean);
+
+		const f64 stddev = std::sqrt(variance / (runs - 1));
+
+		std::sort(samples.begin(), samples.end());
+
+		return {
+			name, runs, ops * repeat,
+			mean, samples[runs / 2], stddev, studentT95(runs - 1) * stddev / std::sqrt(f64(runs)),
+			raysPerOp
+		};
+	}
+
+	void print(const List<Result> &results) {
+
+		std::printf("%-24s %12s %10s %10s\n", "Kernel", "ns/op", "ci95", "Mrays/s");
+
+		for (const Result &r : results) {
+
+			if (r.raysPerOp > 0)
+				std::printf("%-24s %12.3f %10.3f %10.2f\n", r.name.c_str(), r.nsPerOp, r.ci95NsPerOp, r.raysPerOp / r.nsPerOp * 1e3);
+
+			else std::printf("%-24s %12.3f %10.3f %10s\n", r.name.c_str(), r.nsPerOp, r.ci95NsPerOp, "-");
+		}
+	}
+
+	bool writeJson(const String &path, const List<Result> &results) {
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		std::ofstream out(file);
+
+		out << "{\"version\":1,\"timestamp\":" << u64(std::time(nullptr)) << ",\"results\":[";
+
+		c8 line[512];
+
+		for (usz i = 0; i < results.size(); ++i) {
+
+			const Result &r = results[i];
+
+			std::snprintf(
+				line, sizeof(line),
+				"%s\n{\"name\":\"%s\",\"runs\":%u,\"opsPerRun\":%llu,\"nsPerOp\":%.4f,\"medianNsPerOp\":%.4f,"
+				"\"stddevNsPerOp\":%.4f,\"ci95NsPerOp\":%.4f,\"mraysPerSecond\":%.4f}",
+				i ? "," : "", r.name.c_str(), r.runs, (unsigned long long) r.opsPerRun,
+				r.nsPerOp, r.medianNsPerOp, r.stddevNsPerOp, r.ci95NsPerOp,
+				r.raysPerOp > 0 ? r.raysPerOp / r.nsPerOp * 1e3 : 0.0
+			);
+
+			out << line;
+		}
+
+		out << "\n]}\n";
+		return bool(out);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include "types/types.hpp"
+#include <chrono>
+#include <functional>
+
+namespace igx::rt::bench {
+
+	//Timing of one kernel; every run does the same batch, so runs are samples of the same distribution
+	//ci95 is the half width of the 95% confidence interval of the mean (Student's t)
+
+	struct Result {
+		String name;
+		u32 runs;
+		u64 opsPerRun;
+		f64 nsPerOp, medianNsPerOp, stddevNsPerOp, ci95NsPerOp;
+		f64 raysPerOp;				//0 if the kernel doesn't trace
+	};
+
+	//Kernel returns a value that's folded into a sink, so the work can't be optimized away
+	//The batch is repeated until a run takes at least minRunMs, then timed runs times
+
+	Result run(const String &name, u64 ops, f64 raysPerOp, const std::function<f32()> &kernel, u32 runs = 31, f64 minRunMs = 2);
+
+	//Table for the console; ns/op, ci95 and Mrays/s
+	void print(const List<Result> &results);
+
+	//Machine readable, for tracking over time; one object per result
+	bool writeJson(const String &path, const List<Result> &results);
+
+	//So the sink is observable
+	f32 sink();
+
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+#pragma once
+#include "types/vec.hpp"
+#include "rt/half.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//C++ ports of the hot shader kernels; keep these in sync with the .glsl they mirror
+//Only what's needed to cost them, e.g. intersections report hitT and not normals or uvs
+
+namespace igx::rt::bench {
+
+	static constexpr f32 noHit = std::numeric_limits<f32>::max();
+	static constexpr f32 pi = 3.1415927410125732421875f;
+
+	struct Ray {
+		Vec3f32 pos, dir;
+	};
+
+	inline f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	inline Vec3f32 cross(const Vec3f32 &a, const Vec3f32 &b) {
+		return Vec3f32(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	inline f32 fract(f32 f) {
+		return f - std::floor(f);
+	}
+
+	//primitive.glsl
+
+	inline bool rayIntersectSphere(const Ray &r, const Vec4f32 &sphere, f32 &hitT, u32 obj, u32 prevObj) {
+
+		const Vec3f32 dif = Vec3f32(sphere.x, sphere.y, sphere.z) - r.pos;
+		const f32 t = dot(dif, r.dir);
+
+		const Vec3f32 Q = dif - r.dir * t;
+		const f32 Q2 = dot(Q, Q);
+		const f32 R2 = sphere.w * sphere.w;
+
+		const bool outOfSphere = Q2 > R2;
+		const f32 sphereT = t - std::sqrt(std::max(R2 - Q2, 0.f));
+
+		if (!outOfSphere && obj != prevObj && sphereT >= 0 && sphereT < hitT) {
+			hitT = sphereT;
+			return true;
+		}
+
+		return false;
+	}
+
+	inline bool rayIntersectPlane(const Ray &r, const Vec4f32 &plane, f32 &hitT, u32 obj, u32 prevObj) {
+
+		const Vec3f32 dir = Vec3f32(plane.x, plane.y, plane.z).normalize();
+		const f32 dif = -dot(r.dir, dir);
+		const f32 planeT = -(-dot(r.pos, dir) + plane.w) / dif;
+
+		if (planeT >= 0 && obj != prevObj && planeT < hitT) {
+			hitT = planeT;
+			return true;
+		}
+
+		return false;
+	}
+
+	inline bool rayIntersectTri(const Ray &r, const Vec3f32 *p, f32 &hitT, u32 obj, u32 prevObj) {
+
+		const Vec3f32 p1_p0 = p[1] - p[0];
+		const Vec3f32 p2_p0 = p[2] - p[0];
+
+		const Vec3f32 h = cross(r.dir, p2_p0);
+		const f32 a = dot(p1_p0, h);
+
+		const f32 f = 1 / a;
+		const Vec3f32 s = r.pos - p[0];
+		const f32 u = f * dot(s, h);
+
+		if (u < 0 || u > 1)
+			return false;
+
+		const Vec3f32 q = cross(s, p1_p0);
+		const f32 v = f * dot(r.dir, q);
+
+		if (v < 0 || u + v > 1)
+			return false;
+
+		const f32 t = f * dot(p2_p0, q);
+
+		if (t <= 0 || obj == prevObj || t >= hitT)
+			return false;
+
+		hitT = t;
+		return true;
+	}
+
+	//Cube is min, max
+
+	inline bool rayIntersectCube(const Ray &r, const Vec3f32 *cube, f32 &hitT, u32 obj, u32 prevObj) {
+
+		const Vec3f32 revDir = Vec3f32(1) / r.dir;
+
+		const Vec3f32 startDir = (cube[0] - r.pos) * revDir;
+		const Vec3f32 endDir = (cube[1] - r.pos) * revDir;
+
+		const f32 tmin = std::max(std::max(std::min(startDir.x, endDir.x), std::min(startDir.y, endDir.y)), std::min(startDir.z, endDir.z));
+		const f32 tmax = std::min(std::min(std::max(startDir.x, endDir.x), std::max(startDir.y, endDir.y)), std::max(startDir.z, endDir.z));
+
+		if (tmax < 0 || tmin > tmax || tmin > hitT || obj == prevObj)
+			return false;
+
+		hitT = tmin;
+		return true;
+	}
+
+	inline Vec2u32 encodeNormal(const Vec3f32 &n) {
+
+		const Vec3f32 nn = n.normalize();
+
+		const u32 x = u32((nn.x * 0.5f + 0.5f) * 65535);
+		const u32 y = u32((nn.y * 0.5f + 0.5f) * 65535);
+		const u32 z = u32((nn.z * 0.5f + 0.5f) * 65535);
+
+		return Vec2u32((x << 16) | y, z);
+	}
+
+	inline Vec3f32 decodeNormal(const Vec2u32 &stored) {
+		return Vec3f32(
+			f32(stored.x >> 16) / 65535 * 2 - 1,
+			f32(stored.x & 65535) / 65535 * 2 - 1,
+			f32(stored.y) / 65535 * 2 - 1
+		);
+	}
+
+	inline Vec3f32 decodeSpheremap(u32 n) {
+
+		f32 x = fromHalf(u16(n)), y = fromHalf(u16(n >> 16));
+
+		const f32 l = -(x * x + y * y - 1);
+		const f32 sl = std::sqrt(l);
+
+		x *= sl;
+		y *= sl;
+
+		return Vec3f32(x * 2, y * 2, l * 2 - 1);
+	}
+
+	//rand_util.glsl
+
+	inline f32 nextRand(u32 &s) {
+		s = 1664525u * s + 1013904223u;
+		return f32(s & 0x00FFFFFF) / f32(0x01000000);
+	}
+
+	inline f32 rand1(const Vec3f32 &co) {
+		return fract(std::sin(dot(co, Vec3f32(12.9898f, 78.233f, 471.28f))) * 43758.5453f);
+	}
+
+	inline Vec3f32 rand(const Vec3f32 &p) {
+		return Vec3f32(rand1(p), rand1(p + Vec3f32(69)), rand1(p + Vec3f32(420)));
+	}
+
+	inline f32 worley(const Vec3f32 &res, const Vec3f32 &pointsRes, const Vec3f32 &offset, const Vec3f32 &floc) {
+
+		const Vec3f32 pointPerPixel = pointsRes / res;
+		const Vec3f32 pixelPerPoint = res / pointsRes;
+
+		const Vec3f32 scaled = floc * pointPerPixel;
+		const Vec3f32 currentPoint(std::floor(scaled.x), std::floor(scaled.y), std::floor(scaled.z));
+
+		f32 squareDist = 1;
+
+		for (i32 k = -1; k <= 1; ++k)
+			for (i32 j = -1; j <= 1; ++j)
+				for (i32 i = -1; i <= 1; ++i) {
+
+					Vec3f32 global = currentPoint + Vec3f32(f32(i), f32(j), f32(k));
+
+					global.x += global.x < 0 ? pointsRes.x : (global.x >= pointsRes.x ? -pointsRes.x : 0);
+					global.y += global.y < 0 ? pointsRes.y : (global.y >= pointsRes.y ? -pointsRes.y : 0);
+					global.z += global.z < 0 ? pointsRes.z : (global.z >= pointsRes.z ? -pointsRes.z : 0);
+
+					global += rand(offset + global);
+
+					const Vec3f32 localPoint = (global * pixelPerPoint - floc) * pointPerPixel;
+					squareDist = std::min(squareDist, dot(localPoint, localPoint));
+				}
+
+		return std::sqrt(squareDist);
+	}
+
+	inline Vec3f32 randomPointOnUnitSphere(f32 u, f32 v) {
+
+		const f32 polarX = 2 * pi * u, polarY = std::acos(1 - 2 * v);
+		const f32 sinX = std::sin(polarX);
+
+		return Vec3f32(sinX * std::cos(polarY), sinX * std::sin(polarY), std::cos(polarX));
+	}
+
+	inline Vec3f32 getSunDirection(f32 u, f32 v, const Vec3f32 &direction, f32 angularExtent) {
+
+		const f32 h = std::cos(angularExtent);
+		const f32 phi = 2 * pi * u;
+
+		const f32 z = h + (1 - h) * v;
+		const f32 sinT = std::sqrt(1 - z * z);
+
+		const Vec3f32 a(std::abs(direction.x), std::abs(direction.y), std::abs(direction.z));
+
+		const u32 xm = u32(a.x - a.y < 0 && a.x - a.z < 0);
+		const u32 ym = a.y - a.z < 0 ? 1 ^ xm : 0;
+		const u32 zm = 1 ^ (xm | ym);
+
+		const Vec3f32 bitangent = cross(direction, Vec3f32(f32(xm), f32(ym), f32(zm)));
+		const Vec3f32 tangent = cross(bitangent, direction);
+
+		return bitangent * (std::cos(phi) * sinT) + tangent * (std::sin(phi) * sinT) + direction * z;
+	}
+
+	//light.glsl; lights are unpacked already (color, radius, origin, falloff)
+
+	struct Light {
+		Vec3f32 pos, dir, color;
+		f32 radius, origin, falloff;
+		bool isPoint;
+	};
+
+	inline f32 ndfGGX(const Vec3f32 &n, const Vec3f32 &h, f32 roughness) {
+
+		const f32 alpha = roughness * roughness;
+		const f32 a2 = alpha * alpha;
+
+		const f32 NdotH = std::max(dot(n, h), 0.f);
+
+		f32 denom = NdotH * NdotH * (a2 - 1) + 1;
+		denom *= denom * pi;
+
+		if (denom == 0)
+			return 0;
+
+		return a2 / denom;
+	}
+
+	inline f32 geomSchlickGGX(f32 NdotV, f32 k) {
+		return NdotV / (NdotV * (1 - k) + k);
+	}
+
+	inline f32 geomSmith(f32 NdotV, f32 NdotL, f32 k) {
+		return geomSchlickGGX(NdotV, k) * geomSchlickGGX(NdotL, k);
+	}
+
+	inline f32 pow5(f32 f) {
+		const f32 f2 = f * f;
+		return f2 * f2 * f;
+	}
+
+	inline Vec3f32 fresnelSchlick(const Vec3f32 &F0, const Vec3f32 &h, const Vec3f32 &v) {
+		return F0 + (Vec3f32(1) - F0) * pow5(1 - std::max(dot(h, v), 0.f));
+	}
+
+	inline Vec3f32 fresnelSchlickRoughness(const Vec3f32 &F0, f32 NdotV, f32 roughness) {
+		const Vec3f32 top(std::max(F0.x, 1 - roughness), std::max(F0.y, 1 - roughness), std::max(F0.z, 1 - roughness));
+		return F0 + (top - F0) * std::pow(1 - NdotV, 5.f);
+	}
+
+	inline Vec3f32 cookTorrance(
+		const Vec3f32 &F0, const Vec3f32 &albedo, const Light &light,
+		const Vec3f32 &n, const Vec3f32 &l, const Vec3f32 &v,
+		f32 NdotV, f32 invSquareDist, f32 roughness, f32 metallic, f32 k, f32 NdotL
+	) {
+		const Vec3f32 h = (l + v).normalize();
+
+		const f32 D = ndfGGX(n, h, std::max(roughness, 0.01f));
+		const f32 G = geomSmith(NdotV, NdotL, k);
+		const Vec3f32 F = fresnelSchlick(F0, h, v);
+
+		const f32 denom = 4 * NdotL * NdotV + 0.001f;
+		const Vec3f32 kS = F * (D * G / denom);
+		const Vec3f32 kD = (Vec3f32(1) - F) * (1 - metallic);
+
+		return (kD * albedo + kS) * light.color * (invSquareDist * NdotL);
+	}
+
+	inline Vec3f32 getDirToLight(const Light &light, const Vec3f32 &pos, f32 &brightness, f32 &dist, f32 u, f32 v) {
+
+		Vec3f32 l;
+		brightness = 1;
+		dist = -1;
+
+		const f32 origin = std::min(light.origin, light.radius);
+
+		if (light.isPoint) {
+
+			l = pos - light.pos;
+			dist = std::sqrt(dot(l, l));
+
+			const Vec3f32 p = light.pos + randomPointOnUnitSphere(u, v) * origin;
+
+			l = pos - p;
+
+			const f32 r = light.radius - origin;
+			const f32 d = std::max(dist - origin, 0.f);
+
+			//smoothstep(r, 0, d)
+			const f32 t = std::clamp((d - r) / (0 - r), 0.f, 1.f);
+
+			brightness = std::pow(t * t * (3 - 2 * t), light.falloff);
+		}
+
+		else l = getSunDirection(u, v, light.dir, light.radius);
+
+		return l.normalize();
+	}
+
+	inline Vec3f32 shadeLight(
+		const Vec3f32 &F0, const Vec3f32 &albedo, f32 roughness, f32 metallic,
+		const Light &light, const Vec3f32 &pos, const Vec3f32 &n, const Vec3f32 &v, f32 NdotV, f32 u, f32 w
+	) {
+		f32 brightness, dist;
+		const Vec3f32 l = getDirToLight(light, pos, brightness, dist, u, w);
+
+		f32 k = roughness + 1;
+		k *= k / 8;
+
+		const f32 NdotL = std::max(dot(n, l), 0.f);
+
+		return cookTorrance(F0, albedo, light, n, l, v, NdotV, brightness, roughness, metallic, k, NdotL);
+	}
+
+}
\ No newline at end of file
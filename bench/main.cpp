@@ -0,0 +1,259 @@
+#include "bench.hpp"
+#include "kernels.hpp"
+#include <cstdio>
+
+using namespace igx::rt::bench;
+
+//Microbenchmarks of the shader kernels (see kernels.hpp), over fixed random rays and primitives
+//Usage: rtigx_bench [json output]; intersections are per ray vs primitive, Mrays/s is against the whole set
+
+static constexpr u32 rayCount = 1024, primitiveCount = 64, pointCount = 4096;
+
+static Vec3f32 randomVec(u32 &s, f32 min, f32 max) {
+	return Vec3f32(
+		nextRand(s) * (max - min) + min,
+		nextRand(s) * (max - min) + min,
+		nextRand(s) * (max - min) + min
+	);
+}
+
+static Vec3f32 randomDir(u32 &s) {
+
+	for (;;) {
+
+		const Vec3f32 d = randomVec(s, -1, 1);
+		const f32 l2 = dot(d, d);
+
+		if (l2 > 1e-4f && l2 <= 1)
+			return d.normalize();
+	}
+}
+
+int main(int argc, char *argv[]) {
+
+	const String output = argc > 1 ? argv[1] : "./output/bench.json";
+
+	u32 s = 1;
+
+	//Rays start around the origin and primitives are in a 20^3 box, so roughly half of the tests hit
+
+	List<Ray> rays(rayCount);
+
+	for (Ray &r : rays)
+		r = { randomVec(s, -2, 2), randomDir(s) };
+
+	List<Vec4f32> spheres(primitiveCount), planes(primitiveCount);
+	List<Vec3f32> triangles(primitiveCount * 3), cubes(primitiveCount * 2);
+
+	for (Vec4f32 &sphere : spheres) {
+		const Vec3f32 p = randomVec(s, -10, 10);
+		sphere = Vec4f32(p.x, p.y, p.z, nextRand(s) * 2 + 0.5f);
+	}
+
+	for (Vec4f32 &plane : planes) {
+		const Vec3f32 d = randomDir(s);
+		plane = Vec4f32(d.x, d.y, d.z, nextRand(s) * 20 - 10);
+	}
+
+	for (u32 i = 0; i < primitiveCount; ++i) {
+
+		const Vec3f32 center = randomVec(s, -10, 10);
+
+		for (u32 j = 0; j < 3; ++j)
+			triangles[i * 3 + j] = center + randomVec(s, -2, 2);
+
+		const Vec3f32 size = randomVec(s, 0.5f, 3);
+
+		cubes[i * 2] = center;
+		cubes[i * 2 + 1] = center + size;
+	}
+
+	List<Vec3f32> normals(pointCount), points(pointCount);
+	List<u32> spheremaps(pointCount);
+
+	for (u32 i = 0; i < pointCount; ++i) {
+
+		normals[i] = randomDir(s);
+		points[i] = randomVec(s, 0, 128);
+
+		//Valid spheremap encodings are within the unit disk
+
+		const f32 x = nextRand(s) * 1.4f - 0.7f, y = nextRand(s) * 1.4f - 0.7f;
+		spheremaps[i] = u32(igx::rt::toHalf(x)) | (u32(igx::rt::toHalf(y)) << 16);
+	}
+
+	Light pointLight{ Vec3f32(0, 5, 0), Vec3f32(0, -1, 0), Vec3f32(1, 0.9f, 0.8f), 20, 0.5f, 2, true };
+	Light sun{ Vec3f32(0), Vec3f32(0.3f, -0.8f, 0.5f).normalize(), Vec3f32(1), 0.01f, 0, 1, false };
+
+	const u64 tests = u64(rayCount) * primitiveCount;
+	const f64 perSet = 1.0 / primitiveCount;
+
+	List<Result> results;
+
+	results.push_back(run("rayIntersectSphere", tests, perSet, [&]() {
+
+		f32 acc{};
+
+		for (const Ray &r : rays) {
+
+			f32 hitT = noHit;
+
+			for (u32 i = 0; i < primitiveCount; ++i)
+				rayIntersectSphere(r, spheres[i], hitT, i, 0xFFFFFFFF);
+
+			acc += hitT != noHit ? hitT : 0;
+		}
+
+		return acc;
+	}));
+
+	results.push_back(run("rayIntersectTri", tests, perSet, [&]() {
+
+		f32 acc{};
+
+		for (const Ray &r : rays) {
+
+			f32 hitT = noHit;
+
+			for (u32 i = 0; i < primitiveCount; ++i)
+				rayIntersectTri(r, triangles.data() + i * 3, hitT, i, 0xFFFFFFFF);
+
+			acc += hitT != noHit ? hitT : 0;
+		}
+
+		return acc;
+	}));
+
+	results.push_back(run("rayIntersectCube", tests, perSet, [&]() {
+
+		f32 acc{};
+
+		for (const Ray &r : rays) {
+
+			f32 hitT = noHit;
+
+			for (u32 i = 0; i < primitiveCount; ++i)
+				rayIntersectCube(r, cubes.data() + i * 2, hitT, i, 0xFFFFFFFF);
+
+			acc += hitT != noHit ? hitT : 0;
+		}
+
+		return acc;
+	}));
+
+	results.push_back(run("rayIntersectPlane", tests, perSet, [&]() {
+
+		f32 acc{};
+
+		for (const Ray &r : rays) {
+
+			f32 hitT = noHit;
+
+			for (u32 i = 0; i < primitiveCount; ++i)
+				rayIntersectPlane(r, planes[i], hitT, i, 0xFFFFFFFF);
+
+			acc += hitT != noHit ? hitT : 0;
+		}
+
+		return acc;
+	}));
+
+	//Same loops as traceGeometry, every list once
+
+	results.push_back(run("traceGeometry (4x64)", tests * 4, perSet / 4, [&]() {
+
+		f32 acc{};
+
+		for (const Ray &r : rays) {
+
+			f32 hitT = noHit;
+			u32 j = 0;
+
+			for (u32 i = 0; i < primitiveCount; ++i, ++j)
+				rayIntersectTri(r, triangles.data() + i * 3, hitT, j, 0xFFFFFFFF);
+
+			for (u32 i = 0; i < primitiveCount; ++i, ++j)
+				rayIntersectSphere(r, spheres[i], hitT, j, 0xFFFFFFFF);
+
+			for (u32 i = 0; i < primitiveCount; ++i, ++j)
+				rayIntersectCube(r, cubes.data() + i * 2, hitT, j, 0xFFFFFFFF);
+
+			for (u32 i = 0; i < primitiveCount; ++i, ++j)
+				rayIntersectPlane(r, planes[i], hitT, j, 0xFFFFFFFF);
+
+			acc += hitT != noHit ? hitT : 0;
+		}
+
+		return acc;
+	}));
+
+	results.push_back(run("encodeNormal+decode", pointCount, 0, [&]() {
+
+		f32 acc{};
+
+		for (const Vec3f32 &n : normals)
+			acc += decodeNormal(encodeNormal(n)).x;
+
+		return acc;
+	}));
+
+	results.push_back(run("decodeSpheremap", pointCount, 0, [&]() {
+
+		f32 acc{};
+
+		for (u32 n : spheremaps)
+			acc += decodeSpheremap(n).z;
+
+		return acc;
+	}));
+
+	//Same setup as the HQ cloud noise; 128^3 with the first layer of points
+
+	results.push_back(run("worley", pointCount, 0, [&]() {
+
+		f32 acc{};
+
+		for (const Vec3f32 &p : points)
+			acc += worley(Vec3f32(128), Vec3f32(47, 61, 46), Vec3f32(0.3f, 0.7f, 0.1f), p);
+
+		return acc;
+	}));
+
+	//Point light and sun for every surface sample; albedo, roughness and metallic vary with the sample
+
+	results.push_back(run("shadeLight", u64(pointCount) * 2, 0, [&]() {
+
+		f32 acc{};
+		u32 i{};
+
+		for (const Vec3f32 &n : normals) {
+
+			const Vec3f32 &pos = points[i];
+			const Vec3f32 &v = normals[(i + 1) % pointCount];
+
+			const f32 roughness = f32(i & 255) / 255, metallic = f32((i >> 8) & 15) / 15;
+			const Vec3f32 albedo(0.8f, 0.5f, roughness);
+			const Vec3f32 F0 = Vec3f32(0.04f) * (1 - metallic) + albedo * metallic;
+
+			const f32 NdotV = std::max(-dot(v, n), 0.f);
+			const f32 u = f32(i) / pointCount;
+
+			acc += shadeLight(F0, albedo, roughness, metallic, pointLight, pos, n, v, NdotV, u, 1 - u).x;
+			acc += shadeLight(F0, albedo, roughness, metallic, sun, pos, n, v, NdotV, u, 1 - u).y;
+
+			++i;
+		}
+
+		return acc;
+	}));
+
+	print(results);
+
+	if (!writeJson(output, results)) {
+		std::printf("Couldn't write %s\n", output.c_str());
+		return 1;
+	}
+
+	std::printf("Wrote %s (sink %f)\n", output.c_str(), f64(sink()));
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//CPU mirror of accumulation.glsl
+
+	static constexpr usz accumulationBytesPerPixel = sizeof(f32) * 4;
+	static constexpr usz compactAccumulationBytesPerPixel = sizeof(u16) * 4 + sizeof(u8) * 4;
+
+	//rgba16f running mean + rgba8 residual (in half ulps)
+	//Alpha is the rms luminance, like on the GPU
+
+	struct CompactAccumulator {
+
+		u16 mean[4]{};
+		u8 residual[4]{};
+
+		//Add the nth sample (starting at 1)
+		void add(const Vec4f32 &value, u32 samples);
+
+		Vec4f32 get() const;
+	};
+
+}
\ No newline at end of file
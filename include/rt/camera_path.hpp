@@ -0,0 +1,63 @@
+#pragma once
+#include "types/types.hpp"
+#include <fstream>
+
+namespace igx::rt {
+
+	//Recorded flythrough; per frame the timestep and, only if they changed, the camera and properties
+	//Snapshots are opaque here (see RaytracingInterface); their sizes are in the header, so a different build can't misread them
+
+	struct CameraPath {
+
+		struct Frame {
+			f64 dt;
+			u32 camera, properties;			//Snapshot that's current at this frame
+		};
+
+		u32 cameraSize{}, propertiesSize{};
+
+		List<Frame> frames;
+		List<u8> cameras, properties;		//Snapshots back to back
+
+		inline const u8 *getCamera(const Frame &frame) const { return cameras.data() + usz(frame.camera) * cameraSize; }
+		inline const u8 *getProperties(const Frame &frame) const { return properties.data() + usz(frame.properties) * propertiesSize; }
+	};
+
+	//Binary; magic, version, the sizes above and then the frames as they come in
+	//Nothing has to be patched at the end, so a recording that was cut short is still readable
+
+	class CameraPathRecorder {
+
+		std::ofstream out;
+		List<u8> lastCamera, lastProperties;
+
+		u32 frames{};
+
+	public:
+
+		bool begin(const String &path, u32 cameraSize, u32 propertiesSize);
+		void add(f64 dt, const void *camera, const void *properties);
+		bool end();
+
+		inline bool isRecording() const { return out.is_open(); }
+		inline u32 size() const { return frames; }
+	};
+
+	bool readCameraPath(const String &path, CameraPath &cameraPath);
+
+	//Nearest rank percentiles
+
+	struct FrameTimeStats {
+		u32 frames;
+		f64 meanMs, p50Ms, p95Ms, p99Ms, maxMs;
+	};
+
+	FrameTimeStats frameTimeStats(List<f64> frameMs);
+
+	//"p50 / p95 / p99 / max ms (frames)"
+	String frameTimeReport(const FrameTimeStats &stats);
+
+	//Json with the summary and every frame, for comparing runs of the same path
+	bool writeFrameTimes(const String &path, const FrameTimeStats &stats, const List<f64> &frameMs);
+
+}
\ No newline at end of file
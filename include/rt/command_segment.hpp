@@ -0,0 +1,46 @@
+#pragma once
+#include "helpers/render_task.hpp"
+
+namespace igx::rt {
+
+	//A part of the frame's commands (e.g. one render task)
+	//It is only re-recorded when its owner is dirty, so the frame is just a list of segments
+
+	class CommandSegment {
+
+		CommandListRef commands;
+		String name;
+		bool isDirty = true;
+
+	public:
+
+		CommandSegment(Graphics &g, const String &name, usz size = 16_KiB);
+
+		inline void markDirty() { isDirty = true; }
+		inline CommandList *get() const { return commands; }
+		inline const String &getName() const { return name; }
+
+		//Returns true if the segment was re-recorded
+
+		template<typename Recorder>
+		inline bool record(bool needsUpdate, Recorder &&recorder) {
+
+			if (!isDirty && !needsUpdate)
+				return false;
+
+			commands->clear();
+			recorder(get());
+
+			isDirty = false;
+			return true;
+		}
+
+		inline bool record(RenderTask *task) {
+			return record(
+				task->needsCommandUpdate(), 
+				[task](CommandList *cl) { task->prepareCommandList(cl); }
+			);
+		}
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//CPU reference of the denoiser (denoise_temporal.comp + denoise_atrous.comp; see denoise.glsl)
+	//Used to regression test the GPU output against stored images
+
+	struct DenoiseSettings {
+
+		f32 sigmaL = 4, sigmaN = 128, sigmaZ = 0.05f;
+		u32 maxHistory = 32, iterations = 5;
+
+	};
+
+	//Row major rgba32f image
+
+	struct DenoiseImage {
+
+		Vec2u32 size;
+		List<Vec4f32> pixels;
+
+		DenoiseImage(const Vec2u32 &size = {}): size(size), pixels(usz(size.x) * size.y) {}
+
+		inline bool contains(const Vec2i32 &loc) const {
+			return loc.x >= 0 && loc.y >= 0 && u32(loc.x) < size.x && u32(loc.y) < size.y;
+		}
+
+		inline Vec4f32 &operator[](const Vec2i32 &loc) { return pixels[usz(loc.y) * size.x + loc.x]; }
+		inline const Vec4f32 &operator[](const Vec2i32 &loc) const { return pixels[usz(loc.y) * size.x + loc.x]; }
+	};
+
+	//Persistent between frames, same layout as the GPU's history and moments textures
+	//history: rgb, hitT
+	//moments: mean lum, mean lum^2, object, surface (packed normal and history length; see denoise.glsl)
+
+	struct DenoiseState {
+		DenoiseImage history, moments;
+	};
+
+	//Eye and image plane (world space); like Camera for the default projection
+
+	struct DenoiseCamera {
+		Vec3f32 eye, p0, p1, p2;
+	};
+
+	//Input of one frame
+	//lighting: rgb
+	//gBuffer: xyz normal, w hitT (negative for no hit)
+	//hits: xyz world position, w object id (as bits)
+
+	struct DenoiseFrame {
+		DenoiseImage lighting, gBuffer, hits;
+	};
+
+	//Returns the filtered lighting and updates the state for the next frame
+	//Previous camera is null if the history can't be reprojected (first frame or after resize)
+
+	DenoiseImage denoiseReference(
+		const DenoiseFrame &frame,
+		const DenoiseCamera *previous,
+		DenoiseState &state, 
+		const DenoiseSettings &settings = {}
+	);
+
+	//Root mean square difference of rgb; for comparing against a stored (GPU) image
+	f64 denoiseDifference(const DenoiseImage &a, const DenoiseImage &b);
+
+}
\ No newline at end of file
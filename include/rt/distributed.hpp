@@ -0,0 +1,35 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//Export of one worker; the sum of its samples, so partials of disjoint sample ranges add up
+	//Workers render [sampleStart, sampleStart + samples> of the same sequence (see Seed::sampleStart)
+
+	struct PartialAccumulation {
+		u32 width{}, height{}, sampleStart{}, samples{};
+		List<f32> sum;				//rgba32f
+	};
+
+	//Binary; magic, version, the header above and the sums
+
+	bool writePartialAccumulation(const String &path, const PartialAccumulation &partial);
+	bool readPartialAccumulation(const String &path, PartialAccumulation &partial);
+
+	//Adds up partials; false if the sizes differ or the sample ranges overlap
+
+	bool mergePartialAccumulations(const List<PartialAccumulation> &partials, PartialAccumulation &result);
+
+	//Where worker i writes its partial; next to the output, so a shared directory is enough as transport
+
+	String partialAccumulationPath(const String &targetOutput, u32 worker);
+
+	//Samples [start, end> of targetSamples that worker i of workerCount renders
+
+	Vec2u32 workerSampleRange(u32 targetSamples, u32 worker, u32 workerCount);
+
+	//Coordinator; merges the partials of every worker and writes the mean to <targetOutput>_merged.pfm
+
+	bool mergeDistributedExport(const String &targetOutput, u32 workerCount);
+
+}
\ No newline at end of file
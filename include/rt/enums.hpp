@@ -9,7 +9,9 @@ namespace igx::rt {
 		EDITOR_CAMERA,
 		EDITOR_CLOUDS,
 		EDITOR_DEBUG,
-		EDITOR_CLOUD_NOISE
+		EDITOR_CLOUD_NOISE,
+		EDITOR_CLOUD_SHADOW,
+		EDITOR_PROFILER
 	};
 
 	oicExposedEnum(
@@ -0,0 +1,51 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//Equirect mapping of sampleEquirect (scene.glsl); uv (0, 0) is the top left of the skybox
+
+	Vec3f32 equirectDirection(const Vec2f32 &uv);
+	Vec2f32 equirectUv(const Vec3f32 &dir);
+
+	//Gradient sky, dark ground and (optionally) a small, very bright sun; rgb32f, top row first
+	List<f32> generateTestSky(u32 width, u32 height, bool sun = true);
+
+	//Importance map over the equirect skybox (see env_sampling.glsl)
+	//Cells are picked proportional to luminance * cos(latitude), which is sin(theta) from the pole
+
+	//std430; followed by the marginal cdf (height + 1) and a cdf per row (height * (width + 1))
+
+	struct EnvironmentHeader {
+		u32 width, height, enabled, pad0;
+	};
+
+	class EnvironmentMap {
+
+		List<f32> cdf;
+		u32 width{}, height{};
+
+		void buildRows(const List<f32> &rgb, u32 srcWidth, u32 srcHeight, u32 start, u32 end, List<f32> &rowSums);
+
+		u32 findInterval(usz offset, u32 count, f32 u) const;
+
+	public:
+
+		static constexpr u32 maxWidth = 1024, maxHeight = 512;
+
+		//Rows are split over threads (0 = hardware concurrency); larger images are averaged into maxWidth x maxHeight cells
+		void build(const List<f32> &rgb, u32 srcWidth, u32 srcHeight, u32 threads = 0);
+
+		//Direction towards the sky (inverse of sampleEquirect) and its solid angle pdf
+		Vec3f32 sample(const Vec2f32 &u, f32 &pdf) const;
+		f32 pdf(const Vec3f32 &dir) const;
+
+		//Header and cdfs as the GPU expects them; disabled if nothing was built
+		List<u8> getGPUData() const;
+
+		inline bool empty() const { return cdf.empty(); }
+		inline u32 getWidth() const { return width; }
+		inline u32 getHeight() const { return height; }
+	};
+
+}
\ No newline at end of file
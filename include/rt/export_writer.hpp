@@ -0,0 +1,60 @@
+#pragma once
+#include "types/types.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace igx::rt {
+
+	//Writes exports on a background thread, so the render thread only hands over the readback
+	//The queue is bounded; push blocks while it's full, so a slow disk can't pile up 8K frames in memory
+
+	class ExportWriter {
+
+	public:
+
+		//Runs on the writer thread
+		using Callback = std::function<void(const String &path, bool success, f64 ms)>;
+
+		struct Job {
+			String path;
+			std::function<bool()> write;
+			Callback onFinish;
+		};
+
+	private:
+
+		std::deque<Job> jobs;
+		usz capacity;
+
+		mutable std::mutex mutex;
+		std::condition_variable hasJob, hasSpace, isIdle;
+
+		bool isWriting{}, shouldStop{};
+
+		std::thread worker;
+
+		void run();
+
+	public:
+
+		ExportWriter(usz capacity = 2);
+		~ExportWriter();
+
+		ExportWriter(const ExportWriter&) = delete;
+		ExportWriter(ExportWriter&&) = delete;
+
+		ExportWriter &operator=(const ExportWriter&) = delete;
+		ExportWriter &operator=(ExportWriter&&) = delete;
+
+		void push(Job &&job);
+
+		//Blocks until every job is written
+		void wait();
+
+		usz pending() const;
+	};
+
+}
\ No newline at end of file
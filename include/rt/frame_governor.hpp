@@ -0,0 +1,77 @@
+#pragma once
+#include "types/types.hpp"
+#include <algorithm>
+
+namespace igx::rt {
+
+	//How much work a frame does, relative to what's set in the UI
+
+	struct FrameBudget {
+		f32 resolutionScale;		//Of the output size (per axis); upscaled by the composite
+		f32 shadowSamples;			//Of ShadowProperties::Shadow_samples
+		f32 cloudSamples;			//Of CloudBuffer::Samples and Light_samples
+	};
+
+	//Levels from full quality to the cheapest; samples go first, since they cost less to look at than resolution
+
+	u32 frameBudgetLevels();
+	const FrameBudget &getFrameBudget(u32 level);
+
+	//Estimated cost of a level, relative to the first (1); only for how far to drop and whether a raise would fit
+	f64 frameBudgetCost(u32 level);
+
+	//Samples at a fraction of requested; never 0 unless that's what was asked for
+	inline u32 budgetSamples(u32 requested, f32 fraction) {
+		return requested ? std::max(u32(f32(requested) * fraction + 0.5f), 1u) : 0;
+	}
+
+	struct FrameGovernorInfo {
+
+		f64 targetMs = 1000.0 / 60;
+
+		//Hysteresis; drops above targetMs * (1 + headroom), raises only if the next level is estimated below targetMs * (1 - headroom)
+		f64 headroom = 0.1;
+
+		//Weight of a frame in the moving average
+		f64 smoothing = 0.1;
+
+		//Frames after a change that aren't measured (resizing and the first frames at a new level)
+		u32 settleFrames = 8;
+
+		//Frames at a level before raising; doubled every time a raise is dropped again right away, up to maxBackoff times
+		u32 holdFrames = 60, maxBackoff = 4;
+	};
+
+	//Picks a level every frame from the frame time; dropping as far as needed at once, raising one level at a time
+
+	class FrameGovernor {
+
+		FrameGovernorInfo info;
+
+		f64 averageMs{}, decisionMs{};		//Decision is the average the last change was made on
+		u32 level{}, previousLevel{}, measured{}, settle{}, framesAtLevel{}, framesSinceRaise{}, backoff{};
+		bool hasRaised{};
+
+		void setLevel(u32 next);
+
+	public:
+
+		FrameGovernor(const FrameGovernorInfo &info = {}): info(info) { reset(); }
+
+		//Back to full quality and forget the history; the first frames after aren't measured either
+		void reset();
+
+		inline void setTarget(f64 targetMs) { info.targetMs = targetMs; }
+
+		//True if the level changed
+		bool update(f64 frameMs);
+
+		inline u32 getLevel() const { return level; }
+		inline const FrameBudget &getBudget() const { return getFrameBudget(level); }
+		inline f64 getAverageMs() const { return averageMs; }
+
+		//Why the last change happened, for the log; "21.3 ms > 18.3 ms, level 0 -> 2 (res 100%, shadows 50%, clouds 50%)"
+		String report() const;
+	};
+
+}
\ No newline at end of file
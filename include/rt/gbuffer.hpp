@@ -0,0 +1,24 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//CPU mirror of the packed G-buffer (see gbuffer.glsl)
+	//x: hitT, y: octahedral normal (snorm 16:16), z: uv (half 16:16), w: object
+
+	struct GBufferTexel {
+		f32 hitT;
+		Vec3f32 normal;
+		Vec2f32 uv;
+		u32 object;
+	};
+
+	static constexpr usz gBufferBytesPerPixel = sizeof(u32) * 4;
+
+	u32 encodeOctNormal(const Vec3f32 &n);
+	Vec3f32 decodeOctNormal(u32 stored);
+
+	Vec4u32 encodeGBuffer(const GBufferTexel &texel);
+	GBufferTexel decodeGBuffer(const Vec4u32 &stored);
+
+}
\ No newline at end of file
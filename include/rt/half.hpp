@@ -0,0 +1,68 @@
+#pragma once
+#include "types/types.hpp"
+#include <cstring>
+#include <cmath>
+
+namespace igx::rt {
+
+	//GLSL packHalf2x16 / unpackHalf2x16 (round to nearest even)
+
+	inline u16 toHalf(f32 f) {
+
+		u32 x;
+		std::memcpy(&x, &f, sizeof(x));
+
+		const u32 sign = (x >> 16) & 0x8000, floatExp = (x >> 23) & 0xFF;
+		const i32 exp = i32(floatExp) - 127 + 15;
+		u32 mant = x & 0x7FFFFF;
+
+		if (floatExp == 0xFF)
+			return u16(sign | 0x7C00 | (mant ? 0x200 : 0));
+
+		if (exp >= 31)
+			return u16(sign | 0x7C00);
+
+		//Subnormal or zero
+
+		if (exp <= 0) {
+
+			if (exp < -10)
+				return u16(sign);
+
+			mant |= 0x800000;
+
+			const u32 shift = u32(14 - exp), rem = mant & ((1 << shift) - 1), halfway = 1 << (shift - 1);
+			u32 h = mant >> shift;
+
+			if (rem > halfway || (rem == halfway && (h & 1)))
+				++h;
+
+			return u16(sign | h);
+		}
+
+		u32 h = (u32(exp) << 10) | (mant >> 13);
+		const u32 rem = mant & 0x1FFF;
+
+		if (rem > 0x1000 || (rem == 0x1000 && (h & 1)))
+			++h;
+
+		return u16(sign | h);
+	}
+
+	inline f32 fromHalf(u16 h) {
+
+		const u32 sign = (h & 0x8000) << 16, exp = (h >> 10) & 31, mant = h & 1023;
+
+		if (!exp) {
+			const f32 v = std::ldexp(f32(mant), -24);
+			return sign ? -v : v;
+		}
+
+		const u32 x = sign | (exp == 31 ? 0x7F800000 | (mant << 13) : ((exp + 112) << 23) | (mant << 13));
+
+		f32 res;
+		std::memcpy(&res, &x, sizeof(res));
+		return res;
+	}
+
+}
\ No newline at end of file
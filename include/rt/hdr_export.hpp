@@ -0,0 +1,17 @@
+#pragma once
+#include "types/types.hpp"
+
+namespace igx::rt {
+
+	//rgba32f to rgba16f (round to nearest even, same as toHalf)
+	//Uses F16C 8 floats at a time if the cpu supports it
+
+	void convertToHalf(const f32 *in, u16 *out, usz count);
+
+	//Splits the conversion over threads in row bands (threads = 0 uses every core)
+
+	void convertToHalf(const f32 *in, u16 *out, u32 width, u32 height, u32 threads = 0);
+
+	bool hasHalfConversion();
+
+}
\ No newline at end of file
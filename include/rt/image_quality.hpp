@@ -0,0 +1,80 @@
+#pragma once
+#include "rt/denoise_reference.hpp"
+
+namespace igx::rt {
+
+	//Error of an HDR image (rgb of a DenoiseImage) against a reference, on what's displayed:
+	//tonemapped (c / (1 + c)) and gamma 2.2, so every metric is in [0, 1]
+
+	struct ImageQuality {
+		f64 rmse, psnr, flip;
+	};
+
+	f64 imageRmse(const DenoiseImage &image, const DenoiseImage &reference);
+
+	//dB; infinite if the images are the same
+	f64 imagePsnr(const DenoiseImage &image, const DenoiseImage &reference);
+
+	//Mean LDR-FLIP (Andersson et al. 2020); colour difference after contrast sensitivity filtering, raised by edge and point differences
+	//pixelsPerDegree is the viewing condition (67 is a 0.7m wide 4K monitor at 0.7m)
+	f64 imageFlip(const DenoiseImage &image, const DenoiseImage &reference, f32 pixelsPerDegree = 67);
+
+	ImageQuality imageQuality(const DenoiseImage &image, const DenoiseImage &reference);
+
+	//Cached reference; magic, version, the key of what was rendered, size, samples and rgba32f pixels
+	//Reading fails if the key is different, so a changed scene or setting renders a new one
+
+	bool writeReferenceImage(const String &path, u64 key, u32 samples, const DenoiseImage &image);
+	bool readReferenceImage(const String &path, u64 key, DenoiseImage &image);
+
+	//Same filter as upscale.comp; bilinear, clamped to the centers of the edge texels
+	DenoiseImage upscaleImage(const DenoiseImage &image, const Vec2u32 &size);
+
+	//What a quality run renders with; the knobs that trade time for noise
+
+	struct QualityConfig {
+		String name;
+		u32 shadowSamples = 1;		//Per pixel and frame (ShadowProperties::Shadow_samples)
+		bool denoise{};				//Denoise every frame instead of accumulating; samples are frames of temporal history then
+		f32 resolutionScale = 1;	//Rendered at this scale and upscaled (see CompositeTask::setRenderScale)
+		f32 adaptiveError{};		//Tiles below this relative error stop taking samples; 0 = uniform (see CompositeTask::setAdaptiveSampling)
+	};
+
+	//Point of a curve; ms is wall clock of every frame up to and including this one (update, recording and the GPU, waited on)
+
+	struct QualityPoint {
+		u32 samples;
+		f64 ms;
+		ImageQuality quality;
+	};
+
+	struct QualityCurve {
+		QualityConfig config;
+		List<QualityPoint> points;
+	};
+
+	//Rendered by the GPU (see RaytracingInterface::measureQualityPerTime) and read back as HDR.
+	//Every config is compared at each power of two up to maxSamples; the reference accumulates
+	//referenceSamples with referenceShadowSamples at full resolution once and is cached
+
+	struct QualityBenchmarkInfo {
+		u32 maxSamples = 256, referenceSamples = 4096, referenceShadowSamples = 4;
+		String referencePath = "./output/quality_reference.bin";
+	};
+
+	//Default configs; samples only, more shadow samples, denoised, half resolution and adaptive sampling
+	List<QualityConfig> defaultQualityConfigs();
+
+	//First point of the curve that reaches the FLIP target; false if none does
+	bool timeToTarget(const QualityCurve &curve, f64 targetFlip, f64 &ms);
+
+	//Config that reaches the FLIP target in the least time; -1 if none does
+	i32 cheapestToTarget(const List<QualityCurve> &curves, f64 targetFlip, f64 &ms);
+
+	//Time the baseline needs for the FLIP target over the time of curve (equal error); 0 if either doesn't reach it
+	f64 equalErrorSpeedup(const QualityCurve &baseline, const QualityCurve &curve, f64 targetFlip);
+
+	//Csv with a header row; one row per point
+	bool writeQualityCurves(const String &path, const List<QualityCurve> &curves);
+
+}
\ No newline at end of file
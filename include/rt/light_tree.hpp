@@ -0,0 +1,68 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//Light hierarchy over the point lights (see light_tree.glsl)
+	//Traversed stochastically on the GPU; every node is picked proportional to its estimated contribution
+
+	struct LightTreeInput {
+
+		Vec3f32 pos;
+		f32 range;			//No contribution outside of this distance
+
+		Vec3f32 axis;
+		f32 cosTheta;		//Emission cone around axis; -1 for omnidirectional
+
+		f32 power;
+	};
+
+	//std430; children are always stored after their parent and next to each other
+
+	struct LightNode {
+
+		Vec3f32 boundsMin;
+		u32 child;			//Left child (right = child + 1) or leafBit | light index
+
+		Vec3f32 boundsMax;
+		f32 power;
+
+		Vec3f32 axis;
+		f32 cosTheta;
+
+		f32 range;
+		u32 pad0[3];
+	};
+
+	class LightTree {
+
+		List<LightNode> nodes;
+		List<u32> leaves;		//Node per light
+
+		u32 firstLight{};
+
+		void build(u32 node, List<u32> &order, usz start, usz end, const List<LightTreeInput> &lights);
+
+	public:
+
+		static constexpr u32 leafBit = 1u << 31, noLight = u32(-1);
+
+		//Light indices are offset by firstLight, so they can index the scene's light buffer
+		void build(const List<LightTreeInput> &lights, u32 firstLight = 0);
+
+		//Update bounds, cones and power; the topology stays the same (lights.size() has to match)
+		void refit(const List<LightTreeInput> &lights);
+
+		//Returns the light index (noLight if nothing reaches pos) and the probability it was picked with
+		u32 pick(const Vec3f32 &pos, const Vec3f32 &n, f32 u, f32 &pdf) const;
+
+		static f32 importance(const LightNode &node, const Vec3f32 &pos, const Vec3f32 &n);
+
+		//Point lights from the scene's light buffer (GPU layout)
+		static List<LightTreeInput> fromSceneLights(const u8 *lights, usz count);
+
+		inline const List<LightNode> &getNodes() const { return nodes; }
+		inline usz size() const { return leaves.size(); }
+	};
+
+}
\ No newline at end of file
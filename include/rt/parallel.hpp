@@ -0,0 +1,39 @@
+#pragma once
+#include "types/types.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace igx::rt {
+
+	//Splits [0, count) into contiguous ranges; f(start, end) runs once per range on its own thread
+	//threads = 0 uses every core; blocks until all ranges are done
+
+	template<typename F>
+	inline void parallelFor(u32 count, u32 threads, F &&f) {
+
+		if (!threads)
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+		threads = std::min(threads, count);
+
+		if (threads <= 1) {
+
+			if (count)
+				f(0u, count);
+
+			return;
+		}
+
+		List<std::thread> workers;
+		workers.reserve(threads - 1);
+
+		for (u32 i = 1; i < threads; ++i)
+			workers.push_back(std::thread(f, u32(u64(count) * i / threads), u32(u64(count) * (i + 1) / threads)));
+
+		f(0u, u32(count / threads));
+
+		for (std::thread &t : workers)
+			t.join();
+	}
+
+}
\ No newline at end of file
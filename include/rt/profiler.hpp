@@ -0,0 +1,85 @@
+#pragma once
+#include "types/types.hpp"
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+namespace igx::rt {
+
+	//Rolling history of timed events; CPU phases are scoped, GPU passes are added by whoever measured them
+	//Thread safe, so the export writer can report too
+
+	class Profiler {
+
+	public:
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		enum Track : u32 {
+			CPU,
+			GPU
+		};
+
+		struct Event {
+			String name;
+			Track track;
+			f64 startMs, durationMs;
+		};
+
+		//Over the history
+		struct Summary {
+			String name;
+			Track track;
+			u32 count;
+			f64 averageMs, maxMs, lastMs;
+		};
+
+		class Scope {
+
+			Profiler &profiler;
+			String name;
+			Clock::time_point start;
+
+		public:
+
+			inline Scope(Profiler &profiler, const String &name): profiler(profiler), name(name), start(Clock::now()) {}
+			inline ~Scope() { profiler.add(name, CPU, start, std::chrono::duration<f64, std::milli>(Clock::now() - start).count()); }
+
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) = delete;
+
+			Scope &operator=(const Scope&) = delete;
+			Scope &operator=(Scope&&) = delete;
+		};
+
+	private:
+
+		std::deque<Event> events;
+		usz capacity;
+
+		Clock::time_point origin;
+
+		mutable std::mutex mutex;
+
+	public:
+
+		Profiler(usz capacity = 8192);
+
+		inline Scope scope(const String &name) { return Scope(*this, name); }
+
+		void add(const String &name, Track track, Clock::time_point start, f64 durationMs);
+
+		//In order of first appearance
+		List<Summary> summarize() const;
+
+		//One line per name; "name: average / max ms"
+		String report(Track track) const;
+
+		//Chrome trace event format (chrome://tracing, Perfetto); one thread per track
+		bool writeChromeTrace(const String &path) const;
+
+		usz size() const;
+		void clear();
+	};
+
+}
\ No newline at end of file
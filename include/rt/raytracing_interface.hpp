@@ -1,5 +1,14 @@
 #pragma once
 #include "task/composite_task.hpp"
+#include "uniform_manager.hpp"
+#include "command_segment.hpp"
+#include "export_writer.hpp"
+#include "tiled_export.hpp"
+#include "distributed.hpp"
+#include "profiler.hpp"
+#include "camera_path.hpp"
+#include "frame_governor.hpp"
+#include "image_quality.hpp"
 #include "helpers/factory.hpp"
 #include "system/viewport_interface.hpp"
 #include "gui/gui.hpp"
@@ -8,6 +17,8 @@
 #include "types/mat.hpp"
 #include "utils/random.hpp"
 #include "utils/inflect.hpp"
+#include <chrono>
+#include <memory>
 
 #include "../res/shaders/defines.glsl"
 
@@ -25,7 +36,8 @@ namespace igx::rt {
 		FHD,
 		QHD,
 		UHD_4K,
-		UHD_8K
+		UHD_8K,
+		UHD_16K
 	);
 
 	static constexpr Vec2u16 pixelsByResolution[] = {
@@ -35,7 +47,8 @@ namespace igx::rt {
 		{ 1920, 1080 },
 		{ 2560, 1440 },
 		{ 3840, 2160 },
-		{ 7680, 4320 }
+		{ 7680, 4320 },
+		{ 15360, 8640 }
 	};
 	
 	struct RaytracingProperties {
@@ -46,38 +59,113 @@ namespace igx::rt {
 
 		Vec2u16 targetSize = { 7680, 4320 };
 
-		f64 fps{};
+		f64 fps{}, recordTime{};
+
+		u32 uniformBytes{}, accumulatedSamples{};
+
+		//Keep adding samples while nothing changes (camera, uniforms or objects of the scene)
+		//Animating also moves the clouds, so it's paused by default
+
+		bool useProgressive = true, animateScene = false;
+
+		//Lower the render resolution and the shadow and cloud samples while frames are slower than the target (see FrameGovernor)
+		//Only while interactive; exports and replays are at full quality
+
+		bool useGovernor = true;
+		ui::Slider<f32, 10, 240> targetFps = 60;
+
+		f32 renderScale = 1;
+		u32 governorLevel{};
 
 		ui::Slider<u16, 1, 4096> targetSamples = 128;
 
+		//Export is submitted in chunks; it stops early when the estimated (relative) error
+		//is below the target or when the time budget (in seconds) runs out
+
+		ui::Slider<u16, 1, 256> chunkSamples = 16;
+		ui::Slider<f32, 0.001f, 0.5f> targetError = 0.02f;
+		ui::Slider<f32, 1, 7200> timeBudget = 600;
+
+		f32 exportProgress{}, exportError{};
+
 		Resolution res = Resolution::UHD_8K;
 
-		bool shouldOutputNextFrame{}, isPortrait{};
+		bool shouldOutputNextFrame{}, shouldCancelExport{}, isPortrait{};
+
+		//Tiles below the target error stop taking samples
+
+		bool useAdaptiveSampling = true;
+
+		//Accumulate exports as an fp16 mean + residual; 12 instead of 16 bytes per pixel
 
-		inline void exportToPNG() const {		//TODO: Non const!
+		bool useCompactAccumulation = true;
+
+		//Also write the unexposed mean as rgba16f (<targetOutput>_hdr), for re-exposing or compositing later
+
+		bool useHdrExport{};
+
+		//Render the export as a grid of tiles; the render targets are only tile sized, so 16K+ fits in memory
+		//Written as PPM (and PFM for HDR) a tile at a time. Only for the default projection
+
+		bool useTiledExport{};
+		ui::Slider<u16, 256, 8192> exportTileSize = 4096;
+
+		//Distributed export; if there's more than one worker, this process only renders its share of the samples
+		//and writes them to <targetOutput>_part<index>.acc, to be merged by mergeDistributedExport
+
+		ui::Slider<u16, 0, 63> workerIndex{};
+		ui::Slider<u16, 1, 64> workerCount = 1;
+
+		//Written as IGXI to targetOutput, as PPM/PFM tiles or as worker parts (see above)
+
+		inline void exportImage() const {		//TODO: Non const!
 			(bool&) shouldOutputNextFrame = true;
 		}
 
+		inline void cancelExport() const {
+			(bool&) shouldCancelExport = true;
+		}
+
 		InflectBody(
 
 			static const List<String> memberNames = {
-				"FPS", "Output path",
+				"FPS", "Uniform bytes / frame", "Command record time (ms)", "Accumulated samples",
+				"Progressive accumulation", "Animate scene",
+				"Frame governor", "Target FPS", "Render scale", "Governor level",
+				"Output path",
 				"Samples per pixel", "Output resolution preset", "Output size",
 				"Use portrait mode",
-				"Export to PNG"
+				"Samples per chunk", "Target error", "Time budget (s)", "Adaptive sampling", "Compact accumulation", "HDR export",
+				"Tiled export", "Tile size", "Worker index", "Worker count",
+				"Export progress", "Export error",
+				"Export image", "Cancel export"
 			};
 
 			if(res == Resolution::CUSTOM)
 				inflector.inflect(
 					this, recursion, memberNames, 
-					(const f64&) fps, targetOutput, targetSamples, res, targetSize, isPortrait,
-					igx::ui::Button<RaytracingProperties, &RaytracingProperties::exportToPNG>{}
+					(const f64&) fps, (const u32&) uniformBytes, (const f64&) recordTime, (const u32&) accumulatedSamples,
+					useProgressive, animateScene,
+					useGovernor, targetFps, (const f32&) renderScale, (const u32&) governorLevel,
+					targetOutput, targetSamples, res, targetSize, isPortrait,
+					chunkSamples, targetError, timeBudget, useAdaptiveSampling, useCompactAccumulation, useHdrExport,
+					useTiledExport, exportTileSize, workerIndex, workerCount,
+					(const f32&) exportProgress, (const f32&) exportError,
+					igx::ui::Button<RaytracingProperties, &RaytracingProperties::exportImage>{},
+					igx::ui::Button<RaytracingProperties, &RaytracingProperties::cancelExport>{}
 				);
 
 			else inflector.inflect(
 				this, recursion, memberNames, 
-				(const f64&) fps, targetOutput, targetSamples, res, (const Vec2u16&) targetSize, isPortrait,
-				igx::ui::Button<RaytracingProperties, &RaytracingProperties::exportToPNG>{}
+				(const f64&) fps, (const u32&) uniformBytes, (const f64&) recordTime, (const u32&) accumulatedSamples,
+				useProgressive, animateScene,
+				useGovernor, targetFps, (const f32&) renderScale, (const u32&) governorLevel,
+				targetOutput, targetSamples, res, (const Vec2u16&) targetSize, isPortrait,
+				chunkSamples, targetError, timeBudget, useAdaptiveSampling, useCompactAccumulation, useHdrExport,
+				useTiledExport, exportTileSize, workerIndex, workerCount,
+				(const f32&) exportProgress, (const f32&) exportError,
+				igx::ui::Button<RaytracingProperties, &RaytracingProperties::exportImage>{},
+				igx::ui::Button<RaytracingProperties, &RaytracingProperties::cancelExport>{}
 			);
 
 			if constexpr (!std::is_const_v<decltype(*this)>)
@@ -92,26 +180,118 @@ namespace igx::rt {
 
 	};
 
+	//Summaries of the profiler's history (average / max ms), refreshed every second
+
+	struct ProfilerProperties {
+
+		String traceOutput = "./output/trace.json";
+		String cpu, gpu, traversal;
+
+		u32 events{};
+
+		//Camera, timestep and properties of every frame, for replaying the same flythrough (see RaytracingInterface::replayCameraPath)
+
+		String cameraPath = "./output/camera.path";
+		u32 recordedFrames{};
+
+		bool shouldProfileGpu{}, shouldDumpTrace{}, shouldToggleRecording{};
+
+		//GPU passes are only timed on demand; it stalls for a few frames (see RaytracingInterface::profileGpuPasses)
+
+		inline void profileGpu() const {
+			(bool&) shouldProfileGpu = true;
+		}
+
+		inline void dumpTrace() const {
+			(bool&) shouldDumpTrace = true;
+		}
+
+		inline void toggleRecording() const {
+			(bool&) shouldToggleRecording = true;
+		}
+
+		InflectBody(
+
+			static const List<String> memberNames = {
+				"Trace output", "CPU (ms)", "GPU passes (ms, approx.)", "Traversal (debug shaders)", "Events",
+				"Camera path", "Recorded frames",
+				"Profile GPU passes", "Dump trace", "Record / stop camera path"
+			};
+
+			inflector.inflect(
+				this, recursion, memberNames,
+				traceOutput, (const String&) cpu, (const String&) gpu, (const String&) traversal, (const u32&) events,
+				cameraPath, (const u32&) recordedFrames,
+				igx::ui::Button<ProfilerProperties, &ProfilerProperties::profileGpu>{},
+				igx::ui::Button<ProfilerProperties, &ProfilerProperties::dumpTrace>{},
+				igx::ui::Button<ProfilerProperties, &ProfilerProperties::toggleRecording>{}
+			);
+		);
+	};
+
+	//State of an export that is being rendered in chunks
+
+	struct ExportState {
+
+		//Output is only read back once a tile is done; every chunk only reads back the error per tile (see export_error.comp)
+
+		UploadBufferRef output, hdrOutput, errorOutput;
+
+		std::chrono::high_resolution_clock::time_point start;
+
+		u32 samples{}, targetSamples{}, sampleStart{};
+		f64 error = 1;
+
+		//Tiled exports render one tile at a time, through a sub frustum of the full frame (p0, p1, p2)
+
+		List<ExportTile> tiles;
+		std::shared_ptr<TiledImageFile> tiledOutput, tiledHdrOutput;
+
+		Vec3f32 frame[3];
+		Vec2u32 size, tileSize;
+		u32 tile{};
+
+		bool isActive{}, isDone{}, isWorker{};
+	};
+
 	class RaytracingInterface : public oic::ViewportInterface {
 	
 		Graphics &g;
 		ui::GUI &gui;
 		FactoryContainer &factory;
 
-		GPUBufferRef cameraBuffer;
+		UniformManager uniforms;
+
+		ui::StructInspector<RaytracingProperties> properties;
+		ui::StructInspector<CPUCamera> cameraInspector;
+		ui::StructInspector<ProfilerProperties> profilerInspector;
+
+		Profiler profiler;
+
+		//Previous is what the GPU sees, last is this frame's camera (becomes previous next frame)
+
+		PreviousCamera previousCamera, lastCamera;
+
+		u32 cameraUniform, previousCameraUniform;
 
 		CompositeTask compositeTask;
 	
 		SwapchainRef swapchain;
-		CommandListRef cl;
 		SceneGraph *sceneGraph;
 
 		List<RenderTask*> prePasses, postPasses;
 
-		oic::Random r;
+		//Every task has its own commands, the frame is the concatenation of all of them
 
-		ui::StructInspector<RaytracingProperties> properties;
-		ui::StructInspector<CPUCamera> cameraInspector;
+		CommandSegment setupSegment, compositeSegment;
+		List<CommandSegment> prePassSegments, subtaskSegments, postPassSegments;
+
+		//Only while exporting; after every chunk and before presenting the window
+		CommandSegment errorSegment, previewSegment;
+
+		List<CommandList*> frameCommands;
+
+		oic::Random r;
 
 		Vec3f32 dir;
 		u32 frames{};
@@ -120,16 +300,61 @@ namespace igx::rt {
 
 		RenderMode renderMode = RenderMode::MQ;
 
-		bool isResizeRequested{};
+		ExportState exportState;
+
+		CameraPathRecorder cameraPathRecorder;
+
+		FrameGovernor governor;
+
+		//Where a quality run's HDR readback goes; only set on the frames that are measured
+
+		DenoiseImage *qualityOutput{};
+
+		bool isResizeRequested{}, shouldResetAccumulation = true;
+
+		//Objects of the last frame (triangles, spheres, cubes, planes, lights and materials)
+		//Animation only resets accumulation if one of them really changed
+
+		List<u8> cachedSceneData[6];
+
+		bool hasSceneChanged();
+
+		//Error is only trusted after a few samples
+
+		static constexpr u32 minConvergedSamples = 16;
+
+		//Final images are written off the render thread; last, so pending writes finish before anything else is destroyed
+
+		ExportWriter exportWriter;
+
+		void beginExport(const oic::ViewportInfo *vi);
+		void renderExportChunk();
+		void renderExportPreview(const oic::ViewportInfo *vi);
+		void beginExportTile();
+		void endExport();
+
+		bool shouldStopExport() const;
 
 		void fillCommandList();
+		void markCommandsDirty();
+
+		void profileGpuPasses();
 		void prepareMode(RenderMode mode);
 
+		//Pick the level for this frame's time and apply it; resizes if the render scale changed
+		void updateGovernor(f64 dt);
+		void applyFrameBudget(bool shouldResize = true);
+
+		//Accumulate (or denoise) config from the current camera at size; onImage(samples, ms, image) at every power of two
+		template<typename OnImage>
+		void renderQuality(const QualityConfig &config, const Vec2u32 &size, u32 maxSamples, const OnImage &onImage);
+
 	public:
 	
 		//Functions
 	
-		RaytracingInterface(Graphics &g, ui::GUI &gui, FactoryContainer &factory, SceneGraph &sceneGraph);
+		//skyboxPath is the file the scene's skybox was loaded from; it's also used as the light
+		RaytracingInterface(Graphics &g, ui::GUI &gui, FactoryContainer &factory, SceneGraph &sceneGraph, const String &skyboxPath);
 		~RaytracingInterface();
 
 		RaytracingInterface(const RaytracingInterface&) = delete;
@@ -145,11 +370,36 @@ namespace igx::rt {
 		void resize(const oic::ViewportInfo*, const Vec2u32& size) final override;
 	
 		void onRenderFinish(UploadBuffer*, const Pair<u64, u64>&, TextureObject*, const Vec3u16&, const Vec3u16&, u16, u8, bool);
+		void onExportErrorFinish(UploadBuffer*, const Pair<u64, u64>&, TextureObject*, const Vec3u16&, const Vec3u16&, u16, u8, bool);
+		void onHdrRenderFinish(UploadBuffer*, const Pair<u64, u64>&, TextureObject*, const Vec3u16&, const Vec3u16&, u16, u8, bool);
+		void onProfileFinish(UploadBuffer*, const Pair<u64, u64>&, TextureObject*, const Vec3u16&, const Vec3u16&, u16, u8, bool) {}
+		void onQualityReadback(UploadBuffer*, const Pair<u64, u64>&, TextureObject*, const Vec3u16&, const Vec3u16&, u16, u8, bool);
 	
 		void render(const oic::ViewportInfo*) final override;
 		void update(const oic::ViewportInfo*, f64) final override;
 		void onInputUpdate(oic::ViewportInfo*, const oic::InputDevice*, oic::InputHandle, bool) final override;
 
+		//Render worker index of count on the next frame (see RaytracingProperties::workerCount)
+		void exportAsWorker(u32 index, u32 count);
+
+		//Log the camera, timestep and properties of every frame from now on
+		bool recordCameraPath(const String &path);
+		void stopRecordingCameraPath();
+
+		//Headless; renders every frame of a recorded path offscreen at its recorded size and a fixed timestep (0 = as recorded)
+		//Frame time is update, recording and the GPU work (waited on); the first frame is rendered warmupFrames times untimed
+		//Writes the percentiles and every frame time to output (see writeFrameTimes)
+		bool replayCameraPath(const String &path, const String &output, f64 fixedDt = 1.0 / 60, u32 warmupFrames = 8);
+
+		//Same, but only returns the frame times; for scaling runs (see rtigx_test --scaling)
+		bool replayCameraPath(const String &path, List<f64> &frameMs, f64 fixedDt = 1.0 / 60, u32 warmupFrames = 8);
+
+		//Headless; renders every config from the first frame of a recorded path (paused, at its recorded size)
+		//and compares the HDR output against a reference (see QualityBenchmarkInfo and rtigx_test --quality)
+		bool measureQualityPerTime(
+			const String &path, const List<QualityConfig> &configs, const QualityBenchmarkInfo &info, List<QualityCurve> &curves
+		);
+
 		void addPrepass(RenderTask *t);
 		void addPostpass(RenderTask *t);
 	};
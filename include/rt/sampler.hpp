@@ -0,0 +1,32 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//CPU mirror of sampler.glsl
+
+	enum SampleDimension : u32 {
+		SAMPLE_DIMENSION_PRIMARY,
+		SAMPLE_DIMENSION_LIGHT,
+		SAMPLE_DIMENSION_LIGHT_PICK
+	};
+
+	u32 hashUint(u32 x);
+	u32 hashCombine(u32 seed, u32 v);
+
+	u32 nestedUniformScramble(u32 x, u32 seed);
+
+	//Owen scrambled Sobol [0, 1>^2
+	Vec2f32 sobolOwen2D(u32 index, u32 dimension, u32 seed);
+
+	//Texel of the blue noise (res/textures/blue_noise_rg.png) that rotates a pixel's sequence
+	//It's tiled over the screen and every dimension is a different shift
+	Vec2u32 blueNoiseTexel(const Vec2u32 &loc, u32 dimension, const Vec2u32 &size);
+
+	//White noise in place of the blue noise for CPU stand-ins; it only changes how the error is spread over the screen
+	Vec2f32 hashedRotation(const Vec2u32 &loc, u32 dimension);
+
+	//Rotation is the pixel's screen space rotation; the shaders fetch it from the blue noise
+	Vec2f32 sample2D(const Vec2f32 &rotation, u32 index, u32 dimension, u32 seed);
+
+}
\ No newline at end of file
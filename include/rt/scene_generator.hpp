@@ -0,0 +1,78 @@
+#pragma once
+#include "rt/traversal_stats.hpp"
+#include "rt/camera_path.hpp"
+
+namespace igx::rt {
+
+	//Procedural scenes for scaling runs; the same seed and info always give the same scene
+
+	enum class SceneLayout : u32 {
+		Uniform,			//Scattered through the whole volume
+		Clustered,			//Dense blobs with empty space in between
+		City_grid			//Cubes as buildings on a grid, spheres and soups in the streets
+	};
+
+	//"uniform", "clustered" or "city"
+	bool parseSceneLayout(const String &name, SceneLayout &layout);
+	const c8 *sceneLayoutName(SceneLayout layout);
+
+	struct SceneGeneratorInfo {
+
+		u64 objects = 1000;				//Split evenly over spheres, cubes and triangles
+		u32 directionalLights = 1;
+		u32 pointLights = 4;
+
+		SceneLayout layout = SceneLayout::Uniform;
+		u32 seed = 1;
+
+		f32 extent = 100;				//Half size of the ground; objects shrink as the count grows
+		u32 trianglesPerSoup = 8;
+		u32 materials = 8;
+	};
+
+	struct GeneratedLight {
+		Vec3f32 posOrDir, color;
+		f32 radius, origin;				//Point lights only
+		bool isPoint;
+	};
+
+	//Geometry is in the order the shaders trace it; material ids per object in that order too
+	//The ground plane is always there, so it's never an empty scene
+
+	struct GeneratedScene {
+
+		TraversalScene geometry;
+		List<u32> materials;
+		List<GeneratedLight> lights;
+
+		//Size of the buffers as uploaded by the scene graph (scene.glsl)
+		usz gpuBytes() const;
+
+		//What the generator itself holds on to
+		usz hostBytes() const;
+	};
+
+	GeneratedScene generateScene(const SceneGeneratorInfo &info);
+
+	//One step of a scaling run (rtigx_test --scaling); frames are real frames of the GeneratedSceneGraph,
+	//replayed headless along a recorded camera path (see RaytracingInterface::replayCameraPath)
+	//The proxy is the brute force traversal on the CPU (TraversalTracer): primaries and a shadow ray per hit,
+	//on a fixed budget of primitive tests and scaled up to width x height rays; it's kept to compare against older runs
+
+	struct SceneScaling {
+		u64 objects;
+		f64 generateMs;
+		FrameTimeStats frames;
+		f64 proxyMsPerRay, proxyFrameMs, testsPerRay;
+		usz gpuBytes, hostBytes;
+	};
+
+	//Everything but the frames
+	SceneScaling measureSceneScaling(
+		const SceneGeneratorInfo &info, u32 width = 1920, u32 height = 1080, u64 testBudget = 200000000
+	);
+
+	//Csv with a header row (if the file is new); a sweep appends one row per process, so every scene starts from a clean device
+	bool appendSceneScaling(const String &path, SceneLayout layout, const SceneScaling &step);
+
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//Image based lighting from the skybox (see sky_lighting.glsl)
+	//SH9 irradiance for the diffuse term and a GGX prefiltered mip chain for reflections
+	//Level 0 is the skybox itself (mirror); level i is prefiltered for roughness i / (levels - 1)
+
+	static constexpr u32 skyLightingMaxLevels = 8;
+
+	//std430; followed by the prefiltered texels (rgba16f)
+
+	struct SkyLightingHeader {
+
+		Vec4f32 sh[9];				//rgb; already convolved with the cosine lobe and divided by pi
+
+		u32 levels, useIrradiance, enabled, pad0;
+
+		Vec4u32 mips[skyLightingMaxLevels];		//width, height, offset in texels; level 0 is unused
+	};
+
+	class SkyLighting {
+
+		SkyLightingHeader header{};
+		List<u16> texels;			//rgba16f
+
+		Vec3f32 fetch(u32 level, i32 x, i32 y) const;
+
+	public:
+
+		static constexpr u32 levels = 6, baseWidth = 256, baseHeight = 128, prefilterSamples = 256;
+
+		//Splits the projection and every mip over threads (0 = hardware concurrency)
+		void build(const List<f32> &rgb, u32 width, u32 height, u32 threads = 0);
+
+		//Cache is only valid for the same source (hash of the file) and layout
+		bool load(const String &path, u64 sourceHash);
+		bool save(const String &path, u64 sourceHash) const;
+
+		static u64 hash(const u8 *data, usz size);
+
+		//Diffuse radiance of a surface facing dir (irradiance / pi)
+		Vec3f32 irradiance(const Vec3f32 &dir) const;
+
+		//Bilinear lookup of a prefiltered level (1 <= level < levels)
+		Vec3f32 prefiltered(u32 level, const Vec3f32 &dir) const;
+
+		//useIrradiance is off when the sky is already sampled as a light
+		List<u8> getGPUData(bool useIrradiance) const;
+
+		inline bool empty() const { return texels.empty(); }
+	};
+
+}
\ No newline at end of file
@@ -11,6 +11,40 @@ namespace igx::rt {
 		f32 cpuOffsetX, cpuOffsetY;
 
 		u32 sampleCount, sampleOffset;
+
+		f32 adaptiveError;
+		u32 adaptiveMinSamples;
+
+		u32 compactAccumulation, hdrOutput;
+
+		//First sample index of the sequence; distributed workers each render their own range
+		u32 sampleStart;
+
+		//Rendered below the output size or previewed at another size; the UI is blended after scaling instead (see upscale.comp)
+		u32 isUpscaled;
+
+		//Re-submitted for profiling; sample counters, tiles and accumulation are only read (see RaytracingInterface::profileGpuPasses)
+		u32 isFrozen;
+	};
+
+	//Adaptive sampling state per tile (see adaptive.glsl)
+
+	struct TileInfo {
+		u32 samples, converged;
+		u32 maxError[2];
+	};
+
+	//Camera of the last frame; used to reproject history (see denoise_temporal.comp)
+
+	struct PreviousCamera {
+
+		Vec3f32 eye; u32 isValid{};
+		Vec3f32 p0; u32 projectionType{};
+		Vec3f32 p1; f32 pad0{};
+		Vec3f32 p2; f32 pad1{};
+
+		void set(const Camera &camera);
+
 	};
 
 	struct CPUCamera : public Camera {
@@ -2,6 +2,7 @@
 #include "rt/task/raygen_task.hpp"
 #include "gui/gui.hpp"
 #include "gui/struct_inspector.hpp"
+#include "rt/uniform_manager.hpp"
 #include "../res/shaders/defines.glsl"
 
 namespace igx::rt {
@@ -12,7 +13,7 @@ namespace igx::rt {
 
 		TextureRef output;
 
-		GPUBufferRef data, targetRes;
+		GPUBufferRef targetRes;
 
 		DescriptorsRef descriptors;
 		PipelineLayoutRef layout;
@@ -20,7 +21,10 @@ namespace igx::rt {
 
 	public:
 
-		CloudNoiseTask(FactoryContainer &factory, const String &name, const GPUBufferRef &data, const TextureRef &output);
+		CloudNoiseTask(
+			FactoryContainer &factory, const String &name,
+			const UniformManager &uniforms, u32 data, const TextureRef &output
+		);
 
 		void prepareCommandList(CommandList *cl) override;
 
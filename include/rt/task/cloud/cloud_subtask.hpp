@@ -12,7 +12,6 @@ namespace igx::rt {
 
 		RaygenTask *primaries;
 
-		GPUBufferRef uniformBuffer;
 		TextureRef noiseOutputHQ, noiseOutputLQ;
 
 		DescriptorsRef cloudDescriptors, outputDescriptor, cameraDescriptor;
@@ -21,19 +20,25 @@ namespace igx::rt {
 		PipelineLayoutRef shaderLayout;
 		SamplerRef linearSampler;
 
+		u32 shadowRes;
+		bool isShadowPass;
+
 	public:
 
 		CloudSubtask(
 			FactoryContainer &factory, const String &name, bool isShadowPass, RaygenTask *primaries, 
 			List<RegisterLayout> layouts, const DescriptorsRef &cloudDescriptors,
-			const GPUBufferRef &uniformBuffer, const TextureRef &noiseOutputHQ, const TextureRef &noiseOutputLQ,
-			const DescriptorsRef &cameraDescriptor
+			const TextureRef &noiseOutputHQ, const TextureRef &noiseOutputLQ,
+			const DescriptorsRef &cameraDescriptor, u32 shadowRes = 0
 		);
 
 		void prepareCommandList(CommandList *cl) override;
 		void resize(const Vec2u32 &size) override;
 		void switchToScene(SceneGraph*) override {}
 		void update(f64) override {}
+
+		//The shadow pass isn't screen sized
+		void setShadowResolution(u32 res);
 	};
 
 }
\ No newline at end of file
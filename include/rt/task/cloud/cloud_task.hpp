@@ -2,6 +2,7 @@
 #include "rt/task/raygen_task.hpp"
 #include "gui/gui.hpp"
 #include "gui/struct_inspector.hpp"
+#include "rt/uniform_manager.hpp"
 #include "../res/shaders/defines.glsl"
 
 namespace igx::rt {
@@ -26,6 +27,10 @@ namespace igx::rt {
 		ui::Slider<u32, 0, 64> Light_samples = 32;
 
 		u32 directionalLights;
+		u32 updateShadow;
+		Vec2f32 shadowOrigin;
+
+		f32 shadowExtent;
 
 		Inflect(
 			Samples, Light_samples,
@@ -72,9 +77,33 @@ namespace igx::rt {
 
 	};
 
+	//Top-down shadow map; optical depth towards the sun, integrated once every Update_interval frames
+
+	struct CloudShadowProperties {
+
+		bool Enabled = true; u8 pad0[3]{};
+
+		ui::Slider<u32, 16, 4096> Resolution = 512;
+		ui::Slider<u32, 1, 60> Update_interval = 4;
+		ui::Slider<f32, 1, 4096> Extent = 512;
+
+		f32 Center_x{}, Center_z{};
+
+		Inflect(Enabled, Resolution, Update_interval, Extent, Center_x, Center_z);
+
+	};
+
+	//How the cloud shadow map is placed in the world (extent 0 = disabled)
+
+	struct CloudShadowMapping {
+		Vec2f32 origin;
+		f32 extent, height;
+	};
+
 	//
 
 	class CloudSubtask;
+	class CloudNoiseTask;
 
 	class CloudTask : public RenderTask {
 
@@ -87,21 +116,37 @@ namespace igx::rt {
 
 		RaygenTask *primaries;
 
-		GPUBufferRef uniformBuffer, noiseUniformData;
+		u32 uniformBuffer, noiseUniformData;
 		ui::StructInspector<CPUCloudBuffer> cloudBuffer;
 		ui::StructInspector<NoiseUniformData> noiseUniforms;
+		ui::StructInspector<CloudShadowProperties> shadowProperties;
+
+		NoiseUniformData cachedNoise{};
+		CPUCloudBuffer cachedShadowClouds{};
 
 		DescriptorsRef cloudDescriptors;
 		PipelineLayoutRef cloudLayout;
-		SamplerRef linearSampler;
+		SamplerRef linearSampler, nearestSampler;
 
 		TextureRef noiseOutputHQ, noiseOutputLQ;
 
+		CloudNoiseTask *noiseTasks[2];
 		CloudSubtask *subtasks[2];
 
+		//Samples and Light_samples are what's marched; what was set in the UI, lowered by the budget (see setSampleBudget)
+
+		u32 requestedSamples{}, requestedLightSamples{}, appliedSamples{}, appliedLightSamples{};
+		f32 sampleBudget = 1;
+
+		u32 shadowFrame{}, cachedShadowRes{};
+		bool noiseDirty = true, noiseRecorded{}, cachedShadowEnabled{};
+
 	public:
 
-		CloudTask(RaygenTask *primaries, FactoryContainer &factory, ui::GUI &gui, const DescriptorsRef &camera);
+		CloudTask(
+			RaygenTask *primaries, FactoryContainer &factory, ui::GUI &gui,
+			UniformManager &uniforms, const DescriptorsRef &camera
+		);
 		~CloudTask();
 
 		void resize(const Vec2u32 &size) override;
@@ -113,7 +158,16 @@ namespace igx::rt {
 
 		void switchToScene(SceneGraph *sceneGraph) override;
 
+		//Traversal statistics (owned by the composite task); debug builds only
+		void setTraversalStats(const GPUBufferRef &totals, const GPUBufferRef &pixels);
+
+		//March a fraction of Samples and Light_samples; set by the frame governor
+		inline void setSampleBudget(f32 fraction) { sampleBudget = fraction; }
+
 		Texture *getOutput(bool isShadow = false) const;
+
+		u32 getShadowResolution() const { return cachedShadowRes; }
+		CloudShadowMapping getShadowMapping() const;
 	};
 
 }
\ No newline at end of file
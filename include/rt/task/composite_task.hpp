@@ -4,7 +4,13 @@
 #include "helpers/factory.hpp"
 #include "gui/struct_inspector.hpp"
 #include "rt/structs.hpp"
+#include "rt/uniform_manager.hpp"
+#include "rt/sky_lighting.hpp"
+#include "rt/environment_map.hpp"
+#include "rt/traversal_stats.hpp"
 #include "../res/shaders/defines.glsl"
+#include <functional>
+#include <future>
 
 namespace igx::rt {
 
@@ -32,7 +38,12 @@ namespace igx::rt {
 		Lights_per_pixel,
 		Cloud_lighting,
 		Cloud_transparency,
-		Sky
+		Sky,
+		Samples_per_pixel,
+		Primitive_tests,
+		Nodes_visited,
+		Shadow_rays,
+		Density_taps
 	);
 
 	struct DebugData {
@@ -40,7 +51,10 @@ namespace igx::rt {
 		DebugType Display_type = DebugType::Default;
 		bool Display_NaN_only{}; u8 pad0[3]{};
 
-		Inflect(Display_type, Display_NaN_only);
+		//Count that's red in the traversal heatmaps
+		ui::Slider<u32, 1, 4096> Heatmap_max = 64;
+
+		Inflect(Display_type, Display_NaN_only, Heatmap_max);
 
 	};
 
@@ -51,27 +65,148 @@ namespace igx::rt {
 		ui::GUI &gui;
 		FactoryContainer &factory;
 
+		UniformManager &uniforms;
+
 		DescriptorsRef cameraDescriptor;
-		GPUBufferRef seedBuffer, cameraRef, debugBuffer;
+		GPUBufferRef seedBuffer, tiles, skyLightingBuffer;
+		TextureRef accumulation, accumulationMean, accumulationResidual, hdrOutput;
+
+		//Debug builds only; frame totals are mapped, pixels are shown and cleared by the composite
+		GPUBufferRef traversalTotals, traversalPixels;
 
 		DescriptorsRef descriptors, initDescriptors;
 		PipelineRef shader, initShader;
 		PipelineLayoutRef shaderLayout, initShaderLayout;
 		SamplerRef nearestSampler;
+		TextureRef blueNoise;
+
+		//Output size target when rendering below it (see setRenderScale); bilinearly upscaled, the UI is blended at full size
+
+		TextureRef upscaled;
+		DescriptorsRef upscaleDescriptors;
+		PipelineRef upscaleShader;
+		PipelineLayoutRef upscaleShaderLayout;
+		SamplerRef linearSampler;
+
+		f32 renderScale = 1;
+		Vec2u32 outputSize, previewSize;
+
+		void resizeUpscaled(const Vec2u32 &size);
+
+		//Export error; the sum of the squared relative error per work group, so exports don't read back every pixel
+
+		TextureRef errorTiles;
+		DescriptorsRef errorDescriptors;
+		PipelineRef errorShader;
+		PipelineLayoutRef errorShaderLayout;
 
 		SceneGraph *sceneGraph;
 		Seed *seed;
-		ui::StructInspector<DebugData*> debData;
+		ui::StructInspector<DebugData> debData;
 
 		oic::Random r;
 
+		//Image based lighting of the skybox; irradiance is only used if the shadow task doesn't sample the sky
+
+		SkyLighting skyLighting;
+		bool cachedSkySampled{};
+
+		void uploadSkyLighting();
+
+		//Building a sky takes seconds, so it's done on a worker and the previous sky is kept until it's ready
+		//Only the latest request is queued if another one is still being built
+
+		struct PendingEnvironment {
+			EnvironmentMap environment;
+			SkyLighting skyLighting;
+		};
+
+		std::future<PendingEnvironment> pendingEnvironment;
+		std::function<PendingEnvironment()> queuedEnvironment;
+
+		void applyEnvironmentMap();
+
 	public:
 
-		CompositeTask(const GPUBufferRef &cam, FactoryContainer &factory, ui::GUI &gui);
+		CompositeTask(
+			UniformManager &uniforms, u32 cameraUniform, u32 previousCameraUniform, 
+			FactoryContainer &factory, ui::GUI &gui
+		);
 		~CompositeTask();
 
 		void prepareCommandList(CommandList *cl) override;
 
+		//Split up prepareCommandList; so subtasks can be recorded separately
+		//Init sets up the seed and composite is the final dispatch
+
+		void prepareInitCommands(CommandList *cl);
+		void prepareCompositeCommands(CommandList *cl);
+
+		//If the composite or init commands are dirty (ignores subtasks)
+		bool needsCompositeUpdate() const;
+
+		inline RenderTasks &getSubtasks() { return tasks; }
+
+		//Stop sampling tiles once their worst relative error is below maxError (0 = disabled)
+		//Only applies when supersampling; every tile takes at least minSamples
+		void setAdaptiveSampling(f32 maxError, u32 minSamples);
+
+		//Accumulate a running mean in rgba16f + rgba8 residual (12 bytes per pixel instead of 16)
+		//Only applies after the next resize, since that's when the targets are allocated
+		void setCompactAccumulation(bool compact);
+
+		//Also store the resolved mean (before exposure) to an rgba32f target, for HDR exports
+		//Same as compact accumulation; only allocated at full size after the next resize
+		void setHdrOutput(bool enabled);
+
+		//Re-run the same frame without advancing the sample counters or accumulating (see Seed::isFrozen)
+		void setFrozen(bool frozen);
+
+		inline TextureRef getHdrOutput() const { return hdrOutput; }
+
+		//Render at a fraction of the output size (per axis); subtasks and the composite run at the lower resolution
+		//and are upscaled to the output size. Only applies after the next resize, which is given the output size
+		void setRenderScale(f32 scale);
+
+		inline f32 getRenderScale() const { return renderScale; }
+		Vec2u32 getRenderSize(const Vec2u32 &outputSize) const;
+
+		//What's presented; the upscaled target if the render size is lower (or previewing), otherwise the composite's
+		inline Texture *getOutput() const { return seed->isUpscaled ? upscaled.get() : getTexture(); }
+
+		//Scale the output to size for presenting while exporting; the UI is blended there instead of into the output
+		//Recorded separately (see preparePreviewCommands), since exports submit the frame many times. 0 = disabled
+		void setPreview(const Vec2u32 &size);
+		void preparePreviewCommands(CommandList *cl);
+
+		//Sum of the squared relative error (of the supersampled output) per THREADS_XY^2 tile, as r32f
+		inline Texture *getErrorTiles() const { return errorTiles.get(); }
+		void prepareErrorCommands(CommandList *cl);
+
+		//Trace a fraction of the shadow and cloud samples that are set (see budgetSamples)
+		void setSampleBudget(f32 shadowSamples, f32 cloudSamples);
+
+		//See ShadowTask::setSamples
+		void setShadowSamples(u32 samples, bool denoise);
+
+		//See ShadowTask::setDenoiseBypass
+		bool setDenoiseBypass(bool bypass);
+
+		//Light by the skybox (rgb32f, top row first); importance sampled (see ShadowTask) and as image based lighting
+		//The prefiltered sky is cached in cacheDirectory, keyed by the hash of the pixels
+		//Built asynchronously; applied by update once it's done
+		void setEnvironmentMap(const List<f32> &rgb, u32 width, u32 height, const String &cacheDirectory = "./cache");
+
+		//Start accumulating from scratch next frame; otherwise samples keep adding up (if supersampling)
+		void resetAccumulation();
+
+		//Restart accumulation at sample start of a fixed sequence; the same for every process,
+		//so workers rendering disjoint ranges add up to one longer render
+		void setSampleRange(u32 start);
+
+		//Traversal statistics counted since the last call (see stats.glsl); false if the shaders don't count (release)
+		bool readTraversalStats(TraversalCounters &counters);
+
 		void update(f64 dt) override;
 		void resize(const Vec2u32 &size) override;
 		void switchToScene(SceneGraph *sceneGraph) override;
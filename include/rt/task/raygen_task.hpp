@@ -21,7 +21,8 @@ namespace igx::rt {
 		RaygenTask(
 			FactoryContainer &factory,
 			const GPUBufferRef &seedBuffer,
-			const DescriptorsRef &cameraDescriptor
+			const DescriptorsRef &cameraDescriptor,
+			const GPUSubresource &blueNoise
 		);
 
 		void prepareCommandList(CommandList *cl) override;
@@ -30,6 +31,12 @@ namespace igx::rt {
 		void resize(const Vec2u32 &size) override;
 
 		void switchToScene(SceneGraph *sceneGraph) override;
+
+		//Adaptive sampling state per tile (owned by the composite task)
+		void setTiles(const GPUBufferRef &tiles);
+
+		//Traversal statistics (owned by the composite task); debug builds only
+		void setTraversalStats(const GPUBufferRef &totals, const GPUBufferRef &pixels);
 	};
 
 }
\ No newline at end of file
@@ -4,47 +4,110 @@
 #include "gui/struct_inspector.hpp"
 #include "gui/ui_value.hpp"
 #include "utils/random.hpp"
+#include "rt/uniform_manager.hpp"
+#include "rt/light_tree.hpp"
+#include "rt/environment_map.hpp"
 
 namespace igx::rt {
 
 	class RaygenTask;
+	class CloudTask;
 
 	struct ShadowProperties {
 
+		//What's traced (totalSamples in the shaders); Shadow_samples lowered by the budget (see ShadowTask::setSampleBudget)
+		u32 tracedSamples = 2;
+
+		f32 cloudShadowExtent{};
+		Vec2f32 cloudShadowOrigin{};
+
+		f32 cloudShadowHeight{};
+
+		//Denoiser (see denoise.glsl)
+
+		bool Denoise = true; u8 pad0[3]{};
+
+		ui::Slider<f32, 0.1f, 16.f> Luminance_sigma = 4;
+		ui::Slider<f32, 1, 256> Normal_sigma = 128;
+		ui::Slider<f32, 0.001f, 1.f> Depth_sigma = 0.05f;
+		ui::Slider<u32, 1, 255> History_length = 32;
+
+		//Sky as a light with shadows; otherwise SH irradiance without rays (see sky_lighting.glsl)
+
+		bool Sky_light_rays = true; u8 pad1[3]{};
+
+		//What was set in the UI; after everything the shaders read, so it isn't part of their layout
+
 		ui::Slider<u32, 1, 512> Shadow_samples = 2;
 
-		Inflect(Shadow_samples);
+		Inflect(Shadow_samples, Denoise, Luminance_sigma, Normal_sigma, Depth_sigma, History_length, Sky_light_rays);
+
+	};
+
+	//Per a-trous iteration
 
+	struct DenoisePass {
+		u32 stepSize, isFirstPass;
 	};
 
 	class ShadowTask : public TextureRenderTask {
 
+		static constexpr u32 atrousIterations = 5;		//Has to be odd, so the last pass outputs to the lighting texture
+
 		oic::Random random;
 
 		FactoryContainer &factory;
 
 		SceneGraph *sceneGraph;
 		RaygenTask *raygen;
+		CloudTask *clouds;
 
-		GPUBufferRef shadowProperties, shadowOutput, seed;
+		GPUBufferRef shadowOutput, seed, lightTreeBuffer, environmentBuffer;
 		SamplerRef nearestSampler, linearSampler;
 
-		PipelineRef shadowShader, lightingShader;
-		PipelineLayoutRef shadowLayout, lightingLayout;
+		PipelineRef shadowShader, lightingShader, temporalShader, atrousShader;
+		PipelineLayoutRef shadowLayout, lightingLayout, temporalLayout, atrousLayout;
 
 		DescriptorsRef shadowDescriptors, lightingDescriptors, cameraDescriptor;
+		DescriptorsRef temporalDescriptors, atrousDescriptors[atrousIterations];
 
 		ui::StructInspector<ShadowProperties> properties;
+		u32 propertiesUniform;
+
+		DenoisePass denoisePasses[atrousIterations];
+
+		//Point lights of the last build/refit, so unchanged lights don't touch the tree
 
-		u32 cachedSamples{};
+		LightTree lightTree;
+		List<u8> cachedPointLights;
+		u32 cachedFirstPointLight{}, cachedLightTreeNodes{};
+
+		void updateLightTree();
+
+		//Sky importance map; disabled until an environment map is set
+
+		EnvironmentMap environment;
+
+		void uploadEnvironment();
+
+		u32 cachedSamples{}, cachedCloudShadowRes{};
+		bool cachedDenoise{}, cachedSkyLightRays = true, denoiseBypass{};
+
+		inline bool isDenoised() const { return properties->Denoise && !denoiseBypass; }
+
+		f32 sampleBudget = 1;
 
 	public:
 
 		ShadowTask(
 			FactoryContainer &factory,
+			UniformManager &uniforms,
+			u32 previousCameraUniform,
 			RaygenTask *raygen,
+			CloudTask *clouds,
 			const GPUBufferRef &seed,
-			const DescriptorsRef &cameraDescriptor
+			const DescriptorsRef &cameraDescriptor,
+			const GPUSubresource &blueNoise
 		);
 
 		bool needsCommandUpdate() const;
@@ -54,6 +117,27 @@ namespace igx::rt {
 		void resize(const Vec2u32 &size) override;
 
 		void switchToScene(SceneGraph *sceneGraph) override;
+
+		//Adaptive sampling state per tile (owned by the composite task)
+		void setTiles(const GPUBufferRef &tiles);
+
+		//Traversal statistics (owned by the composite task); debug builds only
+		void setTraversalStats(const GPUBufferRef &totals, const GPUBufferRef &pixels);
+
+		//Trace a fraction of Shadow_samples (at least 1); set by the frame governor
+		inline void setSampleBudget(f32 fraction) { sampleBudget = fraction; }
+
+		//Override Shadow_samples and Denoise, as if they were set in the UI (see RaytracingInterface::measureQualityPerTime)
+		void setSamples(u32 samples, bool denoise);
+
+		//Skip the denoiser while samples accumulate (or export); history isn't written then either
+		//Returns true if it changed
+		bool setDenoiseBypass(bool bypass);
+
+		//Importance sample the skybox as a light; built from the rgb32f equirect of the scene's skybox
+		void setEnvironmentMap(EnvironmentMap &&map);
+
+		inline bool isSkySampled() const { return !environment.empty() && properties->Sky_light_rays; }
 	};
 
 }
\ No newline at end of file
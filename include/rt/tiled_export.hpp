@@ -0,0 +1,45 @@
+#pragma once
+#include "types/vec.hpp"
+#include <fstream>
+
+namespace igx::rt {
+
+	//Visible part of a tile; tiles are always rendered at full tile size, edge tiles are cropped
+
+	struct ExportTile {
+		Vec2u32 offset, size;
+	};
+
+	//Row major grid of tileSize tiles covering size
+
+	List<ExportTile> planExportTiles(const Vec2u32 &size, const Vec2u32 &tileSize);
+
+	//Image file that's written one tile at a time, so the full image never has to be in memory
+	//rgba8 goes to binary PPM and rgba32f to PFM (bottom row first); alpha is dropped
+
+	class TiledImageFile {
+
+		std::fstream file;
+		u64 headerSize{};
+		u32 width, height;
+		bool isFloat;
+
+	public:
+
+		TiledImageFile(const String &path, u32 width, u32 height, bool isFloat);
+
+		TiledImageFile(const TiledImageFile&) = delete;
+		TiledImageFile &operator=(const TiledImageFile&) = delete;
+
+		//rgba is the whole tile (tileWidth pixels per row); only tile.size is written
+		bool writeTile(const u8 *rgba, u32 tileWidth, const ExportTile &tile);
+
+		inline bool isValid() const { return bool(file); }
+	};
+
+	//Bytes of the render targets an export allocates (see the tasks' resize), plus the readback
+	//outputFormat is assumed to be rgba16f; the UI and cloud targets aren't included
+
+	usz estimateExportMemory(const Vec2u32 &size, bool compactAccumulation, bool hdr);
+
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include "types/vec.hpp"
+
+namespace igx::rt {
+
+	//Counted by the shaders in debug builds (see stats.glsl) and by the CPU tracer below
+	//There is no acceleration structure yet, so a node is a primitive list that's walked
+
+	enum TraversalStat : u32 {
+		STAT_RAYS,
+		STAT_PRIMITIVE_TESTS,
+		STAT_NODES_VISITED,
+		STAT_SHADOW_RAYS,
+		STAT_DENSITY_TAPS,
+		STAT_COUNT
+	};
+
+	//Layout of the totals on the GPU; 64-bit so a frame of primitive tests can't overflow
+
+	struct TraversalCounters {
+
+		u64 counts[8]{};
+
+		inline u64 &operator[](TraversalStat stat) { return counts[stat]; }
+		inline u64 operator[](TraversalStat stat) const { return counts[stat]; }
+
+		TraversalCounters &operator+=(const TraversalCounters &other);
+		bool operator==(const TraversalCounters &other) const;
+	};
+
+	//Rays are primaries and shadow rays; taps and shadow rays are also per primary
+
+	struct TraversalRates {
+		f64 raysPerSecond, testsPerRay, nodesPerRay, shadowRaysPerPrimary, tapsPerPrimary;
+	};
+
+	TraversalRates traversalRates(const TraversalCounters &counters, f64 seconds);
+
+	//One line per figure; for the profiler window
+	String traversalReport(const TraversalRates &rates);
+
+	//Scene as the shaders see it; spheres are (pos, radius), planes (dir, offset) and cubes min, max
+
+	struct TraversalScene {
+		List<Vec3f32> triangles;		//3 points each
+		List<Vec4f32> spheres;
+		List<Vec3f32> cubes;			//2 points each
+		List<Vec4f32> planes;
+	};
+
+	//Mirror of trace.glsl; brute force over every list, counting exactly like the shaders do
+
+	class TraversalTracer {
+
+		const TraversalScene &scene;
+
+	public:
+
+		TraversalCounters counters;
+
+		inline TraversalTracer(const TraversalScene &scene): scene(scene) {}
+
+		//Distance to the closest hit or noHit (f32 max), like traceGeometry
+		f32 traceGeometry(const Vec3f32 &pos, const Vec3f32 &dir, u32 prevHit, u32 &object);
+
+		bool traceOcclusion(const Vec3f32 &pos, const Vec3f32 &dir, f32 maxDist, u32 prevHit);
+	};
+
+}
\ No newline at end of file
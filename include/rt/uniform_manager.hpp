@@ -0,0 +1,58 @@
+#pragma once
+#include "helpers/factory.hpp"
+
+namespace igx::rt {
+
+	//All CPU written uniforms live in one buffer
+	//Every frame the CPU side structs are compared against a shadow copy
+	//and only the bytes that changed are flushed (and uploaded by one FlushBuffer)
+	//
+	//Why frames in flight don't need their own slices:
+	//The GPU never reads the mapped memory written here; that's the buffer's CPU copy, flush() only marks ranges.
+	//The FlushBuffer at the start of the frame (see RaytracingInterface::fillCommandList) copies the marked ranges
+	//into an upload buffer allocation when the frame is submitted, and from there into the GPU copy on the queue.
+	//So the next update can't change what a submitted frame reads. The GPU copy is only written by those copies,
+	//which the queue orders after every read of the frames before it.
+	//Per-frame slices would need a descriptor set (and recorded segment) per frame in flight in every task
+
+	class UniformManager {
+
+		struct Uniform {
+			const void *src;
+			usz offset, size;
+			bool isDirty;
+		};
+
+		GPUBufferRef buffer;
+		List<Uniform> uniforms;
+		Buffer shadow;
+
+		usz head{}, bytesUploaded{};
+
+	public:
+
+		//Minimum uniform buffer offset alignment required by most GPUs
+		static constexpr usz alignment = 256;
+
+		UniformManager(Graphics &g, usz capacity = 16_KiB);
+
+		//Register a CPU struct; src has to outlive the manager
+		u32 add(const void *src, usz size);
+
+		template<typename T>
+		inline u32 add(const T *src) { return add(src, sizeof(T)); }
+
+		//Force a full re-upload (e.g. if the GPU could have overwritten it)
+		void markDirty(u32 id);
+
+		//Upload all changed ranges, returns the number of bytes flushed
+		usz update();
+
+		GPUSubresource getSubresource(u32 id) const;
+
+		inline usz getSize(u32 id) const { return uniforms[id].size; }
+		inline const GPUBufferRef &getBuffer() const { return buffer; }
+		inline usz getBytesUploaded() const { return bytesUploaded; }
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef ACCUMULATION
+#define ACCUMULATION
+#include "rand_util.glsl"
+
+//Accumulation is either an rgba32f sum or a compact running mean (seed.compactAccumulation)
+//Compact stores the mean as rgba16f and what fp16 couldn't represent as a fraction of a half ulp (rgba8)
+//Its alpha is the rms luminance instead of the sum of squares, to stay inside the fp16 range
+//The unused targets are 1x1
+
+layout(binding=1, rgba32f) uniform image2D accumulation;
+layout(binding=2, rgba16f) uniform image2D accumulationMean;
+layout(binding=3, rgba8) uniform image2D accumulationResidual;
+
+const float maxAccumulationMean = 32768;
+
+vec4 nextHalfUlp(const vec4 h) {
+	const uvec2 next = uvec2(packHalf2x16(h.rg), packHalf2x16(h.ba)) + 0x00010001u;
+	return vec4(unpackHalf2x16(next.x), unpackHalf2x16(next.y)) - h;
+}
+
+vec4 loadCompactMean(const ivec2 loc) {
+	const vec4 mean = imageLoad(accumulationMean, loc);
+	return mean + (imageLoad(accumulationResidual, loc) * 2 - 1) * nextHalfUlp(mean);
+}
+
+//Returns the mean; rgb is the color, alpha the mean of squared luminance
+
+vec4 loadAccumulation(const ivec2 loc, const Seed s, const uint samples) {
+
+	if(s.compactAccumulation == 0)
+		return imageLoad(accumulation, loc) / samples;
+
+	const vec4 mean = loadCompactMean(loc);
+	return vec4(mean.rgb, mean.a * mean.a);
+}
+
+//Add the nth sample and return the new mean (same as loadAccumulation)
+
+vec4 accumulate(const ivec2 loc, const Seed s, const vec3 color, const float lum, const uint samples) {
+
+	if(s.compactAccumulation == 0) {
+
+		vec4 sum = vec4(color, lum * lum);
+
+		if(samples > 1)
+			sum += imageLoad(accumulation, loc);
+
+		imageStore(accumulation, loc, sum);
+		return sum / samples;
+	}
+
+	//Running mean in full precision, split into the nearest half and the remainder
+
+	vec4 mean = vec4(color, lum);
+
+	if(samples > 1) {
+		const vec4 prev = loadCompactMean(loc);
+		mean = vec4(prev.rgb + (color - prev.rgb) / samples, sqrt(prev.a * prev.a + (lum * lum - prev.a * prev.a) / samples));
+	}
+
+	mean = clamp(mean, vec4(0), vec4(maxAccumulationMean));
+
+	const uvec2 packed = uvec2(packHalf2x16(mean.rg), packHalf2x16(mean.ba));
+	const vec4 stored = vec4(unpackHalf2x16(packed.x), unpackHalf2x16(packed.y));
+	const vec4 residual = clamp((mean - stored) / nextHalfUlp(stored), -1, 1);
+
+	imageStore(accumulationMean, loc, stored);
+	imageStore(accumulationResidual, loc, residual * 0.5 + 0.5);
+
+	return vec4(mean.rgb, mean.a * mean.a);
+}
+
+#endif
\ No newline at end of file
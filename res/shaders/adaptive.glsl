@@ -0,0 +1,49 @@
+#ifndef ADAPTIVE
+#define ADAPTIVE
+#include "camera.glsl"
+
+//Adaptive sampling state per tile (THREADS_XY x THREADS_XY, so one work group)
+//The max relative error is double buffered by sample index; 
+//raygen clears the current one, composite fills it and the next sample reads it
+
+struct TileInfo {
+	uint samples;
+	uint converged;
+	uint maxError[2];
+};
+
+#ifdef TILES_WRITABLE
+	layout(binding=8, std430) buffer Tiles {
+		TileInfo tiles[];
+	};
+#else
+	layout(binding=8, std430) readonly buffer Tiles {
+		TileInfo tiles[];
+	};
+#endif
+
+bool isAdaptive(const Seed s) {
+	return (camera.flags & CameraType_USE_SUPERSAMPLING) != 0 && s.adaptiveError > 0;
+}
+
+uint getTile(const uvec2 loc) {
+	const uint tilesX = (camera.width + THREADS_XY_MASK) >> THREADS_XY_SHIFT;
+	const uvec2 tile = loc >> THREADS_XY_SHIFT;
+	return tile.x + tile.y * tilesX;
+}
+
+//Uniform for the entire work group, so it's safe to return before ballots
+
+bool isTileActive(const uvec2 loc, const Seed s) {
+
+	if(!isAdaptive(s) || s.sampleCount <= s.adaptiveMinSamples)
+		return true;
+
+	const uint tile = getTile(loc);
+
+	return 
+		tiles[tile].converged == 0 && 
+		uintBitsToFloat(tiles[tile].maxError[(s.sampleCount - 1) & 1]) > s.adaptiveError;
+}
+
+#endif
\ No newline at end of file
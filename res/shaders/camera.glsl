@@ -110,9 +110,11 @@ Ray calculateStereoLR(vec2 centerPixel) {
 	return calculateScreen(vec2(centerPixel.x * 2 - 1, centerPixel.y), true);
 }
 
-Ray calculatePrimary(const uvec2 loc, const vec2 randLoc) {
+//Jitter is the position inside of the pixel [0, 1>
 
-	vec2 centerPixel = (vec2(loc) + rand(loc + randLoc)) * camera.invRes;
+Ray calculatePrimaryJittered(const uvec2 loc, const vec2 jitter) {
+
+	vec2 centerPixel = (vec2(loc) + jitter) * camera.invRes;
 	centerPixel.y = 1 - centerPixel.y;
 
 	switch(camera.projectionType) {
@@ -0,0 +1,117 @@
+#ifndef CLOUD
+#define CLOUD
+#include "primitive.glsl"
+
+layout(binding=0) uniform sampler3D worleySampler;
+
+layout(binding=1, std140) uniform CloudBuffer {
+
+	vec3 offset;
+	float heightA;
+
+	float heightB;
+	float absorption;
+	float threshold;
+	float multiplier;
+
+	float scaleXZ;
+	float scaleY;
+	uint samples;
+	uint lightSamples;
+
+	uint directionalLights;
+	uint updateShadow;
+	vec2 shadowOrigin;
+
+	float shadowExtent;
+
+};
+
+layout(binding=0, std140) readonly buffer Lights {
+	Light lights[];
+};
+
+float beer(float v) { return exp(-v); }
+
+//Two plane intersections and a distance check for the y
+
+bool intersectCloud(Ray ray, inout float minT, inout float maxT, float hitT) {
+
+	//Check if the ray is inbetween the clouds
+
+	const float cloudStart = min(heightA, heightB);
+	const float cloudEnd = max(heightA, heightB);
+
+	const bool betweenClouds = ray.pos.y >= cloudStart && ray.pos.y <= cloudEnd;
+
+	//Get down plane intersection
+
+	Hit downHit;
+	downHit.hitT = noHit;
+
+	rayIntersectPlane(ray, vec4(0, 1, 0, cloudStart), downHit, 0, noRayHit);
+
+	//The top of our clouds
+	
+	Hit upHit;
+	upHit.hitT = noHit;
+
+	rayIntersectPlane(ray, vec4(0, 1, 0, cloudEnd), upHit, 0, noRayHit);
+
+	//No hit on any of them and we're not in the center either
+	
+	if(downHit.hitT == noHit && upHit.hitT == noHit && !betweenClouds)
+		return false;
+
+	//If we are in clouds, we need to get our exit point or GBuffer hit point
+	
+	if(betweenClouds) {
+		minT = 0;
+		maxT = min(min(downHit.hitT, upHit.hitT), hitT);
+	}
+
+	//Otherwise, we hit the other two planes, since they are perpendicular
+
+	else {
+		minT = min(downHit.hitT, upHit.hitT);
+		maxT = min(max(downHit.hitT, upHit.hitT), hitT);
+	}
+
+	//Sometimes we don't hit "anything", e.g. when inside of the cloud
+	//then we would have a minT of hitT, which could be noHit
+
+	if(maxT == noHit)
+		maxT = minT + abs(heightB - heightA);
+
+	return true;
+}
+
+//Density
+//Adapted from http://www.diva-portal.org/smash/get/diva2:1223894/FULLTEXT01.pdf
+
+float calcPh(vec3 p) {
+	return (p.y - min(heightA, heightB)) / abs(heightB - heightA);
+}
+
+float D(vec3 p) {
+
+	//Calculate variables altering cloud shape by height
+	//E.g. rounding bottom and top
+
+	const float ph = calcPh(p);
+
+	const float SRb = clamp(ph / 0.07, 0, 1);
+	const float SRt = 1 - clamp((ph - 0.2) / 0.8, 0, 1);		//TODO: Weather map
+	const float SA = SRb * SRt;
+
+	//Get cloud shape from grid sample
+
+	p = p * vec3(scaleXZ, scaleY, scaleXZ) * 0.001 + offset * 0.01;
+	float s = texture(worleySampler, p).r;
+
+	float cloudShape = max(s - threshold, 0) * multiplier;
+
+	return cloudShape * SA;
+}
+
+#endif
\ No newline at end of file
@@ -1,4 +1,4 @@
-#!/bin/sh
+#!/bin/bash
 
 mode=RELEASE
 
@@ -8,42 +8,38 @@ then
 	shift 1
 fi
 
+#Hash of the source and every include (all .glsl next to it), in the order CMake globs them
+#binaries.txt has the one every binary was compiled from, so configuring can tell which are out of date (see CMakeLists.txt)
+
+function sourceHash {
+	{ sha256sum "$1"; for include in $(LC_ALL=C ls *.glsl); do sha256sum "$include"; done; } | cut -d' ' -f1 | tr -d '\n' | sha256sum | cut -d' ' -f1
+}
+
 function compileVendor {
 
 	echo -- Compiling file "$1" to "$2"
 
-	glslangValidator -G100 --target-env spirv1.0 -DVENDOR_$vendor -D$mode -e main -o "$2" "$1"
-
-	if [ $? -ne 0 ]; 
-	then 
-		exit $? 
-	fi
+	glslangValidator -G100 --target-env spirv1.0 -DVENDOR_$vendor -D$mode -e main -o "$2" "$1" || exit 1
 
 	echo -- Success compiling "$mode"
 
 	if [ $mode == "RELEASE" ] 
 	then
-		spirv-remap -v --do-everything --input "$(basename "$2")" --output $PWD
+		spirv-remap -v --do-everything --input "$(basename "$2")" --output $PWD || exit 1
 	else
-		spirv-remap -v --opt all --map all --dce all --input "$(basename "$2")" --output $PWD
-	fi
-		
-	if [ $? -ne 0 ]; 
-	then 
-		exit $? 
+		spirv-remap -v --opt all --map all --dce all --input "$(basename "$2")" --output $PWD || exit 1
 	fi
 
 	echo -- Success remapping
 
-	spirv-val --target-env opengl4.5 --target-env spv1.0 "$2"
-
-	if [ $? -ne 0 ]; 
-	then 
-		exit $? 
-	fi
+	spirv-val --target-env opengl4.5 --target-env spv1.0 "$2" || exit 1
 
 	echo -- Success validating
 
+	touch binaries.txt
+	{ grep -v "^$2 " binaries.txt; echo "$2 $(sourceHash "$1")"; } | LC_ALL=C sort > binaries.tmp
+	mv binaries.tmp binaries.txt
+
 }
 
 for i in "$@" 
@@ -0,0 +1,90 @@
+#ifndef DENOISE
+#define DENOISE
+#include "camera.glsl"
+#include "post_processing.glsl"
+#include "gbuffer.glsl"
+
+//Edge-aware a-trous (SVGF) denoiser shared by denoise_temporal.comp and denoise_atrous.comp
+//Mirrored on the CPU by rt/denoise_reference.hpp; keep both in sync
+
+layout(binding=2, std140) uniform ShadowProperties {
+
+	uint totalSamples;
+	float cloudShadowExtent;
+	vec2 cloudShadowOrigin;
+
+	float cloudShadowHeight;
+	uint denoise;
+	float sigmaL;
+	float sigmaN;
+
+	float sigmaZ;
+	uint maxHistory;
+
+};
+
+layout(binding=3, std140) uniform DenoisePass {
+	uint stepSize;
+	uint isFirstPass;
+};
+
+layout(binding=5, std140) uniform SeedBuffer {
+	Seed seed;
+};
+
+layout(binding=1) uniform usampler2D gBuffer;
+
+//B3 spline: 1/16, 1/4, 3/8, 1/4, 1/16
+
+const float denoiseKernel[3] = float[](3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0);
+
+//History is only reused if the reprojected surface stayed (about) the same
+
+const float historyDepthTolerance = 0.05;
+const float historyNormalTolerance = 0.9;
+const float minTemporalAlpha = 0.2;
+
+//Moments are stored as mean luminance, mean luminance squared, object and surface
+//Surface is the 8-bit per channel normal with the history length in the upper 8 bits
+
+uint packSurface(const vec3 n, const float historyLength) {
+	const uvec3 nh = uvec3((normalize(n) * 0.5 + 0.5) * 255);
+	return (uint(historyLength) << 24) | (nh.x << 16) | (nh.y << 8) | nh.z;
+}
+
+vec3 unpackSurfaceNormal(const uint surface) {
+	return vec3(uvec3(surface >> 16, surface >> 8, surface) & 255) / 255 * 2 - 1;
+}
+
+float unpackHistoryLength(const uint surface) {
+	return float(surface >> 24);
+}
+
+float denoiseWeight(
+	const float lumP, const float lumQ, const float phiL, 
+	const vec3 nP, const vec3 nQ, 
+	const float zP, const float zQ, const float phiZ
+) {
+	const float wN = pow(max(dot(nP, nQ), 0), sigmaN);
+	const float wZ = exp(-abs(zP - zQ) / max(phiZ, 1e-4));
+	const float wL = exp(-abs(lumP - lumQ) / phiL);
+	return wN * wZ * wL;
+}
+
+//Load the G-buffer; returns false for sky
+
+bool loadSurface(const ivec2 loc, out vec3 n, out float z) {
+
+	const GBuffer gb = decodeGBuffer(texelFetch(gBuffer, loc, 0));
+
+	n = gb.normal;
+	z = gb.hitT;
+
+	return gb.object != noRayHit;
+}
+
+bool inBounds(const ivec2 loc) {
+	return all(greaterThanEqual(loc, ivec2(0))) && all(lessThan(loc, ivec2(camera.width, camera.height)));
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef ENV_SAMPLING
+#define ENV_SAMPLING
+#include "light.glsl"
+
+//Importance map over the skybox luminance; built on the CPU at scene load (rt/environment_map.hpp)
+//Marginal cdf over the rows (height + 1), followed by a cdf per row (width + 1)
+
+layout(binding=10, std430) readonly buffer Environment {
+	uvec4 environmentInfo;		//width, height, enabled
+	float environmentCdf[];
+};
+
+bool isEnvironmentSampled() {
+	return environmentInfo.z != 0;
+}
+
+//Last interval with cdf[offset + i] <= u; never an empty one
+
+uint findEnvironmentInterval(const uint offset, const uint count, const float u) {
+
+	uint lo = 0, hi = count;
+
+	while(lo + 1 < hi) {
+
+		const uint mid = (lo + hi) >> 1;
+
+		if(environmentCdf[offset + mid] <= u)
+			lo = mid;
+
+		else hi = mid;
+	}
+
+	return lo;
+}
+
+//Direction towards the sky (inverse of sampleEquirect) and its solid angle pdf
+
+vec3 sampleEnvironment(vec2 u, out float pdf) {
+
+	const uint width = environmentInfo.x, height = environmentInfo.y;
+
+	u = min(u, vec2(0.99999994));
+
+	const uint y = findEnvironmentInterval(0, height, u.y);
+	const float m0 = environmentCdf[y], m1 = environmentCdf[y + 1];
+
+	const uint row = height + 1 + y * (width + 1);
+
+	const uint x = findEnvironmentInterval(row, width, u.x);
+	const float c0 = environmentCdf[row + x], c1 = environmentCdf[row + x + 1];
+
+	const vec2 uv = (vec2(x, y) + vec2((u.x - c0) / (c1 - c0), (u.y - m0) / (m1 - m0))) / vec2(width, height);
+
+	const float phi = (uv.x - 0.5) * 2 * pi, psi = (uv.y - 0.5) * pi;
+	const float cosPsi = cos(psi);
+
+	pdf = cosPsi > 0 ? (m1 - m0) * height * (c1 - c0) * width / (2 * pi * pi * cosPsi) : 0;
+
+	return vec3(sin(phi) * cosPsi, -sin(psi), cos(phi) * cosPsi);
+}
+
+//The sampled sky as a directional light, so shadows and shading don't need another path
+//Its color is already divided by the pdf (half floats; clamped)
+
+Light environmentLight(const vec2 u) {
+
+	float pdf;
+	const vec3 dir = sampleEnvironment(u, pdf);
+
+	const vec3 color = pdf > 0 ? min(sampleSkybox(dir) / pdf, vec3(65504)) : vec3(0);
+
+	return Light(
+		vec3(0), 0,
+		encodeNormal(-dir),
+		uvec2(packHalf2x16(color.rg), packHalf2x16(vec2(color.b, 0)) | (LightType_Directional << 16))
+	);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef GBUFFER
+#define GBUFFER
+#include "camera.glsl"
+#include "sampler.glsl"
+
+//Packed G-buffer written by raygen (16 bytes per pixel; rgba32ui, sampled with texelFetch)
+//x: hitT (noHit for sky)
+//y: octahedral normal (snorm 16:16)
+//z: uv (half 16:16)
+//w: object (noRayHit for sky)
+//The ray direction isn't stored; it's rebuilt from the pixel, camera and seed
+//Mirrored on the CPU by rt/gbuffer.hpp
+
+struct GBuffer {
+	float hitT;
+	vec3 normal;
+	vec2 uv;
+	uint object;
+};
+
+uint encodeOctNormal(const vec3 n) {
+
+	vec2 p = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+
+	if(n.z < 0)
+		p = (1 - abs(p.yx)) * mix(vec2(-1), vec2(1), greaterThanEqual(p, vec2(0)));
+
+	return packSnorm2x16(p);
+}
+
+vec3 decodeOctNormal(const uint stored) {
+
+	const vec2 p = unpackSnorm2x16(stored);
+	vec3 n = vec3(p, 1 - abs(p.x) - abs(p.y));
+
+	const float t = max(-n.z, 0);
+	n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0)));
+
+	return normalize(n);
+}
+
+uvec4 encodeGBuffer(const float hitT, const vec3 n, const vec2 uv, const uint object) {
+	return uvec4(floatBitsToUint(hitT), encodeOctNormal(n), packHalf2x16(uv), object);
+}
+
+GBuffer decodeGBuffer(const uvec4 texel) {
+	return GBuffer(uintBitsToFloat(texel.x), decodeOctNormal(texel.y), unpackHalf2x16(texel.z), texel.w);
+}
+
+//Same ray as raygen shot for this sample (as long as the seed is the same)
+
+#ifdef BLUE_NOISE_BINDING
+	Ray getPrimary(const uvec2 loc, const Seed s) {
+		return calculatePrimaryJittered(loc, sample2D(loc, sampleIndex(s), SAMPLE_DIMENSION_PRIMARY, s));
+	}
+#endif
+
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define LIGHT
 #include "utils.glsl"
 #include "trace.glsl"
+#include "sky_lighting.glsl"
 
 const float minRoughness = 0.01;
 const float specularEpsilon = 0.001;
@@ -183,7 +184,12 @@ vec3 shade(
 
 	const vec3 emissive = unpackColor3(m.emissive);
 
-	return (ambient + kD / pi) * albedo + kS * reflected + light + emissive;
+	//Sky irradiance replaces the constant ambient, unless the sky is already sampled as a light
+	//The surface faces -n (same as NdotL = dot(n, l))
+
+	const vec3 diffuse = skyLightingInfo.y != 0 ? kD * skyIrradiance(-n) : ambient + kD / pi;
+
+	return diffuse * albedo + kS * reflected + light + emissive;
 }
 
 vec3 shadeHit(Ray ray, Hit hit, vec3 light, vec3 reflection) {
@@ -213,9 +219,10 @@ vec3 shadeHitFinalRecursion(Ray ray, Hit hit, vec3 light) {
 	const vec3 v = ray.dir;
 	const float NdotV = max(dot(v, -n), 0);
 
-	const vec3 reflected = sampleSkybox(reflect(v, n));
+	const Material m = materials[materialIndices[hit.object]];
+	const vec3 reflected = samplePrefilteredSkybox(reflect(v, n), unpackColorAUnorm(m.ambientRoughness));
 
-	return shade(materials[materialIndices[hit.object]], position, n, v, NdotV, light, reflected);
+	return shade(m, position, n, v, NdotV, light, reflected);
 }
 
 uint indexToLight(uvec2 loc, uvec2 res, uint lightId, uvec2 shift, uvec2 mask) {
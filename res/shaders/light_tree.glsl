@@ -0,0 +1,165 @@
+#ifndef LIGHT_TREE
+#define LIGHT_TREE
+#include "scene.glsl"
+#include "env_sampling.glsl"
+
+//Light hierarchy over the point lights; built and refit on the CPU (rt/light_tree.hpp)
+//Children are next to each other, leaves store the index into lights[]
+//Traversal picks a child proportional to its estimated contribution to the shading point
+
+struct LightNode {
+
+	vec3 boundsMin;
+	uint child;
+
+	vec3 boundsMax;
+	float power;
+
+	vec3 axis;
+	float cosTheta;		//-1 for omnidirectional
+
+	float range;
+	uint pad0, pad1, pad2;
+};
+
+const uint LightNode_LEAF = 1u << 31;
+
+layout(binding=9, std430) readonly buffer LightTree {
+	LightNode lightNodes[];
+};
+
+//Normals follow the lighting convention (NdotL = dot(n, pos - light))
+
+float lightNodeImportance(const LightNode node, const vec3 pos, const vec3 n) {
+
+	if(node.power <= 0)
+		return 0;
+
+	//Nothing in the node reaches this point
+
+	const vec3 toClosest = pos - clamp(pos, node.boundsMin, node.boundsMax);
+	const float closestDist2 = dot(toClosest, toClosest);
+
+	if(closestDist2 >= node.range * node.range)
+		return 0;
+
+	//Falloff of the closest possible light (upper bound)
+
+	const float t = 1 - sqrt(closestDist2) / node.range;
+	const float power = node.power * t * t * (3 - 2 * t);
+
+	const vec3 d = pos - (node.boundsMin + node.boundsMax) * 0.5;
+	const vec3 diag = node.boundsMax - node.boundsMin;
+
+	const float dist2 = dot(d, d);
+	const float radius2 = max(dot(diag, diag) * 0.25, 1e-4);
+
+	if(dist2 <= radius2)
+		return power / radius2;
+
+	//Widen the angles by the angle the bounds cover
+
+	const float dist = sqrt(dist2);
+	const vec3 l = d / dist;
+
+	const float sinU = sqrt(radius2) / dist, cosU = sqrt(max(1 - sinU * sinU, 0));
+
+	const float cosI = dot(n, l), sinI = sqrt(max(1 - cosI * cosI, 0));
+	const float cosSurface = cosI >= cosU ? 1 : cosI * cosU + sinI * sinU;
+
+	if(cosSurface <= 0)
+		return 0;
+
+	float cosEmit = 1;
+
+	if(node.cosTheta > -1) {
+
+		const float theta = acos(clamp(dot(node.axis, l), -1, 1));
+		const float thetaP = max(theta - acos(node.cosTheta) - asin(sinU), 0);
+
+		if(thetaP >= pi * 0.5)
+			return 0;
+
+		cosEmit = cos(thetaP);
+	}
+
+	return power * cosSurface * cosEmit / dist2;
+}
+
+uint pickPointLight(const vec3 pos, const vec3 n, float u, inout float pdf) {
+
+	if(lightNodeImportance(lightNodes[0], pos, n) <= 0) {
+		pdf = 0;
+		return 0;
+	}
+
+	uint i = 0;
+
+	while((lightNodes[i].child & LightNode_LEAF) == 0) {
+
+		const uint child = lightNodes[i].child;
+
+		const float a = lightNodeImportance(lightNodes[child], pos, n);
+		const float b = lightNodeImportance(lightNodes[child + 1], pos, n);
+
+		if(a + b <= 0) {
+			pdf = 0;
+			return 0;
+		}
+
+		const float p = a / (a + b);
+
+		if(u < p) {
+			u /= p;
+			pdf *= p;
+			i = child;
+		}
+
+		else {
+			u = (u - p) / (1 - p);
+			pdf *= 1 - p;
+			i = child + 1;
+		}
+
+		u = min(u, 0.99999994);
+	}
+
+	return lightNodes[i].child & ~LightNode_LEAF;
+}
+
+//Directional lights and the sky are picked uniformly, point lights as one group through the tree
+//Returns the index into lights[] (or environmentLightId); pdf is 0 if no light reaches this point
+
+const uint environmentLightId = ~0u;
+
+uint pickLight(const vec3 pos, const vec3 n, float u, out float pdf) {
+
+	const uint directional = sceneInfo.directionalLightCount;
+	const uint points = uint(sceneInfo.pointLightCount != 0);
+	const uint groups = directional + points + uint(isEnvironmentSampled());
+
+	if(groups == 0) {
+		pdf = 0;
+		return 0;
+	}
+
+	const uint group = min(uint(u * groups), groups - 1);
+
+	pdf = 1.0 / groups;
+
+	if(group < directional)
+		return group;
+
+	if(group == directional + points)
+		return environmentLightId;
+
+	return pickPointLight(pos, n, min(u * groups - group, 0.99999994), pdf);
+}
+
+//The environment's direction is picked with the same random as the light's surface
+
+Light getPickedLight(const uint lightId, const vec2 random) {
+	return lightId == environmentLightId ? environmentLight(random) : lights[lightId];
+}
+
+#endif
\ No newline at end of file
@@ -1,3 +1,5 @@
+#ifndef POST_PROCESSING
+#define POST_PROCESSING
 
 float luminance(const vec3 color) {
 	return dot(color, vec3(0.299, 0.587, 0.114));
@@ -12,4 +14,6 @@ vec3 fromSRGB(const vec3 color) {
 
 vec3 exposureMapping(const vec3 color, const float exposure) {
 	return vec3(1, 1, 1) - exp(-color * exposure);
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -7,6 +7,11 @@ struct Seed {
 	float randomX, randomY;
 	float cpuOffsetX, cpuOffsetY;
 	uint sampleCount, sampleOffset;
+	float adaptiveError;
+	uint adaptiveMinSamples;
+	uint compactAccumulation;
+	uint hdrOutput;
+	uint sampleStart, isUpscaled, isFrozen;
 };
 
 const float goldenRatio = 0.61803398875;
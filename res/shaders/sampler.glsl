@@ -0,0 +1,98 @@
+#ifndef SAMPLER
+#define SAMPLER
+#include "rand_util.glsl"
+
+//Owen scrambled Sobol (Burley 2020, "Practical Hash-based Owen Scrambling")
+//Every pixel walks the same sequence, rotated by blue noise, so the error is high frequency
+//A sequence lasts as long as the accumulation; sampleIndex is the index into it
+//Shaders that sample define BLUE_NOISE_BINDING (the sampler of res/textures/blue_noise_rg.png) before including this
+//Mirrored on the CPU by rt/sampler.hpp
+
+const uint SAMPLE_DIMENSION_PRIMARY = 0;
+const uint SAMPLE_DIMENSION_LIGHT = 1;
+const uint SAMPLE_DIMENSION_LIGHT_PICK = 2;
+
+uint hashUint(uint x) {
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return x;
+}
+
+uint hashCombine(const uint seed, const uint v) {
+	return seed ^ (v + (seed << 6) + (seed >> 2));
+}
+
+uint laineKarrasPermutation(uint x, const uint seed) {
+	x += seed;
+	x ^= x * 0x6C50B47Cu;
+	x ^= x * 0xB82F1E52u;
+	x ^= x * 0xC7AFE638u;
+	x ^= x * 0x8D22F6E6u;
+	return x;
+}
+
+uint nestedUniformScramble(const uint x, const uint seed) {
+	return bitfieldReverse(laineKarrasPermutation(bitfieldReverse(x), seed));
+}
+
+//First two Sobol dimensions; x is van der Corput
+
+uvec2 sobol2D(uint i) {
+
+	uvec2 res = uvec2(bitfieldReverse(i), 0);
+
+	for(uint v = 1u << 31; i != 0; i >>= 1, v ^= v >> 1)
+		if((i & 1) != 0)
+			res.y ^= v;
+
+	return res;
+}
+
+vec2 sobolOwen2D(const uint index, const uint dimension, const uint seed) {
+
+	const uint dimSeed = hashCombine(seed, hashUint(dimension));
+	const uvec2 s = sobol2D(nestedUniformScramble(index, hashUint(dimSeed)));
+
+	const uvec2 scrambled = uvec2(
+		nestedUniformScramble(s.x, hashCombine(dimSeed, 1)),
+		nestedUniformScramble(s.y, hashCombine(dimSeed, 2))
+	);
+
+	return vec2(scrambled >> 8) / 16777216;
+}
+
+//Blue noise is tiled over the screen; every dimension is a different shift, so they aren't correlated
+
+uvec2 blueNoiseTexel(const uvec2 loc, const uint dimension, const uvec2 size) {
+	return (loc + dimension * uvec2(47, 17)) % size;
+}
+
+//Seed changes every time accumulation restarts (sampleOffset keeps counting)
+
+uint samplerSeed(const Seed s) {
+	return hashUint(s.sampleOffset - s.sampleCount);
+}
+
+//Distributed workers start at their own offset, so their samples don't overlap
+
+uint sampleIndex(const Seed s) {
+	return s.sampleStart + s.sampleCount - 1;
+}
+
+#ifdef BLUE_NOISE_BINDING
+	layout(binding=BLUE_NOISE_BINDING) uniform sampler2D blueNoise;
+
+	vec2 screenRotation(const uvec2 loc, const uint dimension) {
+		const uvec2 texel = blueNoiseTexel(loc, dimension, uvec2(textureSize(blueNoise, 0)));
+		return texelFetch(blueNoise, ivec2(texel), 0).rg;
+	}
+
+	vec2 sample2D(const uvec2 loc, const uint index, const uint dimension, const Seed s) {
+		return fract(sobolOwen2D(index, dimension, samplerSeed(s)) + screenRotation(loc, dimension));
+	}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef SKY_LIGHTING
+#define SKY_LIGHTING
+#include "scene.glsl"
+
+//Image based lighting from the skybox; built on the CPU at scene load (rt/sky_lighting.hpp)
+//SH9 irradiance and a GGX prefiltered mip chain; level 0 is the skybox itself
+
+layout(binding=11, std430) readonly buffer SkyLighting {
+
+	vec4 skySH[9];				//Convolved with the cosine lobe and divided by pi
+
+	uvec4 skyLightingInfo;		//levels, useIrradiance, enabled
+
+	uvec4 skyMips[8];			//width, height, offset
+
+	uvec2 skyTexels[];			//rgba16f
+};
+
+//Diffuse radiance of a surface facing dir
+
+vec3 skyIrradiance(const vec3 d) {
+
+	const vec3 res =
+		skySH[0].rgb * 0.282095 +
+		skySH[1].rgb * 0.488603 * d.y +
+		skySH[2].rgb * 0.488603 * d.z +
+		skySH[3].rgb * 0.488603 * d.x +
+		skySH[4].rgb * 1.092548 * d.x * d.y +
+		skySH[5].rgb * 1.092548 * d.y * d.z +
+		skySH[6].rgb * 0.315392 * (3 * d.z * d.z - 1) +
+		skySH[7].rgb * 1.092548 * d.x * d.z +
+		skySH[8].rgb * 0.546274 * (d.x * d.x - d.y * d.y);
+
+	return max(res, vec3(0));
+}
+
+//Wraps horizontally, clamps vertically
+
+vec3 fetchSkyMip(const uvec4 mip, const ivec2 xy) {
+
+	const uint x = uint(xy.x + int(mip.x)) % mip.x;
+	const uint y = uint(clamp(xy.y, 0, int(mip.y) - 1));
+
+	const uvec2 texel = skyTexels[mip.z + y * mip.x + x];
+	return vec3(unpackHalf2x16(texel.x), unpackHalf2x16(texel.y).x);
+}
+
+vec3 sampleSkyMip(const uint level, const vec3 dir) {
+
+	const uvec4 mip = skyMips[level];
+
+	const vec2 pos = sampleEquirect(dir) * vec2(mip.xy) - 0.5;
+	const vec2 t = fract(pos);
+	const ivec2 xy = ivec2(floor(pos));
+
+	return mix(
+		mix(fetchSkyMip(mip, xy), fetchSkyMip(mip, xy + ivec2(1, 0)), t.x),
+		mix(fetchSkyMip(mip, xy + ivec2(0, 1)), fetchSkyMip(mip, xy + ivec2(1, 1)), t.x),
+		t.y
+	);
+}
+
+//Reflection for a roughness; blends between the two closest levels
+
+vec3 samplePrefilteredSkybox(const vec3 dir, const float roughness) {
+
+	if(skyLightingInfo.z == 0)
+		return sampleSkybox(dir);
+
+	const float level = clamp(roughness, 0, 1) * (skyLightingInfo.x - 1);
+	const uint level0 = uint(level);
+	const uint level1 = min(level0 + 1, skyLightingInfo.x - 1);
+
+	const vec3 a = level0 == 0 ? sampleSkybox(dir) : sampleSkyMip(level0, dir);
+
+	if(level1 == level0)
+		return a;
+
+	return mix(a, sampleSkyMip(level1, dir), level - level0);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef STATS
+#define STATS
+
+#include "camera.glsl"
+
+//Traversal statistics (see traversal_stats.hpp); release shaders compile the counting to nothing
+//Each invocation counts privately and flushes once, to the frame totals and to its pixel
+//Totals are 64-bit (lo, hi), pixels are cleared by composite.comp after it displayed them
+
+const uint STAT_RAYS				= 0;
+const uint STAT_PRIMITIVE_TESTS		= 1;
+const uint STAT_NODES_VISITED		= 2;
+const uint STAT_SHADOW_RAYS			= 3;
+const uint STAT_DENSITY_TAPS		= 4;
+const uint STAT_COUNT				= 5;
+
+//Per pixel; everything but rays, since that's always one per pixel
+
+const uint STAT_PIXEL_STRIDE		= 4;
+
+#ifdef DEBUG
+
+	layout(binding=12, std430) buffer TraversalTotals {
+		uvec2 statTotals[8];
+	};
+
+	layout(binding=13, std430) buffer TraversalPixels {
+		uint statPixels[];
+	};
+
+	uint statCounters[STAT_COUNT] = uint[](0, 0, 0, 0, 0);
+
+	#define statCount(stat, count) statCounters[stat] += uint(count)
+
+	//Every primitive list walked is a node, until there's an acceleration structure
+
+	#define statCountList(count) statCount(STAT_PRIMITIVE_TESTS, count); statCount(STAT_NODES_VISITED, (count) != 0)
+
+	void statFlush(const uvec2 loc) {
+
+		const uint pixel = (loc.x + loc.y * camera.width) * STAT_PIXEL_STRIDE;
+
+		for(uint i = 0; i < STAT_COUNT; ++i) {
+
+			const uint count = statCounters[i];
+
+			if(count == 0)
+				continue;
+
+			const uint lo = atomicAdd(statTotals[i].x, count);
+
+			if(lo + count < lo)
+				atomicAdd(statTotals[i].y, 1);
+
+			if(i != STAT_RAYS)
+				atomicAdd(statPixels[pixel + i - 1], count);
+
+			statCounters[i] = 0;
+		}
+	}
+
+	uint statPixel(const uvec2 loc, const uint stat) {
+		return statPixels[(loc.x + loc.y * camera.width) * STAT_PIXEL_STRIDE + stat - 1];
+	}
+
+	void statClearPixel(const uvec2 loc) {
+		for(uint i = 0; i < STAT_PIXEL_STRIDE; ++i)
+			statPixels[(loc.x + loc.y * camera.width) * STAT_PIXEL_STRIDE + i] = 0;
+	}
+
+#else
+
+	#define statCount(stat, count)
+	#define statCountList(count)
+	#define statFlush(loc)
+
+#endif
+
+#endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "rand_util.glsl"
 #include "camera.glsl"
 #include "scene.glsl"
+#include "stats.glsl"
 
 //Intersections for colors
 
@@ -19,27 +20,33 @@ Hit traceGeometry(const Ray ray, uint prevHit) {
 
 	//TODO: Only get normal and uv of one object
 
+	statCount(STAT_RAYS, 1);
+
 	uint j = 0;
 
 	#ifdef ALLOW_TRIANGLES
+		statCountList(sceneInfo.triangleCount);
 		for(int i = 0; i < sceneInfo.triangleCount; ++i, ++j)
 			if(rayIntersectTri(ray, triangles[i], hit, j, prevHit))
 				hit.object = j;
 	#endif
 
 	#ifdef ALLOW_SPHERES
+		statCountList(sceneInfo.sphereCount);
 		for(uint i = 0; i < sceneInfo.sphereCount; ++i, ++j)
 			if(rayIntersectSphere(ray, spheres[i], hit, j, prevHit))
 				hit.object = j;
 	#endif 
 
 	#ifdef ALLOW_CUBES
+		statCountList(sceneInfo.cubeCount);
 		for(int i = 0; i < sceneInfo.cubeCount; ++i, ++j)
 			if(rayIntersectCube(ray, cubes[i], hit, j, prevHit))
 				hit.object = j;
 	#endif
 
 	#ifdef ALLOW_PLANES
+		statCountList(sceneInfo.planeCount);
 		for(uint i = 0; i < sceneInfo.planeCount; ++i, ++j)
 			if(rayIntersectPlane(ray, planes[i], hit, j, prevHit))
 				hit.object = j;
@@ -72,24 +79,30 @@ bool traceOcclusion(const Ray ray, const float maxDist, uint prevHit) {
 	Hit hit;
 	hit.hitT = noHit;
 
+	statCount(STAT_SHADOW_RAYS, 1);
+
 	uint j = 0;
 
 	#ifdef ALLOW_TRIANGLES
+		statCountList(sceneInfo.triangleCount);
 		for(int i = 0; i < sceneInfo.triangleCount; ++i, ++j)
 			rayIntersectTri(ray, triangles[i], hit, j, prevHit);
 	#endif
 
 	#ifdef ALLOW_SPHERES
+		statCountList(sceneInfo.sphereCount);
 		for(uint i = 0; i < sceneInfo.sphereCount; ++i, ++j)
 			rayIntersectSphere(ray, spheres[i], hit, j, prevHit);
 	#endif
 
 	#ifdef ALLOW_CUBES
+		statCountList(sceneInfo.cubeCount);
 		for(int i = 0; i < sceneInfo.cubeCount; ++i, ++j)
 			rayIntersectCube(ray, cubes[i], hit, j, prevHit);
 	#endif
 
 	#ifdef ALLOW_PLANES
+		statCountList(sceneInfo.planeCount);
 		for(uint i = 0; i < sceneInfo.planeCount; ++i, ++j)
 			rayIntersectPlane(ray, planes[i], hit, j, prevHit);
 	#endif
@@ -0,0 +1,57 @@
+#include "rt/accumulation.hpp"
+#include "rt/half.hpp"
+#include <algorithm>
+
+namespace igx::rt {
+
+	static constexpr f32 maxAccumulationMean = 32768;
+
+	static inline f32 nextHalfUlp(f32 h) {
+		return fromHalf(u16(toHalf(h) + 1)) - h;
+	}
+
+	static inline u8 toUnorm8(f32 v) {
+		return u8(std::round(std::clamp(v, 0.f, 1.f) * 255));
+	}
+
+	Vec4f32 CompactAccumulator::get() const {
+
+		f32 res[4];
+
+		for (usz i = 0; i < 4; ++i) {
+			const f32 h = fromHalf(mean[i]);
+			res[i] = h + (residual[i] / 255.f * 2 - 1) * nextHalfUlp(h);
+		}
+
+		return Vec4f32(res[0], res[1], res[2], res[3] * res[3]);
+	}
+
+	void CompactAccumulator::add(const Vec4f32 &value, u32 samples) {
+
+		f32 m[4] = { value.x, value.y, value.z, value.w };
+
+		if (samples > 1) {
+
+			const Vec4f32 prev = get();
+			const f32 prevRms = std::sqrt(prev.w);
+
+			const f32 n = f32(samples);
+
+			m[0] = prev.x + (value.x - prev.x) / n;
+			m[1] = prev.y + (value.y - prev.y) / n;
+			m[2] = prev.z + (value.z - prev.z) / n;
+			m[3] = std::sqrt(prevRms * prevRms + (value.w * value.w - prevRms * prevRms) / n);
+		}
+
+		for (usz i = 0; i < 4; ++i) {
+
+			const f32 v = std::clamp(m[i], 0.f, maxAccumulationMean);
+
+			mean[i] = toHalf(v);
+
+			const f32 stored = fromHalf(mean[i]);
+			residual[i] = toUnorm8(std::clamp((v - stored) / nextHalfUlp(stored), -1.f, 1.f) * 0.5f + 0.5f);
+		}
+	}
+
+}
\ No newline at end of file
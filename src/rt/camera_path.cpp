@@ -0,0 +1,218 @@
+#include "rt/camera_path.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace igx::rt {
+
+	static constexpr u32 cameraPathMagic = 0x4D414352;		//RCAM
+	static constexpr u32 cameraPathVersion = 1;
+
+	//Per frame; dt and which snapshots follow
+
+	enum CameraPathFlags : u8 {
+		CAMERA_PATH_CAMERA = 1,
+		CAMERA_PATH_PROPERTIES = 2
+	};
+
+	bool CameraPathRecorder::begin(const String &path, u32 cameraSize, u32 propertiesSize) {
+
+		end();
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		out.open(file, std::ios::binary);
+
+		const u32 header[] = { cameraPathMagic, cameraPathVersion, cameraSize, propertiesSize };
+		out.write((const c8*) header, sizeof(header));
+
+		if (!out) {
+			out.close();
+			return false;
+		}
+
+		lastCamera.assign(cameraSize, 0);
+		lastProperties.assign(propertiesSize, 0);
+		frames = 0;
+		return true;
+	}
+
+	void CameraPathRecorder::add(f64 dt, const void *camera, const void *properties) {
+
+		if (!isRecording())
+			return;
+
+		u8 flags{};
+
+		if (!frames || std::memcmp(lastCamera.data(), camera, lastCamera.size()))
+			flags |= CAMERA_PATH_CAMERA;
+
+		if (!frames || std::memcmp(lastProperties.data(), properties, lastProperties.size()))
+			flags |= CAMERA_PATH_PROPERTIES;
+
+		out.write((const c8*) &dt, sizeof(dt));
+		out.write((const c8*) &flags, sizeof(flags));
+
+		if (flags & CAMERA_PATH_CAMERA) {
+			std::memcpy(lastCamera.data(), camera, lastCamera.size());
+			out.write((const c8*) camera, std::streamsize(lastCamera.size()));
+		}
+
+		if (flags & CAMERA_PATH_PROPERTIES) {
+			std::memcpy(lastProperties.data(), properties, lastProperties.size());
+			out.write((const c8*) properties, std::streamsize(lastProperties.size()));
+		}
+
+		++frames;
+	}
+
+	bool CameraPathRecorder::end() {
+
+		if (!isRecording())
+			return false;
+
+		const bool ok = bool(out.flush());
+		out.close();
+		return ok;
+	}
+
+	bool readCameraPath(const String &path, CameraPath &cameraPath) {
+
+		std::ifstream in(std::filesystem::path(path), std::ios::binary);
+
+		u32 header[4]{};
+
+		if (!in.read((c8*) header, sizeof(header)) || header[0] != cameraPathMagic || header[1] != cameraPathVersion)
+			return false;
+
+		cameraPath.cameraSize = header[2];
+		cameraPath.propertiesSize = header[3];
+
+		cameraPath.frames.clear();
+		cameraPath.cameras.clear();
+		cameraPath.properties.clear();
+
+		//A frame that was cut off is dropped; everything before it is still valid
+
+		for (;;) {
+
+			f64 dt;
+			u8 flags;
+
+			if (!in.read((c8*) &dt, sizeof(dt)) || !in.read((c8*) &flags, sizeof(flags)))
+				break;
+
+			//The first frame always has both
+
+			if (cameraPath.frames.empty() && flags != (CAMERA_PATH_CAMERA | CAMERA_PATH_PROPERTIES))
+				return false;
+
+			const usz cameraStart = cameraPath.cameras.size(), propertiesStart = cameraPath.properties.size();
+
+			if (flags & CAMERA_PATH_CAMERA) {
+
+				cameraPath.cameras.resize(cameraStart + cameraPath.cameraSize);
+
+				if (!in.read((c8*) cameraPath.cameras.data() + cameraStart, cameraPath.cameraSize)) {
+					cameraPath.cameras.resize(cameraStart);
+					break;
+				}
+			}
+
+			if (flags & CAMERA_PATH_PROPERTIES) {
+
+				cameraPath.properties.resize(propertiesStart + cameraPath.propertiesSize);
+
+				if (!in.read((c8*) cameraPath.properties.data() + propertiesStart, cameraPath.propertiesSize)) {
+					cameraPath.cameras.resize(cameraStart);
+					cameraPath.properties.resize(propertiesStart);
+					break;
+				}
+			}
+
+			cameraPath.frames.push_back({
+				dt,
+				u32(cameraPath.cameras.size() / std::max(cameraPath.cameraSize, 1u)) - 1,
+				u32(cameraPath.properties.size() / std::max(cameraPath.propertiesSize, 1u)) - 1
+			});
+		}
+
+		return !cameraPath.frames.empty();
+	}
+
+	FrameTimeStats frameTimeStats(List<f64> frameMs) {
+
+		FrameTimeStats stats{};
+
+		if (frameMs.empty())
+			return stats;
+
+		std::sort(frameMs.begin(), frameMs.end());
+
+		const usz n = frameMs.size();
+
+		auto percentile = [&](f64 p) {
+			const usz rank = usz(std::ceil(p * f64(n)));
+			return frameMs[std::clamp(rank, usz(1), n) - 1];
+		};
+
+		for (f64 ms : frameMs)
+			stats.meanMs += ms;
+
+		stats.frames = u32(n);
+		stats.meanMs /= f64(n);
+		stats.p50Ms = percentile(0.5);
+		stats.p95Ms = percentile(0.95);
+		stats.p99Ms = percentile(0.99);
+		stats.maxMs = frameMs.back();
+		return stats;
+	}
+
+	String frameTimeReport(const FrameTimeStats &stats) {
+
+		c8 line[128];
+
+		std::snprintf(
+			line, sizeof(line), "p50 %.2f / p95 %.2f / p99 %.2f / max %.2f ms (%u frames)",
+			stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs, stats.frames
+		);
+
+		return line;
+	}
+
+	bool writeFrameTimes(const String &path, const FrameTimeStats &stats, const List<f64> &frameMs) {
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		std::ofstream out(file);
+
+		c8 line[256];
+
+		std::snprintf(
+			line, sizeof(line),
+			"{\"version\":1,\"frames\":%u,\"meanMs\":%.4f,\"p50Ms\":%.4f,\"p95Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,\"frameMs\":[",
+			stats.frames, stats.meanMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs
+		);
+
+		out << line;
+
+		for (usz i = 0; i < frameMs.size(); ++i) {
+			std::snprintf(line, sizeof(line), "%s%.4f", i ? "," : "", frameMs[i]);
+			out << line;
+		}
+
+		out << "]}\n";
+		return bool(out);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "rt/command_segment.hpp"
+#include "graphics/graphics.hpp"
+
+namespace igx::rt {
+
+	CommandSegment::CommandSegment(Graphics &g, const String &name, usz size):
+		commands{ g, NAME(name + " commands"), CommandList::Info(size) }, name(name)
+	{ }
+
+}
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "rt/denoise_reference.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace igx::rt {
+
+	//Keep in sync with denoise.glsl
+
+	static constexpr f32 denoiseKernel[3] = { 3.f / 8, 1.f / 4, 1.f / 16 };
+
+	static constexpr f32 historyDepthTolerance = 0.05f;
+	static constexpr f32 historyNormalTolerance = 0.9f;
+	static constexpr f32 minTemporalAlpha = 0.2f;
+
+	static inline f32 luminance(const Vec4f32 &c) {
+		return c.x * 0.299f + c.y * 0.587f + c.z * 0.114f;
+	}
+
+	static inline f32 dot3(const Vec4f32 &a, const Vec4f32 &b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	static inline f32 length2(i32 x, i32 y) {
+		return std::sqrt(f32(x * x + y * y));
+	}
+
+	static inline f32 asFloat(u32 v) {
+		f32 res;
+		std::memcpy(&res, &v, sizeof(res));
+		return res;
+	}
+
+	static inline u32 asUint(f32 v) {
+		u32 res;
+		std::memcpy(&res, &v, sizeof(res));
+		return res;
+	}
+
+	//Mirror of packSurface / unpackSurfaceNormal (denoise.glsl)
+
+	static inline u32 packSurface(const Vec4f32 &n, f32 historyLength) {
+
+		const f32 len = std::sqrt(dot3(n, n));
+
+		const u32
+			x = u32((n.x / len * 0.5f + 0.5f) * 255),
+			y = u32((n.y / len * 0.5f + 0.5f) * 255),
+			z = u32((n.z / len * 0.5f + 0.5f) * 255);
+
+		return (u32(historyLength) << 24) | (x << 16) | (y << 8) | z;
+	}
+
+	static inline Vec4f32 unpackSurfaceNormal(u32 n) {
+		return Vec4f32(
+			f32((n >> 16) & 255) / 255 * 2 - 1,
+			f32((n >> 8) & 255) / 255 * 2 - 1,
+			f32(n & 255) / 255 * 2 - 1,
+			0
+		);
+	}
+
+	static inline Vec3f32 cross(const Vec3f32 &a, const Vec3f32 &b) {
+		return Vec3f32(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	static inline f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	//Mirror of reproject (denoise_temporal.comp)
+
+	static inline Vec2i32 reproject(const DenoiseCamera *prev, const Vec3f32 &pos, const Vec2u32 &size) {
+
+		if (!prev)
+			return Vec2i32(-1, -1);
+
+		const Vec3f32 right = prev->p1 - prev->p0;
+		const Vec3f32 up = prev->p2 - prev->p0;
+		const Vec3f32 planeN = cross(right, up);
+
+		const Vec3f32 d = pos - prev->eye;
+		const f32 denom = dot(d, planeN);
+
+		if (std::abs(denom) < 1e-8f)
+			return Vec2i32(-1, -1);
+
+		const f32 t = dot(prev->p0 - prev->eye, planeN) / denom;
+
+		if (t <= 0)
+			return Vec2i32(-1, -1);
+
+		const Vec3f32 q = prev->eye + d * t - prev->p0;
+
+		return Vec2i32(
+			i32(std::floor(dot(q, right) / dot(right, right) * size.x)),
+			i32(std::floor((1 - dot(q, up) / dot(up, up)) * size.y))
+		);
+	}
+
+	static inline f32 denoiseWeight(
+		const DenoiseSettings &s,
+		f32 lumP, f32 lumQ, f32 phiL,
+		const Vec4f32 &p, const Vec4f32 &q,
+		f32 phiZ
+	) {
+		const f32 wN = std::pow(std::max(dot3(p, q), 0.f), s.sigmaN);
+		const f32 wZ = std::exp(-std::abs(p.w - q.w) / std::max(phiZ, 1e-4f));
+		const f32 wL = std::exp(-std::abs(lumP - lumQ) / phiL);
+		return wN * wZ * wL;
+	}
+
+	//denoise_temporal.comp
+
+	static DenoiseImage temporal(
+		const DenoiseFrame &frame, const DenoiseCamera *previous, 
+		const DenoiseState &state, DenoiseImage &currentMoments, const DenoiseSettings &s
+	) {
+
+		const DenoiseImage &lighting = frame.lighting, &gBuffer = frame.gBuffer;
+
+		const Vec2u32 size = lighting.size;
+		DenoiseImage filtered(size);
+
+		for (i32 y = 0; y < i32(size.y); ++y)
+			for (i32 x = 0; x < i32(size.x); ++x) {
+
+				const Vec2i32 loc(x, y);
+				const Vec4f32 &g = gBuffer[loc];
+
+				if (g.w < 0) {
+					filtered[loc] = currentMoments[loc] = {};
+					continue;
+				}
+
+				const Vec4f32 &hit = frame.hits[loc];
+				const Vec3f32 hitPos(hit.x, hit.y, hit.z);
+
+				const Vec4f32 color = lighting[loc];
+				const f32 lum = luminance(color);
+
+				//Check if the last frame saw the same surface
+
+				const Vec2i32 prevLoc = reproject(previous, hitPos, size);
+
+				Vec4f32 prevMoments{}, prev{};
+				bool isValid = lighting.contains(prevLoc);
+
+				if (isValid) {
+
+					prevMoments = state.moments[prevLoc];
+					prev = state.history[prevLoc];
+
+					const u32 surface = asUint(prevMoments.w);
+					const Vec3f32 toPrev = hitPos - previous->eye;
+
+					isValid =
+						(surface >> 24) > 0 &&
+						asUint(prevMoments.z) == asUint(hit.w) &&
+						dot3(g, unpackSurfaceNormal(surface)) >= historyNormalTolerance &&
+						std::abs(prev.w - std::sqrt(dot(toPrev, toPrev))) <= historyDepthTolerance * prev.w;
+				}
+
+				const f32 historyLength = 
+					isValid ? std::min(f32(asUint(prevMoments.w) >> 24) + 1, f32(s.maxHistory)) : 1;
+
+				const f32 alpha = std::max(1 / historyLength, minTemporalAlpha);
+
+				f32 m1 = lum, m2 = lum * lum;
+				Vec4f32 result = color;
+
+				if (isValid) {
+					m1 = prevMoments.x + (m1 - prevMoments.x) * alpha;
+					m2 = prevMoments.y + (m2 - prevMoments.y) * alpha;
+					result = prev + (color - prev) * alpha;
+				}
+
+				f32 variance = std::max(m2 - m1 * m1, 0.f);
+
+				//Not enough history yet; estimate variance spatially instead
+
+				if (historyLength < 4) {
+
+					f32 s1{}, s2{}, sw{};
+
+					for (i32 j = -1; j <= 1; ++j)
+						for (i32 i = -1; i <= 1; ++i) {
+
+							const Vec2i32 q(x + i, y + j);
+
+							if (!gBuffer.contains(q) || gBuffer[q].w < 0)
+								continue;
+
+							const f32 lq = luminance(lighting[q]);
+							const f32 w = denoiseWeight(s, 0, 0, 1, g, gBuffer[q], s.sigmaZ * g.w * length2(i, j));
+
+							s1 += lq * w;
+							s2 += lq * lq * w;
+							sw += w;
+						}
+
+					s1 /= sw;
+					s2 /= sw;
+					variance = std::max(s2 - s1 * s1, 0.f) * 4 / historyLength;
+				}
+
+				currentMoments[loc] = Vec4f32(m1, m2, hit.w, asFloat(packSurface(g, historyLength)));
+				filtered[loc] = Vec4f32(result.x, result.y, result.z, variance);
+			}
+
+		return filtered;
+	}
+
+	//denoise_atrous.comp
+
+	static DenoiseImage atrous(
+		const DenoiseImage &previous, const DenoiseImage &gBuffer, 
+		DenoiseState &state, const DenoiseImage &currentMoments,
+		const DenoiseSettings &s, i32 stepSize, bool isFirstPass
+	) {
+
+		const Vec2u32 size = previous.size;
+		DenoiseImage filtered(size);
+
+		for (i32 y = 0; y < i32(size.y); ++y)
+			for (i32 x = 0; x < i32(size.x); ++x) {
+
+				const Vec2i32 loc(x, y);
+				const Vec4f32 &g = gBuffer[loc];
+				const Vec4f32 center = previous[loc];
+
+				if (isFirstPass)
+					state.moments[loc] = currentMoments[loc];
+
+				if (g.w < 0) {
+
+					filtered[loc] = center;
+
+					if (isFirstPass)
+						state.history[loc] = {};
+
+					continue;
+				}
+
+				//Blur variance
+
+				f32 variance{};
+
+				for (i32 j = -1; j <= 1; ++j)
+					for (i32 i = -1; i <= 1; ++i) {
+
+						const Vec2i32 q(
+							std::clamp(x + i, 0, i32(size.x) - 1), 
+							std::clamp(y + j, 0, i32(size.y) - 1)
+						);
+
+						const f32 k = (i == 0 ? 0.5f : 0.25f) * (j == 0 ? 0.5f : 0.25f);
+						variance += previous[q].w * k;
+					}
+
+				const f32 lum = luminance(center);
+				const f32 phiL = s.sigmaL * std::sqrt(std::max(variance, 1e-10f));
+
+				Vec4f32 sumColor = center;
+				f32 sumVariance = center.w, sumWeight = 1;
+
+				for (i32 j = -2; j <= 2; ++j)
+					for (i32 i = -2; i <= 2; ++i) {
+
+						if (!i && !j)
+							continue;
+
+						const Vec2i32 q(x + i * stepSize, y + j * stepSize);
+
+						if (!gBuffer.contains(q) || gBuffer[q].w < 0)
+							continue;
+
+						const Vec4f32 sq = previous[q];
+
+						const f32 w =
+							denoiseKernel[std::abs(i)] * denoiseKernel[std::abs(j)] / (denoiseKernel[0] * denoiseKernel[0]) *
+							denoiseWeight(s, lum, luminance(sq), phiL, g, gBuffer[q], s.sigmaZ * g.w * length2(i, j) * f32(stepSize));
+
+						sumColor += sq * w;
+						sumVariance += sq.w * w * w;
+						sumWeight += w;
+					}
+
+				const Vec4f32 result = Vec4f32(
+					sumColor.x / sumWeight, sumColor.y / sumWeight, sumColor.z / sumWeight, 
+					sumVariance / (sumWeight * sumWeight)
+				);
+
+				filtered[loc] = result;
+
+				if (isFirstPass)
+					state.history[loc] = Vec4f32(result.x, result.y, result.z, g.w);
+			}
+
+		return filtered;
+	}
+
+	DenoiseImage denoiseReference(
+		const DenoiseFrame &frame,
+		const DenoiseCamera *previous,
+		DenoiseState &state,
+		const DenoiseSettings &settings
+	) {
+
+		const Vec2u32 size = frame.lighting.size;
+
+		if (state.history.size.x != size.x || state.history.size.y != size.y) {
+			state.history = DenoiseImage(size);
+			state.moments = DenoiseImage(size);
+			previous = nullptr;
+		}
+
+		DenoiseImage currentMoments(size);
+		DenoiseImage result = temporal(frame, previous, state, currentMoments, settings);
+
+		for (u32 i = 0; i < settings.iterations; ++i)
+			result = atrous(result, frame.gBuffer, state, currentMoments, settings, 1 << i, i == 0);
+
+		return result;
+	}
+
+	f64 denoiseDifference(const DenoiseImage &a, const DenoiseImage &b) {
+
+		if (a.size.x != b.size.x || a.size.y != b.size.y || a.pixels.empty())
+			return 0;
+
+		f64 sum{};
+
+		for (usz i = 0, j = a.pixels.size(); i < j; ++i) {
+			const Vec4f32 d = a.pixels[i] - b.pixels[i];
+			sum += f64(d.x) * d.x + f64(d.y) * d.y + f64(d.z) * d.z;
+		}
+
+		return std::sqrt(sum / (a.pixels.size() * 3));
+	}
+
+}
\ No newline at end of file
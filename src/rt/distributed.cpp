@@ -0,0 +1,143 @@
+#include "rt/distributed.hpp"
+#include "rt/tiled_export.hpp"
+#include "system/system.hpp"
+#include "system/log.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace igx::rt {
+
+	static constexpr u32 partialMagic = 0x43434152;		//RACC
+	static constexpr u32 partialVersion = 1;
+
+	bool writePartialAccumulation(const String &path, const PartialAccumulation &partial) {
+
+		if (partial.sum.size() != usz(partial.width) * partial.height * 4)
+			return false;
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		//Written under another name first, so the coordinator never sees half a file
+
+		const std::filesystem::path temp = String(path) + ".tmp";
+
+		{
+			std::ofstream out(temp, std::ios::binary);
+
+			const u32 header[] = { partialMagic, partialVersion, partial.width, partial.height, partial.sampleStart, partial.samples };
+
+			out.write((const c8*) header, sizeof(header));
+			out.write((const c8*) partial.sum.data(), std::streamsize(partial.sum.size() * sizeof(f32)));
+
+			if (!out)
+				return false;
+		}
+
+		std::filesystem::rename(temp, file, ec);
+		return !ec;
+	}
+
+	bool readPartialAccumulation(const String &path, PartialAccumulation &partial) {
+
+		std::ifstream in(std::filesystem::path(path), std::ios::binary);
+
+		u32 header[6]{};
+
+		if (!in.read((c8*) header, sizeof(header)) || header[0] != partialMagic || header[1] != partialVersion)
+			return false;
+
+		partial.width = header[2];
+		partial.height = header[3];
+		partial.sampleStart = header[4];
+		partial.samples = header[5];
+
+		partial.sum.resize(usz(partial.width) * partial.height * 4);
+		return bool(in.read((c8*) partial.sum.data(), std::streamsize(partial.sum.size() * sizeof(f32))));
+	}
+
+	bool mergePartialAccumulations(const List<PartialAccumulation> &partials, PartialAccumulation &result) {
+
+		if (partials.empty())
+			return false;
+
+		//Sample ranges may not overlap, otherwise the same samples are counted twice
+
+		List<Vec2u32> ranges;
+
+		for (const PartialAccumulation &partial : partials) {
+
+			if (partial.width != partials[0].width || partial.height != partials[0].height)
+				return false;
+
+			ranges.push_back(Vec2u32(partial.sampleStart, partial.sampleStart + partial.samples));
+		}
+
+		std::sort(ranges.begin(), ranges.end(), [](const Vec2u32 &a, const Vec2u32 &b) { return a.x < b.x; });
+
+		for (usz i = 1; i < ranges.size(); ++i)
+			if (ranges[i].x < ranges[i - 1].y)
+				return false;
+
+		result.width = partials[0].width;
+		result.height = partials[0].height;
+		result.sampleStart = ranges[0].x;
+		result.samples = 0;
+		result.sum.assign(partials[0].sum.size(), 0);
+
+		for (const PartialAccumulation &partial : partials) {
+
+			result.samples += partial.samples;
+
+			for (usz i = 0; i < result.sum.size(); ++i)
+				result.sum[i] += partial.sum[i];
+		}
+
+		return true;
+	}
+
+	String partialAccumulationPath(const String &targetOutput, u32 worker) {
+		return targetOutput + "_part" + std::to_string(worker) + ".acc";
+	}
+
+	Vec2u32 workerSampleRange(u32 targetSamples, u32 worker, u32 workerCount) {
+
+		workerCount = std::max(workerCount, 1u);
+
+		return Vec2u32(
+			u32(u64(targetSamples) * worker / workerCount),
+			u32(u64(targetSamples) * (worker + 1) / workerCount)
+		);
+	}
+
+	bool mergeDistributedExport(const String &targetOutput, u32 workerCount) {
+
+		List<PartialAccumulation> partials(workerCount);
+
+		for (u32 i = 0; i < workerCount; ++i)
+			if (!readPartialAccumulation(partialAccumulationPath(targetOutput, i), partials[i])) {
+				oic::System::log()->error("Couldn't read the partial of worker " + std::to_string(i) + " (" + partialAccumulationPath(targetOutput, i) + ")");
+				return false;
+			}
+
+		PartialAccumulation merged;
+
+		if (!mergePartialAccumulations(partials, merged) || !merged.samples) {
+			oic::System::log()->error("Partials of " + targetOutput + " don't match or their sample ranges overlap");
+			return false;
+		}
+
+		List<f32> &mean = merged.sum;
+
+		for (f32 &v : mean)
+			v /= f32(merged.samples);
+
+		TiledImageFile file(targetOutput + "_merged.pfm", merged.width, merged.height, true);
+		return file.writeTile((const u8*) mean.data(), merged.width, { Vec2u32(0, 0), Vec2u32(merged.width, merged.height) });
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "rt/environment_map.hpp"
+#include "rt/parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace igx::rt {
+
+	static constexpr f32 pi = 3.14159265f;
+	static constexpr f32 oneMinusEpsilon = 0.99999994f;
+
+	static inline f32 luminance(const f32 *rgb) {
+		return rgb[0] * 0.2126f + rgb[1] * 0.7152f + rgb[2] * 0.0722f;
+	}
+
+	Vec3f32 equirectDirection(const Vec2f32 &uv) {
+
+		const f32 phi = (uv.x - 0.5f) * 2 * pi, psi = (uv.y - 0.5f) * pi;
+		const f32 cosPsi = std::cos(psi);
+
+		return Vec3f32(std::sin(phi) * cosPsi, -std::sin(psi), std::cos(phi) * cosPsi);
+	}
+
+	Vec2f32 equirectUv(const Vec3f32 &dir) {
+		return Vec2f32(
+			std::atan2(dir.x, dir.z) / (2 * pi) + 0.5f,
+			std::asin(std::clamp(-dir.y, -1.f, 1.f)) / pi + 0.5f
+		);
+	}
+
+	//Every cell averages its block of pixels; rows are normalized here, the marginal cdf needs all of them
+
+	void EnvironmentMap::buildRows(
+		const List<f32> &rgb, u32 srcWidth, u32 srcHeight, u32 start, u32 end, List<f32> &rowSums
+	) {
+
+		for (u32 cy = start; cy < end; ++cy) {
+
+			const u32 y0 = u32(u64(cy) * srcHeight / height);
+			const u32 y1 = std::max(u32(u64(cy + 1) * srcHeight / height), y0 + 1);
+
+			const f32 cosLatitude = std::cos(((f32(cy) + 0.5f) / f32(height) - 0.5f) * pi);
+
+			f32 *row = cdf.data() + (height + 1) + usz(cy) * (width + 1);
+			f64 sum{};
+
+			row[0] = 0;
+
+			for (u32 cx = 0; cx < width; ++cx) {
+
+				const u32 x0 = u32(u64(cx) * srcWidth / width);
+				const u32 x1 = std::max(u32(u64(cx + 1) * srcWidth / width), x0 + 1);
+
+				f64 cell{};
+
+				for (u32 y = y0; y < y1; ++y)
+					for (u32 x = x0; x < x1; ++x)
+						cell += luminance(rgb.data() + (usz(y) * srcWidth + x) * 3);
+
+				sum += std::max(cell, 0.0) / (f64(y1 - y0) * (x1 - x0)) * cosLatitude;
+				row[cx + 1] = f32(sum);
+			}
+
+			rowSums[cy] = f32(sum / width);
+
+			for (u32 cx = 1; cx <= width; ++cx)
+				row[cx] = sum > 0 ? f32(row[cx] / sum) : f32(cx) / f32(width);
+
+			row[width] = 1;
+		}
+	}
+
+	void EnvironmentMap::build(const List<f32> &rgb, u32 srcWidth, u32 srcHeight, u32 threads) {
+
+		width = std::min(srcWidth, maxWidth);
+		height = std::min(srcHeight, maxHeight);
+
+		cdf.assign((height + 1) + usz(height) * (width + 1), 0.f);
+
+		if (!width || !height) {
+			cdf.clear();
+			return;
+		}
+
+		List<f32> rowSums(height);
+
+		parallelFor(height, threads, [&](u32 start, u32 end) {
+			buildRows(rgb, srcWidth, srcHeight, start, end, rowSums);
+		});
+
+		//Marginal cdf over the rows
+
+		f64 sum{};
+
+		for (u32 cy = 0; cy < height; ++cy) {
+			sum += rowSums[cy];
+			cdf[cy + 1] = f32(sum);
+		}
+
+		for (u32 cy = 1; cy <= height; ++cy)
+			cdf[cy] = sum > 0 ? f32(cdf[cy] / sum) : f32(cy) / f32(height);
+
+		cdf[height] = 1;
+	}
+
+	//Last interval with cdf[offset + i] <= u; never an empty one
+
+	u32 EnvironmentMap::findInterval(usz offset, u32 count, f32 u) const {
+
+		u32 lo{}, hi = count;
+
+		while (lo + 1 < hi) {
+
+			const u32 mid = (lo + hi) >> 1;
+
+			if (cdf[offset + mid] <= u)
+				lo = mid;
+
+			else hi = mid;
+		}
+
+		return lo;
+	}
+
+	Vec3f32 EnvironmentMap::sample(const Vec2f32 &u, f32 &pdf) const {
+
+		if (empty()) {
+			pdf = 0;
+			return Vec3f32(0, 1, 0);
+		}
+
+		const f32 uy = std::min(u.y, oneMinusEpsilon), ux = std::min(u.x, oneMinusEpsilon);
+
+		const u32 y = findInterval(0, height, uy);
+		const f32 m0 = cdf[y], m1 = cdf[y + 1];
+
+		const usz row = (height + 1) + usz(y) * (width + 1);
+
+		const u32 x = findInterval(row, width, ux);
+		const f32 c0 = cdf[row + x], c1 = cdf[row + x + 1];
+
+		const f32 v = (f32(y) + (uy - m0) / (m1 - m0)) / f32(height);
+		const f32 h = (f32(x) + (ux - c0) / (c1 - c0)) / f32(width);
+
+		const f32 cosPsi = std::cos((v - 0.5f) * pi);
+
+		pdf = cosPsi > 0 ? (m1 - m0) * f32(height) * (c1 - c0) * f32(width) / (2 * pi * pi * cosPsi) : 0;
+
+		return equirectDirection(Vec2f32(h, v));
+	}
+
+	f32 EnvironmentMap::pdf(const Vec3f32 &dir) const {
+
+		if (empty())
+			return 0;
+
+		const f32 cosPsi = std::sqrt(dir.x * dir.x + dir.z * dir.z);
+
+		if (cosPsi <= 0)
+			return 0;
+
+		const Vec2f32 uv = equirectUv(dir);
+
+		const u32 x = std::min(u32(std::max(uv.x, 0.f) * f32(width)), width - 1);
+		const u32 y = std::min(u32(std::max(uv.y, 0.f) * f32(height)), height - 1);
+
+		const usz row = (height + 1) + usz(y) * (width + 1);
+
+		return
+			(cdf[y + 1] - cdf[y]) * f32(height) * (cdf[row + x + 1] - cdf[row + x]) * f32(width) /
+			(2 * pi * pi * cosPsi);
+	}
+
+	List<u8> EnvironmentMap::getGPUData() const {
+
+		const EnvironmentHeader header{ width, height, !empty(), 0 };
+		const usz floats = std::max(cdf.size(), usz(1));
+
+		List<u8> data(sizeof(header) + floats * sizeof(f32));
+		std::memcpy(data.data(), &header, sizeof(header));
+
+		if (!empty())
+			std::memcpy(data.data() + sizeof(header), cdf.data(), cdf.size() * sizeof(f32));
+
+		return data;
+	}
+
+	List<f32> generateTestSky(u32 width, u32 height, bool hasSun) {
+
+		const Vec3f32 sun = Vec3f32(0.3f, 0.6f, 0.5f).normalize();
+
+		List<f32> rgb(usz(width) * height * 3);
+
+		for (u32 y = 0; y < height; ++y)
+			for (u32 x = 0; x < width; ++x) {
+
+				const Vec3f32 dir = equirectDirection(Vec2f32((f32(x) + 0.5f) / f32(width), (f32(y) + 0.5f) / f32(height)));
+				const f32 up = std::max(dir.y, 0.f);
+
+				f32 *texel = rgb.data() + (usz(y) * width + x) * 3;
+
+				texel[0] = dir.y < 0 ? 0.05f : 0.3f * (0.2f + up);
+				texel[1] = dir.y < 0 ? 0.04f : 0.5f * (0.2f + up);
+				texel[2] = dir.y < 0 ? 0.03f : 1.0f * (0.2f + up);
+
+				if (hasSun && dir.x * sun.x + dir.y * sun.y + dir.z * sun.z > 0.9995f)
+					texel[0] = texel[1] = texel[2] = 5000;
+			}
+
+		return rgb;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "rt/export_writer.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace igx::rt {
+
+	ExportWriter::ExportWriter(usz capacity): capacity(std::max(capacity, usz(1))) {
+		worker = std::thread(&ExportWriter::run, this);
+	}
+
+	//Everything that was pushed still gets written
+
+	ExportWriter::~ExportWriter() {
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			shouldStop = true;
+		}
+
+		hasJob.notify_all();
+		worker.join();
+	}
+
+	void ExportWriter::push(Job &&job) {
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			hasSpace.wait(lock, [this] { return jobs.size() < capacity; });
+			jobs.push_back(std::move(job));
+		}
+
+		hasJob.notify_one();
+	}
+
+	void ExportWriter::wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		isIdle.wait(lock, [this] { return jobs.empty() && !isWriting; });
+	}
+
+	usz ExportWriter::pending() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return jobs.size() + usz(isWriting);
+	}
+
+	void ExportWriter::run() {
+
+		while (true) {
+
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				hasJob.wait(lock, [this] { return !jobs.empty() || shouldStop; });
+
+				if (jobs.empty())
+					return;
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+				isWriting = true;
+			}
+
+			hasSpace.notify_one();
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			const bool success = job.write && job.write();
+			const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			if (job.onFinish)
+				job.onFinish(job.path, success, ms);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				isWriting = false;
+			}
+
+			isIdle.notify_all();
+		}
+	}
+
+}
\ No newline at end of file
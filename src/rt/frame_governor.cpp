@@ -0,0 +1,128 @@
+#include "rt/frame_governor.hpp"
+#include <cstdio>
+
+namespace igx::rt {
+
+	static constexpr FrameBudget frameBudgets[] = {
+		{ 1, 1, 1 },
+		{ 1, 1, 0.5f },
+		{ 1, 0.5f, 0.5f },
+		{ 0.875f, 0.5f, 0.5f },
+		{ 0.75f, 0.5f, 0.25f },
+		{ 0.625f, 0.5f, 0.25f },
+		{ 0.5f, 0.25f, 0.25f }
+	};
+
+	u32 frameBudgetLevels() {
+		return u32(_countof(frameBudgets));
+	}
+
+	const FrameBudget &getFrameBudget(u32 level) {
+		return frameBudgets[std::min(level, frameBudgetLevels() - 1)];
+	}
+
+	//Everything is per pixel; roughly 45% shadows (rays and denoising), 15% clouds and the rest primaries and the composite
+
+	f64 frameBudgetCost(u32 level) {
+
+		const FrameBudget &budget = getFrameBudget(level);
+		const f64 pixels = f64(budget.resolutionScale) * budget.resolutionScale;
+
+		return pixels * (0.4 + 0.45 * budget.shadowSamples + 0.15 * budget.cloudSamples);
+	}
+
+	void FrameGovernor::reset() {
+		averageMs = info.targetMs;
+		decisionMs = 0;
+		level = previousLevel = measured = framesAtLevel = framesSinceRaise = backoff = 0;
+		settle = info.settleFrames;
+		hasRaised = false;
+	}
+
+	void FrameGovernor::setLevel(u32 next) {
+
+		//Estimate for the new level until it's measured
+
+		decisionMs = averageMs;
+		averageMs *= frameBudgetCost(next) / frameBudgetCost(level);
+
+		previousLevel = level;
+		level = next;
+		framesAtLevel = measured = 0;
+		settle = info.settleFrames;
+	}
+
+	bool FrameGovernor::update(f64 frameMs) {
+
+		++framesAtLevel;
+		++framesSinceRaise;
+
+		if (settle) {
+			--settle;
+			return false;
+		}
+
+		//A single hitch can't move the average more than a slow frame would
+
+		averageMs += (std::min(frameMs, averageMs * 2) - averageMs) * info.smoothing;
+
+		if (++measured < u32(1 / info.smoothing))
+			return false;
+
+		const f64 target = info.targetMs;
+		const u32 levels = frameBudgetLevels();
+
+		if (averageMs > target * (1 + info.headroom) && level + 1 < levels) {
+
+			u32 next = level + 1;
+
+			while (next + 1 < levels && averageMs * frameBudgetCost(next) / frameBudgetCost(level) > target)
+				++next;
+
+			//Dropped right after a raise; wait longer before trying again
+
+			if (hasRaised && framesSinceRaise <= info.holdFrames)
+				backoff = std::min(backoff + 1, info.maxBackoff);
+
+			else backoff = 0;
+
+			hasRaised = false;
+			setLevel(next);
+			return true;
+		}
+
+		if (
+			level && framesAtLevel >= (info.holdFrames << backoff) &&
+			averageMs * frameBudgetCost(level - 1) / frameBudgetCost(level) < target * (1 - info.headroom)
+		) {
+			hasRaised = true;
+			framesSinceRaise = 0;
+			setLevel(level - 1);
+			return true;
+		}
+
+		return false;
+	}
+
+	String FrameGovernor::report() const {
+
+		const FrameBudget &budget = getBudget();
+		c8 line[192];
+
+		if (level > previousLevel)
+			std::snprintf(
+				line, sizeof(line), "%.1f ms > %.1f ms, level %u -> %u (res %.0f%%, shadows %.0f%%, clouds %.0f%%)",
+				decisionMs, info.targetMs * (1 + info.headroom), previousLevel, level,
+				budget.resolutionScale * 100, budget.shadowSamples * 100, budget.cloudSamples * 100
+			);
+
+		else std::snprintf(
+			line, sizeof(line), "%.1f ms, est. %.1f ms < %.1f ms, level %u -> %u (res %.0f%%, shadows %.0f%%, clouds %.0f%%)",
+			decisionMs, decisionMs * frameBudgetCost(level) / frameBudgetCost(previousLevel), info.targetMs * (1 - info.headroom),
+			previousLevel, level, budget.resolutionScale * 100, budget.shadowSamples * 100, budget.cloudSamples * 100
+		);
+
+		return line;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "rt/gbuffer.hpp"
+#include "rt/half.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace igx::rt {
+
+	//GLSL packSnorm2x16 / unpackSnorm2x16
+
+	static inline u32 packSnorm(f32 v) {
+		return u32(u16(i16(std::round(std::clamp(v, -1.f, 1.f) * 32767))));
+	}
+
+	static inline f32 unpackSnorm(u32 v) {
+		return std::clamp(f32(i16(u16(v))) / 32767, -1.f, 1.f);
+	}
+
+	static inline u32 asUint(f32 v) {
+		u32 res;
+		std::memcpy(&res, &v, sizeof(res));
+		return res;
+	}
+
+	static inline f32 asFloat(u32 v) {
+		f32 res;
+		std::memcpy(&res, &v, sizeof(res));
+		return res;
+	}
+
+	u32 encodeOctNormal(const Vec3f32 &n) {
+
+		const f32 l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+
+		f32 px = n.x / l1, py = n.y / l1;
+
+		if (n.z < 0) {
+			const f32 wx = (1 - std::abs(py)) * (px >= 0 ? 1 : -1);
+			const f32 wy = (1 - std::abs(px)) * (py >= 0 ? 1 : -1);
+			px = wx;
+			py = wy;
+		}
+
+		return packSnorm(px) | (packSnorm(py) << 16);
+	}
+
+	Vec3f32 decodeOctNormal(u32 stored) {
+
+		const f32 px = unpackSnorm(stored), py = unpackSnorm(stored >> 16);
+
+		f32 x = px, y = py;
+		const f32 z = 1 - std::abs(px) - std::abs(py), t = std::max(-z, 0.f);
+
+		x += x >= 0 ? -t : t;
+		y += y >= 0 ? -t : t;
+
+		const f32 len = std::sqrt(x * x + y * y + z * z);
+		return Vec3f32(x / len, y / len, z / len);
+	}
+
+	Vec4u32 encodeGBuffer(const GBufferTexel &texel) {
+		return Vec4u32(
+			asUint(texel.hitT),
+			encodeOctNormal(texel.normal),
+			u32(toHalf(texel.uv.x)) | (u32(toHalf(texel.uv.y)) << 16),
+			texel.object
+		);
+	}
+
+	GBufferTexel decodeGBuffer(const Vec4u32 &stored) {
+		return GBufferTexel{
+			asFloat(stored.x),
+			decodeOctNormal(stored.y),
+			Vec2f32(fromHalf(u16(stored.z)), fromHalf(u16(stored.z >> 16))),
+			stored.w
+		};
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "rt/hdr_export.hpp"
+#include "rt/half.hpp"
+#include "rt/parallel.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define RT_HAS_X64
+#endif
+
+#if defined(RT_HAS_X64) && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace igx::rt {
+
+	#ifdef RT_HAS_X64
+
+		//The rest of the project doesn't require F16C, so only this function is compiled with it
+
+		#if defined(__GNUC__) || defined(__clang__)
+			__attribute__((target("avx,f16c")))
+		#endif
+		static void convertToHalfF16C(const f32 *in, u16 *out, usz count) {
+
+			usz i = 0;
+
+			for (; i + 8 <= count; i += 8) {
+				const __m256 v = _mm256_loadu_ps(in + i);
+				_mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+			}
+
+			for (; i < count; ++i)
+				out[i] = toHalf(in[i]);
+		}
+
+	#endif
+
+	bool hasHalfConversion() {
+
+		#if defined(RT_HAS_X64) && (defined(__GNUC__) || defined(__clang__))
+			static const bool supported = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+			return supported;
+		#elif defined(RT_HAS_X64) && defined(_MSC_VER)
+			static const bool supported = [] {
+				int info[4];
+				__cpuid(info, 1);
+				return (info[2] & (1 << 28)) && (info[2] & (1 << 29));		//avx, f16c
+			}();
+			return supported;
+		#else
+			return false;
+		#endif
+	}
+
+	void convertToHalf(const f32 *in, u16 *out, usz count) {
+
+		#ifdef RT_HAS_X64
+			if (hasHalfConversion())
+				return convertToHalfF16C(in, out, count);
+		#endif
+
+		for (usz i = 0; i < count; ++i)
+			out[i] = toHalf(in[i]);
+	}
+
+	void convertToHalf(const f32 *in, u16 *out, u32 width, u32 height, u32 threads) {
+
+		const usz row = usz(width) * 4;
+
+		parallelFor(height, threads, [=](u32 start, u32 end) {
+			convertToHalf(in + start * row, out + start * row, (end - start) * row);
+		});
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "rt/image_quality.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace igx::rt {
+
+	static constexpr f32 pi = 3.14159265f;
+
+	//What's displayed (see post_processing.glsl); exposure is left out
+
+	static inline f32 toDisplay(f32 c) {
+		c = std::max(c, 0.f);
+		return std::pow(c / (1 + c), 1 / 2.2f);
+	}
+
+	f64 imageRmse(const DenoiseImage &image, const DenoiseImage &reference) {
+
+		if (image.size.x != reference.size.x || image.size.y != reference.size.y || image.pixels.empty())
+			return 0;
+
+		f64 sum{};
+
+		for (usz i = 0, j = image.pixels.size(); i < j; ++i) {
+
+			const Vec4f32 &a = image.pixels[i], &b = reference.pixels[i];
+
+			const f64
+				dx = toDisplay(a.x) - toDisplay(b.x),
+				dy = toDisplay(a.y) - toDisplay(b.y),
+				dz = toDisplay(a.z) - toDisplay(b.z);
+
+			sum += dx * dx + dy * dy + dz * dz;
+		}
+
+		return std::sqrt(sum / f64(image.pixels.size() * 3));
+	}
+
+	f64 imagePsnr(const DenoiseImage &image, const DenoiseImage &reference) {
+
+		const f64 rmse = imageRmse(image, reference);
+
+		if (rmse <= 0)
+			return std::numeric_limits<f64>::infinity();
+
+		return -20 * std::log10(rmse);
+	}
+
+	//FLIP; colours are linear sRGB (the tonemapped values) in D65
+
+	static inline Vec3f32 linearToXyz(const Vec3f32 &c) {
+		return Vec3f32(
+			0.4124564f * c.x + 0.3575761f * c.y + 0.1804375f * c.z,
+			0.2126729f * c.x + 0.7151522f * c.y + 0.0721750f * c.z,
+			0.0193339f * c.x + 0.1191920f * c.y + 0.9503041f * c.z
+		);
+	}
+
+	static inline Vec3f32 xyzToLinear(const Vec3f32 &c) {
+		return Vec3f32(
+			3.2404542f * c.x - 1.5371385f * c.y - 0.4985314f * c.z,
+			-0.9692660f * c.x + 1.8760108f * c.y + 0.0415560f * c.z,
+			0.0556434f * c.x - 0.2040259f * c.y + 1.0572252f * c.z
+		);
+	}
+
+	static const Vec3f32 flipWhite = linearToXyz(Vec3f32(1, 1, 1));
+
+	static inline Vec3f32 xyzToYCxCz(const Vec3f32 &c) {
+		const f32 x = c.x / flipWhite.x, y = c.y / flipWhite.y, z = c.z / flipWhite.z;
+		return Vec3f32(116 * y - 16, 500 * (x - y), 200 * (y - z));
+	}
+
+	static inline Vec3f32 yCxCzToXyz(const Vec3f32 &c) {
+		const f32 y = (c.x + 16) / 116;
+		return Vec3f32((c.y / 500 + y) * flipWhite.x, y * flipWhite.y, (y - c.z / 200) * flipWhite.z);
+	}
+
+	static inline f32 labCurve(f32 t) {
+		static constexpr f32 delta = 6.f / 29;
+		return t > delta * delta * delta ? std::cbrt(t) : t / (3 * delta * delta) + 4.f / 29;
+	}
+
+	//CIELab with the Hunt adjustment (chroma scaled by lightness)
+
+	static inline Vec3f32 xyzToHuntLab(const Vec3f32 &c) {
+
+		const f32
+			x = labCurve(c.x / flipWhite.x),
+			y = labCurve(c.y / flipWhite.y),
+			z = labCurve(c.z / flipWhite.z);
+
+		const f32 l = 116 * y - 16;
+		return Vec3f32(l, 0.01f * l * 500 * (x - y), 0.01f * l * 200 * (y - z));
+	}
+
+	static inline f32 hyAB(const Vec3f32 &a, const Vec3f32 &b) {
+		const f32 da = a.y - b.y, db = a.z - b.z;
+		return std::abs(a.x - b.x) + std::sqrt(da * da + db * db);
+	}
+
+	//Separable filter, clamped at the edges
+
+	static void convolve(const List<f32> &in, List<f32> &out, u32 w, u32 h, const List<f32> &kx, const List<f32> &ky) {
+
+		const i32 rx = i32(kx.size() / 2), ry = i32(ky.size() / 2);
+		List<f32> temp(in.size());
+
+		for (u32 y = 0; y < h; ++y)
+			for (u32 x = 0; x < w; ++x) {
+
+				f32 sum{};
+
+				for (i32 i = -rx; i <= rx; ++i)
+					sum += kx[usz(i + rx)] * in[usz(y) * w + usz(std::clamp(i32(x) + i, 0, i32(w) - 1))];
+
+				temp[usz(y) * w + x] = sum;
+			}
+
+		out.resize(in.size());
+
+		for (u32 y = 0; y < h; ++y)
+			for (u32 x = 0; x < w; ++x) {
+
+				f32 sum{};
+
+				for (i32 i = -ry; i <= ry; ++i)
+					sum += ky[usz(i + ry)] * temp[usz(std::clamp(i32(y) + i, 0, i32(h) - 1)) * w + x];
+
+				out[usz(y) * w + x] = sum;
+			}
+	}
+
+	//Contrast sensitivity as a sum of two gaussians in degrees (a1, b1, a2, b2); achromatic, red-green and blue-yellow
+
+	static constexpr f32 flipCsf[3][4] = {
+		{ 1, 0.0047f, 0, 1e-5f },
+		{ 1, 0.0053f, 0, 1e-5f },
+		{ 34.1f, 0.04f, 13.5f, 0.025f }
+	};
+
+	//1D gaussian of a CSF lobe; returns the sum of its 2D weights (before normalizing) to balance the two lobes
+
+	static f32 csfKernel(f32 b, f32 pixelsPerDegree, i32 radius, List<f32> &kernel) {
+
+		kernel.resize(usz(radius) * 2 + 1);
+		f32 sum{};
+
+		for (i32 i = -radius; i <= radius; ++i) {
+			const f32 x = f32(i) / pixelsPerDegree;
+			sum += kernel[usz(i + radius)] = std::exp(-pi * pi * x * x / b);
+		}
+
+		for (f32 &k : kernel)
+			k /= sum;
+
+		return sum * sum;
+	}
+
+	//Edge (first derivative) and point (second derivative) detectors; positive and negative weights each sum to +-1
+
+	static void featureKernels(f32 pixelsPerDegree, List<f32> &gaussian, List<f32> &edge, List<f32> &point) {
+
+		const f32 sigma = 0.5f * 0.082f * pixelsPerDegree;
+		const i32 radius = i32(std::ceil(3 * sigma));
+		const usz size = usz(radius) * 2 + 1;
+
+		gaussian.resize(size);
+		edge.resize(size);
+		point.resize(size);
+
+		f32 sum{}, edgePositive{}, edgeNegative{}, pointPositive{}, pointNegative{};
+
+		for (i32 i = -radius; i <= radius; ++i) {
+
+			const f32 x = f32(i), g = std::exp(-x * x / (2 * sigma * sigma));
+			const usz j = usz(i + radius);
+
+			sum += gaussian[j] = g;
+
+			const f32 e = edge[j] = -x * g;
+			const f32 p = point[j] = (x * x / (sigma * sigma) - 1) * g;
+
+			(e > 0 ? edgePositive : edgeNegative) += e;
+			(p > 0 ? pointPositive : pointNegative) += p;
+		}
+
+		for (usz j = 0; j < size; ++j) {
+			gaussian[j] /= sum;
+			edge[j] /= edge[j] > 0 ? edgePositive : -edgeNegative;
+			point[j] /= point[j] > 0 ? pointPositive : -pointNegative;
+		}
+	}
+
+	f64 imageFlip(const DenoiseImage &image, const DenoiseImage &reference, f32 pixelsPerDegree) {
+
+		if (image.size.x != reference.size.x || image.size.y != reference.size.y || image.pixels.empty())
+			return 0;
+
+		static constexpr f32 qc = 0.7f, qf = 0.5f, pc = 0.4f, pt = 0.95f;
+
+		const u32 w = image.size.x, h = image.size.y;
+		const usz n = image.pixels.size();
+
+		const f32 maxB = flipCsf[2][1];
+		const i32 radius = i32(std::ceil(3 * std::sqrt(maxB / (2 * pi * pi)) * pixelsPerDegree));
+
+		List<f32> gaussian, edge, point;
+		featureKernels(pixelsPerDegree, gaussian, edge, point);
+
+		//Filtered opponent colours and edge / point strength of both images
+
+		struct Filtered {
+			List<f32> channels[3];
+			List<f32> edges, points;
+		} filtered[2];
+
+		const DenoiseImage *images[2] = { &image, &reference };
+
+		for (u32 k = 0; k < 2; ++k) {
+
+			List<f32> opponent[3], achromatic(n);
+
+			for (auto &channel : opponent)
+				channel.resize(n);
+
+			for (usz i = 0; i < n; ++i) {
+
+				const Vec4f32 &c = images[k]->pixels[i];
+
+				auto tonemap = [](f32 v) {
+					v = std::max(v, 0.f);
+					return v / (1 + v);
+				};
+
+				const Vec3f32 ycxcz = xyzToYCxCz(linearToXyz(Vec3f32(tonemap(c.x), tonemap(c.y), tonemap(c.z))));
+
+				opponent[0][i] = ycxcz.x;
+				opponent[1][i] = ycxcz.y;
+				opponent[2][i] = ycxcz.z;
+				achromatic[i] = (ycxcz.x + 16) / 116;
+			}
+
+			for (u32 c = 0; c < 3; ++c) {
+
+				List<f32> kernel, lobe;
+				const f32 w1 = flipCsf[c][0] * pi / flipCsf[c][1] * csfKernel(flipCsf[c][1], pixelsPerDegree, radius, kernel);
+
+				convolve(opponent[c], filtered[k].channels[c], w, h, kernel, kernel);
+
+				if (flipCsf[c][2] > 0) {
+
+					const f32 w2 = flipCsf[c][2] * pi / flipCsf[c][3] * csfKernel(flipCsf[c][3], pixelsPerDegree, radius, kernel);
+					convolve(opponent[c], lobe, w, h, kernel, kernel);
+
+					for (usz i = 0; i < n; ++i)
+						filtered[k].channels[c][i] = (filtered[k].channels[c][i] * w1 + lobe[i] * w2) / (w1 + w2);
+				}
+			}
+
+			List<f32> dx, dy, px, py;
+			convolve(achromatic, dx, w, h, edge, gaussian);
+			convolve(achromatic, dy, w, h, gaussian, edge);
+			convolve(achromatic, px, w, h, point, gaussian);
+			convolve(achromatic, py, w, h, gaussian, point);
+
+			filtered[k].edges.resize(n);
+			filtered[k].points.resize(n);
+
+			for (usz i = 0; i < n; ++i) {
+				filtered[k].edges[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+				filtered[k].points[i] = std::sqrt(px[i] * px[i] + py[i] * py[i]);
+			}
+		}
+
+		//Largest colour difference is green against blue
+
+		const f32 cmax = std::pow(
+			hyAB(xyzToHuntLab(linearToXyz(Vec3f32(0, 1, 0))), xyzToHuntLab(linearToXyz(Vec3f32(0, 0, 1)))), qc
+		);
+
+		f64 sum{};
+
+		for (usz i = 0; i < n; ++i) {
+
+			Vec3f32 lab[2];
+
+			for (u32 k = 0; k < 2; ++k) {
+
+				const Vec3f32 ycxcz(filtered[k].channels[0][i], filtered[k].channels[1][i], filtered[k].channels[2][i]);
+				const Vec3f32 c = xyzToLinear(yCxCzToXyz(ycxcz));
+
+				lab[k] = xyzToHuntLab(linearToXyz(Vec3f32(
+					std::clamp(c.x, 0.f, 1.f), std::clamp(c.y, 0.f, 1.f), std::clamp(c.z, 0.f, 1.f)
+				)));
+			}
+
+			const f32 colour = std::pow(hyAB(lab[0], lab[1]), qc);
+
+			const f32 deltaColour = colour < pc * cmax ?
+				pt / (pc * cmax) * colour :
+				pt + (colour - pc * cmax) / (cmax - pc * cmax) * (1 - pt);
+
+			const f32 deltaFeature = std::pow(
+				std::max(
+					std::abs(filtered[0].edges[i] - filtered[1].edges[i]),
+					std::abs(filtered[0].points[i] - filtered[1].points[i])
+				) / std::sqrt(2.f),
+				qf
+			);
+
+			sum += std::pow(std::min(deltaColour, 1.f), 1 - deltaFeature);
+		}
+
+		return sum / f64(n);
+	}
+
+	ImageQuality imageQuality(const DenoiseImage &image, const DenoiseImage &reference) {
+		return { imageRmse(image, reference), imagePsnr(image, reference), imageFlip(image, reference) };
+	}
+
+	static constexpr u32 referenceMagic = 0x46455252;		//RREF
+	static constexpr u32 referenceVersion = 1;
+
+	bool writeReferenceImage(const String &path, u64 key, u32 samples, const DenoiseImage &image) {
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		std::ofstream out(file, std::ios::binary);
+
+		const u32 header[] = { referenceMagic, referenceVersion, u32(key), u32(key >> 32), image.size.x, image.size.y, samples };
+
+		out.write((const c8*) header, sizeof(header));
+		out.write((const c8*) image.pixels.data(), std::streamsize(image.pixels.size() * sizeof(Vec4f32)));
+
+		return bool(out);
+	}
+
+	bool readReferenceImage(const String &path, u64 key, DenoiseImage &image) {
+
+		std::ifstream in(std::filesystem::path(path), std::ios::binary);
+
+		u32 header[7]{};
+
+		if (
+			!in.read((c8*) header, sizeof(header)) || header[0] != referenceMagic || header[1] != referenceVersion ||
+			header[2] != u32(key) || header[3] != u32(key >> 32)
+		)
+			return false;
+
+		image = DenoiseImage(Vec2u32(header[4], header[5]));
+		return bool(in.read((c8*) image.pixels.data(), std::streamsize(image.pixels.size() * sizeof(Vec4f32))));
+	}
+
+	//Bilinear, pixel centers aligned
+
+	DenoiseImage upscaleImage(const DenoiseImage &image, const Vec2u32 &size) {
+
+		if (image.size.x == size.x && image.size.y == size.y)
+			return image;
+
+		DenoiseImage res(size);
+
+		const f32 sx = f32(image.size.x) / f32(size.x), sy = f32(image.size.y) / f32(size.y);
+
+		for (u32 y = 0; y < size.y; ++y)
+			for (u32 x = 0; x < size.x; ++x) {
+
+				const f32 fx = std::clamp((f32(x) + 0.5f) * sx - 0.5f, 0.f, f32(image.size.x - 1));
+				const f32 fy = std::clamp((f32(y) + 0.5f) * sy - 0.5f, 0.f, f32(image.size.y - 1));
+
+				const i32 x0 = i32(fx), y0 = i32(fy);
+				const i32 x1 = std::min(x0 + 1, i32(image.size.x) - 1), y1 = std::min(y0 + 1, i32(image.size.y) - 1);
+				const f32 tx = fx - f32(x0), ty = fy - f32(y0);
+
+				const Vec4f32 top = image[Vec2i32(x0, y0)] * (1 - tx) + image[Vec2i32(x1, y0)] * tx;
+				const Vec4f32 bottom = image[Vec2i32(x0, y1)] * (1 - tx) + image[Vec2i32(x1, y1)] * tx;
+
+				res[Vec2i32(i32(x), i32(y))] = top * (1 - ty) + bottom * ty;
+			}
+
+		return res;
+	}
+
+	List<QualityConfig> defaultQualityConfigs() {
+
+		List<QualityConfig> configs(6);
+
+		configs[0].name = "1 shadow sample";
+
+		configs[1].name = "4 shadow samples";
+		configs[1].shadowSamples = 4;
+
+		configs[2].name = "denoised";
+		configs[2].denoise = true;
+
+		configs[3].name = "half resolution";
+		configs[3].resolutionScale = 0.5f;
+
+		configs[4].name = "half resolution denoised";
+		configs[4].resolutionScale = 0.5f;
+		configs[4].denoise = true;
+
+		//Same as the first, so the two are compared at equal error (see equalErrorSpeedup)
+
+		configs[5].name = "adaptive";
+		configs[5].adaptiveError = 0.02f;
+
+		return configs;
+	}
+
+	bool timeToTarget(const QualityCurve &curve, f64 targetFlip, f64 &ms) {
+
+		for (const QualityPoint &point : curve.points)
+			if (point.quality.flip <= targetFlip) {
+				ms = point.ms;
+				return true;
+			}
+
+		return false;
+	}
+
+	i32 cheapestToTarget(const List<QualityCurve> &curves, f64 targetFlip, f64 &ms) {
+
+		i32 best = -1;
+		ms = 0;
+
+		for (usz i = 0; i < curves.size(); ++i) {
+
+			f64 curveMs;
+
+			if (timeToTarget(curves[i], targetFlip, curveMs) && (best < 0 || curveMs < ms)) {
+				best = i32(i);
+				ms = curveMs;
+			}
+		}
+
+		return best;
+	}
+
+	f64 equalErrorSpeedup(const QualityCurve &baseline, const QualityCurve &curve, f64 targetFlip) {
+
+		f64 baselineMs, curveMs;
+
+		if (!timeToTarget(baseline, targetFlip, baselineMs) || !timeToTarget(curve, targetFlip, curveMs) || curveMs <= 0)
+			return 0;
+
+		return baselineMs / curveMs;
+	}
+
+	bool writeQualityCurves(const String &path, const List<QualityCurve> &curves) {
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		std::ofstream out(file);
+		out << "config,shadowSamples,denoise,resolutionScale,adaptiveError,samples,ms,rmse,psnr,flip\n";
+
+		c8 line[512];
+
+		for (const QualityCurve &curve : curves)
+			for (const QualityPoint &point : curve.points) {
+
+				const QualityConfig &config = curve.config;
+
+				std::snprintf(
+					line, sizeof(line), "%s,%u,%u,%.3f,%.4f,%u,%.3f,%.6f,%.3f,%.6f\n",
+					config.name.c_str(), config.shadowSamples, u32(config.denoise), f64(config.resolutionScale),
+					f64(config.adaptiveError), point.samples, point.ms,
+					point.quality.rmse, point.quality.psnr, point.quality.flip
+				);
+
+				out << line;
+			}
+
+		return bool(out);
+	}
+
+}
\ No newline at end of file
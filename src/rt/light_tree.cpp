@@ -0,0 +1,398 @@
+#include "rt/light_tree.hpp"
+#include "rt/half.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace igx::rt {
+
+	static constexpr f32 pi = 3.14159265f;
+
+	static inline f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	static inline Vec3f32 sub(const Vec3f32 &a, const Vec3f32 &b) {
+		return Vec3f32(a.x - b.x, a.y - b.y, a.z - b.z);
+	}
+
+	static inline Vec3f32 mad(const Vec3f32 &a, f32 s, const Vec3f32 &b) {
+		return Vec3f32(a.x * s + b.x, a.y * s + b.y, a.z * s + b.z);
+	}
+
+	static inline Vec3f32 minVec(const Vec3f32 &a, const Vec3f32 &b) {
+		return Vec3f32(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+	}
+
+	static inline Vec3f32 maxVec(const Vec3f32 &a, const Vec3f32 &b) {
+		return Vec3f32(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+	}
+
+	static inline f32 component(const Vec3f32 &a, u32 i) {
+		return i == 0 ? a.x : (i == 1 ? a.y : a.z);
+	}
+
+	static inline f32 surfaceArea(const Vec3f32 &mi, const Vec3f32 &ma) {
+		const Vec3f32 d = sub(ma, mi);
+		return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	//Smallest cone around both cones (Conty Estevez & Kulla 2018)
+
+	static inline void mergeCones(Vec3f32 &axis, f32 &cosTheta, const Vec3f32 &axisB, f32 cosThetaB) {
+
+		if (cosTheta <= -1 || cosThetaB <= -1) {
+			cosTheta = -1;
+			return;
+		}
+
+		f32 theta = std::acos(cosTheta), thetaB = std::acos(cosThetaB);
+		Vec3f32 a = axis, b = axisB;
+
+		if (thetaB > theta) {
+			std::swap(theta, thetaB);
+			std::swap(a, b);
+		}
+
+		const f32 cosD = std::clamp(dot(a, b), -1.f, 1.f), thetaD = std::acos(cosD);
+
+		if (std::min(thetaD + thetaB, pi) <= theta) {
+			axis = a;
+			cosTheta = std::cos(theta);
+			return;
+		}
+
+		const f32 thetaO = (theta + thetaD + thetaB) * 0.5f;
+
+		if (thetaO >= pi) {
+			cosTheta = -1;
+			return;
+		}
+
+		//Rotate a towards b
+
+		const Vec3f32 perp = mad(a, -cosD, b);
+		const f32 perpLen = std::sqrt(dot(perp, perp));
+
+		if (perpLen < 1e-6f) {
+			cosTheta = -1;
+			return;
+		}
+
+		const f32 thetaR = thetaO - theta;
+
+		axis = mad(a, std::cos(thetaR), Vec3f32(
+			perp.x / perpLen * std::sin(thetaR), perp.y / perpLen * std::sin(thetaR), perp.z / perpLen * std::sin(thetaR)
+		));
+
+		cosTheta = std::cos(thetaO);
+	}
+
+	static inline LightNode makeLeaf(const LightTreeInput &light, u32 index) {
+		return LightNode{
+			light.pos, LightTree::leafBit | index,
+			light.pos, light.power,
+			light.axis, light.cosTheta,
+			light.range, {}
+		};
+	}
+
+	static inline LightNode merge(const LightNode &a, const LightNode &b, u32 child) {
+
+		LightNode res{
+			minVec(a.boundsMin, b.boundsMin), child,
+			maxVec(a.boundsMax, b.boundsMax), a.power + b.power,
+			a.axis, a.cosTheta,
+			std::max(a.range, b.range), {}
+		};
+
+		mergeCones(res.axis, res.cosTheta, b.axis, b.cosTheta);
+		return res;
+	}
+
+	//Build
+
+	void LightTree::build(u32 node, List<u32> &order, usz start, usz end, const List<LightTreeInput> &lights) {
+
+		if (end - start == 1) {
+			nodes[node] = makeLeaf(lights[order[start]], firstLight + order[start]);
+			leaves[order[start]] = node;
+			return;
+		}
+
+		//Split along the largest axis of the centroids
+
+		Vec3f32 mi = lights[order[start]].pos, ma = mi;
+
+		for (usz i = start + 1; i < end; ++i) {
+			mi = minVec(mi, lights[order[i]].pos);
+			ma = maxVec(ma, lights[order[i]].pos);
+		}
+
+		const Vec3f32 extent = sub(ma, mi);
+		const u32 axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+		const f32 minAxis = component(mi, axis), axisExtent = component(extent, axis);
+
+		usz mid = start + (end - start) / 2;
+
+		if (axisExtent > 0) {
+
+			//Binned; cost is power * surface area of both sides
+
+			static constexpr u32 bins = 12;
+
+			struct Bin {
+				Vec3f32 mi = Vec3f32(1e30f), ma = Vec3f32(-1e30f);
+				f32 power{};
+				u32 count{};
+			} bin[bins];
+
+			auto binOf = [&](u32 light) {
+				const f32 t = (component(lights[light].pos, axis) - minAxis) / axisExtent;
+				return std::min(u32(t * bins), bins - 1);
+			};
+
+			for (usz i = start; i < end; ++i) {
+				Bin &b = bin[binOf(order[i])];
+				b.mi = minVec(b.mi, lights[order[i]].pos);
+				b.ma = maxVec(b.ma, lights[order[i]].pos);
+				b.power += lights[order[i]].power;
+				++b.count;
+			}
+
+			f32 bestCost = 1e38f;
+			u32 bestSplit = 0;
+
+			for (u32 split = 1; split < bins; ++split) {
+
+				Bin l, r;
+
+				for (u32 i = 0; i < bins; ++i) {
+
+					Bin &side = i < split ? l : r;
+
+					if (!bin[i].count)
+						continue;
+
+					side.mi = minVec(side.mi, bin[i].mi);
+					side.ma = maxVec(side.ma, bin[i].ma);
+					side.power += bin[i].power;
+					side.count += bin[i].count;
+				}
+
+				if (!l.count || !r.count)
+					continue;
+
+				//Area is padded, so coincident lights still prefer balanced splits
+
+				const f32 cost = 
+					(l.power + 1e-6f) * (surfaceArea(l.mi, l.ma) + 1e-4f) * f32(l.count) + 
+					(r.power + 1e-6f) * (surfaceArea(r.mi, r.ma) + 1e-4f) * f32(r.count);
+
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestSplit = split;
+				}
+			}
+
+			if (bestSplit) {
+
+				auto it = std::partition(order.begin() + start, order.begin() + end, [&](u32 light) {
+					return binOf(light) < bestSplit;
+				});
+
+				mid = usz(it - order.begin());
+			}
+		}
+
+		//Children are next to each other and after their parent
+
+		const u32 child = u32(nodes.size());
+		nodes.resize(nodes.size() + 2);
+
+		build(child, order, start, mid, lights);
+		build(child + 1, order, mid, end, lights);
+
+		nodes[node] = merge(nodes[child], nodes[child + 1], child);
+	}
+
+	void LightTree::build(const List<LightTreeInput> &lights, u32 _firstLight) {
+
+		firstLight = _firstLight;
+
+		nodes.clear();
+		leaves.resize(lights.size());
+
+		if (lights.empty())
+			return;
+
+		nodes.reserve(lights.size() * 2 - 1);
+
+		List<u32> order(lights.size());
+
+		for (u32 i = 0; i < u32(order.size()); ++i)
+			order[i] = i;
+
+		nodes.resize(1);
+		build(0, order, 0, order.size(), lights);
+	}
+
+	void LightTree::refit(const List<LightTreeInput> &lights) {
+
+		for (usz i = 0; i < leaves.size(); ++i)
+			nodes[leaves[i]] = makeLeaf(lights[i], firstLight + u32(i));
+
+		for (usz i = nodes.size(); i > 0; --i) {
+
+			LightNode &node = nodes[i - 1];
+
+			if (!(node.child & leafBit))
+				node = merge(nodes[node.child], nodes[node.child + 1], node.child);
+		}
+	}
+
+	//Traversal (same as light_tree.glsl)
+	//Normals follow the shader's convention; NdotL = dot(n, pos - light)
+
+	f32 LightTree::importance(const LightNode &node, const Vec3f32 &pos, const Vec3f32 &n) {
+
+		if (node.power <= 0)
+			return 0;
+
+		//Nothing in the node reaches this point
+
+		const Vec3f32 closest = minVec(maxVec(pos, node.boundsMin), node.boundsMax);
+		const Vec3f32 toClosest = sub(pos, closest);
+
+		const f32 closestDist2 = dot(toClosest, toClosest);
+
+		if (closestDist2 >= node.range * node.range)
+			return 0;
+
+		//Falloff of the closest possible light (upper bound)
+
+		const f32 t = 1 - std::sqrt(closestDist2) / node.range;
+		const f32 power = node.power * t * t * (3 - 2 * t);
+
+		const Vec3f32 center = Vec3f32(
+			(node.boundsMin.x + node.boundsMax.x) * 0.5f,
+			(node.boundsMin.y + node.boundsMax.y) * 0.5f,
+			(node.boundsMin.z + node.boundsMax.z) * 0.5f
+		);
+
+		const Vec3f32 d = sub(pos, center), diag = sub(node.boundsMax, node.boundsMin);
+
+		const f32 dist2 = dot(d, d);
+		const f32 radius2 = std::max(dot(diag, diag) * 0.25f, 1e-4f);
+
+		if (dist2 <= radius2)
+			return power / radius2;
+
+		//Widen the angles by the angle the bounds cover
+
+		const f32 dist = std::sqrt(dist2);
+		const Vec3f32 l = Vec3f32(d.x / dist, d.y / dist, d.z / dist);
+
+		const f32 sinU = std::sqrt(radius2) / dist, cosU = std::sqrt(std::max(1 - sinU * sinU, 0.f));
+
+		const f32 cosI = dot(n, l), sinI = std::sqrt(std::max(1 - cosI * cosI, 0.f));
+		const f32 cosSurface = cosI >= cosU ? 1 : cosI * cosU + sinI * sinU;
+
+		if (cosSurface <= 0)
+			return 0;
+
+		f32 cosEmit = 1;
+
+		if (node.cosTheta > -1) {
+
+			const f32 theta = std::acos(std::clamp(dot(node.axis, l), -1.f, 1.f));
+			const f32 thetaP = std::max(theta - std::acos(node.cosTheta) - std::asin(sinU), 0.f);
+
+			if (thetaP >= pi * 0.5f)
+				return 0;
+
+			cosEmit = std::cos(thetaP);
+		}
+
+		return power * cosSurface * cosEmit / dist2;
+	}
+
+	u32 LightTree::pick(const Vec3f32 &pos, const Vec3f32 &n, f32 u, f32 &pdf) const {
+
+		pdf = 0;
+
+		if (nodes.empty() || importance(nodes[0], pos, n) <= 0)
+			return noLight;
+
+		pdf = 1;
+
+		u32 i = 0;
+
+		while (!(nodes[i].child & leafBit)) {
+
+			const u32 child = nodes[i].child;
+
+			const f32 a = importance(nodes[child], pos, n), b = importance(nodes[child + 1], pos, n);
+
+			if (a + b <= 0) {
+				pdf = 0;
+				return noLight;
+			}
+
+			const f32 p = a / (a + b);
+
+			if (u < p) {
+				u /= p;
+				pdf *= p;
+				i = child;
+			}
+
+			else {
+				u = (u - p) / (1 - p);
+				pdf *= 1 - p;
+				i = child + 1;
+			}
+
+			u = std::min(u, 0.99999994f);
+		}
+
+		return nodes[i].child & ~leafBit;
+	}
+
+	//Same layout as Light in primitive.glsl
+
+	struct PackedLight {
+		Vec3f32 pos;
+		u32 radOrigin;
+		u32 dir[2];
+		u32 colorType[2];
+	};
+
+	static constexpr u32 lightTypePoint = 2;
+
+	List<LightTreeInput> LightTree::fromSceneLights(const u8 *lights, usz count) {
+
+		List<LightTreeInput> res(count);
+
+		for (usz i = 0; i < count; ++i) {
+
+			PackedLight light;
+			std::memcpy(&light, lights + i * sizeof(PackedLight), sizeof(light));
+
+			const f32 r = fromHalf(u16(light.colorType[0])), g = fromHalf(u16(light.colorType[0] >> 16));
+			const f32 b = fromHalf(u16(light.colorType[1]));
+
+			const bool isPoint = (light.colorType[1] >> 16) == lightTypePoint;
+
+			res[i] = LightTreeInput{
+				light.pos, std::max(fromHalf(u16(light.radOrigin)), 0.f),
+				Vec3f32(0, 0, 1), -1,
+				isPoint ? std::max(r * 0.2126f + g * 0.7152f + b * 0.0722f, 0.f) : 0
+			};
+		}
+
+		return res;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "rt/profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace igx::rt {
+
+	Profiler::Profiler(usz capacity): capacity(std::max(capacity, usz(1))), origin(Clock::now()) {}
+
+	void Profiler::add(const String &name, Track track, Clock::time_point start, f64 durationMs) {
+
+		const f64 startMs = std::chrono::duration<f64, std::milli>(start - origin).count();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (events.size() == capacity)
+			events.pop_front();
+
+		events.push_back({ name, track, startMs, durationMs });
+	}
+
+	List<Profiler::Summary> Profiler::summarize() const {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		List<Summary> res;
+		std::unordered_map<String, usz> ids[2];
+
+		for (const Event &e : events) {
+
+			auto it = ids[e.track].find(e.name);
+
+			if (it == ids[e.track].end()) {
+				it = ids[e.track].insert({ e.name, res.size() }).first;
+				res.push_back({ e.name, e.track, 0, 0, 0, 0 });
+			}
+
+			Summary &s = res[it->second];
+			++s.count;
+			s.averageMs += e.durationMs;
+			s.maxMs = std::max(s.maxMs, e.durationMs);
+			s.lastMs = e.durationMs;
+		}
+
+		for (Summary &s : res)
+			s.averageMs /= s.count;
+
+		return res;
+	}
+
+	String Profiler::report(Track track) const {
+
+		String res;
+		c8 line[64];
+
+		for (const Summary &s : summarize())
+			if (s.track == track) {
+				std::snprintf(line, sizeof(line), ": %.3f / %.3f\n", s.averageMs, s.maxMs);
+				res += s.name + line;
+			}
+
+		return res;
+	}
+
+	//Names are ours, but they could still contain quotes
+
+	static String escapeJson(const String &str) {
+
+		String res;
+		res.reserve(str.size());
+
+		for (c8 c : str) {
+
+			if (c == '"' || c == '\\')
+				res += '\\';
+
+			if (u8(c) >= 0x20)
+				res += c;
+		}
+
+		return res;
+	}
+
+	bool Profiler::writeChromeTrace(const String &path) const {
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		std::ofstream out(file);
+
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			c8 timing[96];
+
+			for (const Event &e : events) {
+
+				std::snprintf(
+					timing, sizeof(timing), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					u32(e.track), e.startMs * 1e3, e.durationMs * 1e3
+				);
+
+				out << ",\n{\"name\":\"" << escapeJson(e.name) << "\",\"cat\":\"" << (e.track == CPU ? "cpu" : "gpu") << timing;
+			}
+		}
+
+		out << "\n]}\n";
+		return bool(out);
+	}
+
+	usz Profiler::size() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return events.size();
+	}
+
+	void Profiler::clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		events.clear();
+	}
+
+}
\ No newline at end of file
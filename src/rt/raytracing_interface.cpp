@@ -10,32 +10,113 @@
 #include "igxi/convert.hpp"
 #include "rt/enums.hpp"
 #include "helpers/scene_graph.hpp"
+#include "rt/parallel.hpp"
+#include "rt/hdr_export.hpp"
+#include "rt/half.hpp"
+#include "rt/sky_lighting.hpp"
+#include "system/system.hpp"
+#include "system/log.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 
 using namespace igx::ui;
 using namespace oic;
 
 namespace igx::rt {
 
-	RaytracingInterface::RaytracingInterface(Graphics &g, ui::GUI &gui, FactoryContainer &factory, SceneGraph &sceneGraph) :
+	//What a camera path stores per frame; the camera as uploaded and what it's built from
+
+	struct RecordedCamera {
+		Camera camera;
+		f32 pitch, yaw, roll, speed, leftFov, rightFov;
+	};
+
+	struct RecordedProperties {
+		u8 useProgressive, animateScene, pad0[2];
+	};
+
+	//rgba16f, rgba32f or rgb32f to rgb32f
+
+	static bool skyboxToRgb(const igxi::IGXI &image, List<f32> &rgb) {
+
+		if (image.format.empty() || image.data.empty() || image.data[0].empty()) {
+			oic::System::log()->error("The skybox has no data; it won't be sampled as a light");
+			return false;
+		}
+
+		const Buffer &data = image.data[0][0];
+		const GPUFormat format = image.format[0];
+
+		const usz pixels = usz(image.header.width) * image.header.height;
+		const usz channels = format == GPUFormat::rgb32f ? 3 : 4;
+		const usz stride = format == GPUFormat::rgba16f ? sizeof(u16) : sizeof(f32);
+
+		if (
+			(format != GPUFormat::rgba16f && format != GPUFormat::rgba32f && format != GPUFormat::rgb32f) ||
+			data.size() < pixels * channels * stride
+		) {
+			oic::System::log()->error("The skybox isn't rgba16f, rgba32f or rgb32f; it won't be sampled as a light");
+			return false;
+		}
+
+		rgb.resize(pixels * 3);
+
+		if (format == GPUFormat::rgba16f) {
+
+			const u16 *texels = (const u16*) data.data();
+
+			for (usz i = 0; i < pixels; ++i)
+				for (usz c = 0; c < 3; ++c)
+					rgb[i * 3 + c] = fromHalf(texels[i * 4 + c]);
+		}
+
+		else {
+
+			const f32 *texels = (const f32*) data.data();
+
+			for (usz i = 0; i < pixels; ++i)
+				for (usz c = 0; c < 3; ++c)
+					rgb[i * 3 + c] = texels[i * channels + c];
+		}
+
+		return true;
+	}
+
+	RaytracingInterface::RaytracingInterface(Graphics &g, ui::GUI &gui, FactoryContainer &factory, SceneGraph &sceneGraph, const String &skyboxPath) :
 		g(g), gui(gui), factory(factory),
-		cameraBuffer{
-			g, NAME("Camera buffer"),
-			GPUBuffer::Info(
-				sizeof(Camera), GPUBufferUsage::UNIFORM, GPUMemoryUsage::CPU_WRITE
-			)
-	},
-		compositeTask(cameraBuffer, factory, gui),
-		sceneGraph(&sceneGraph)
+		uniforms(g),
+		cameraUniform(uniforms.add<Camera>(&cameraInspector.value)),
+		previousCameraUniform(uniforms.add(&previousCamera)),
+		compositeTask(uniforms, cameraUniform, previousCameraUniform, factory, gui),
+		sceneGraph(&sceneGraph),
+		setupSegment(g, NAME("Setup"), 64_KiB),
+		compositeSegment(g, NAME("Composite")),
+		errorSegment(g, NAME("Export error")),
+		previewSegment(g, NAME("Export preview"))
 	{
 		compositeTask.switchToScene(&sceneGraph);
 		compositeTask.prepareMode(renderMode);
 
+		//The scene's skybox is also the light (importance sampling and image based lighting), so both load the same file
+		//Only decoded here (like the blue noise); the importance map and prefiltering are built on a worker
+
+		igxi::IGXI skybox{};
+		List<f32> skyboxRgb;
+
+		if (igxi::Helper::loadDiskExternal(skybox, skyboxPath) != igxi::Helper::ErrorMessage::SUCCESS)
+			oic::System::log()->error("Couldn't load the skybox; it won't be sampled as a light");
+
+		else if (skyboxToRgb(skybox, skyboxRgb))
+			compositeTask.setEnvironmentMap(skyboxRgb, skybox.header.width, skybox.header.height);
+
 		//TODO: If kS == 0, there won't be a reflection
 		//		If kD == 0, there won't be shadow rays
 
-		//Reserve command list
+		//Reserve command lists
 
-		cl = { g, NAME("Command list"), CommandList::Info(64_KiB) };
+		for (RenderTask *rt : compositeTask.getSubtasks())
+			subtaskSegments.push_back(CommandSegment(g, rt->getName()));
 
 		gui.addWindow(
 			Window(
@@ -51,6 +132,14 @@ namespace igx::rt {
 				&cameraInspector, ui::Window::DEFAULT_SCROLL_NO_CLOSE
 			)
 		);
+
+		gui.addWindow(
+			ui::Window(
+				"Profiler", EDITOR_PROFILER,
+				Vec2f32(360, 0), Vec2f32(360, 300),
+				&profilerInspector, ui::Window::DEFAULT_SCROLL_NO_CLOSE
+			)
+		);
 	}
 
 	RaytracingInterface::~RaytracingInterface() { 
@@ -66,6 +155,7 @@ namespace igx::rt {
 
 		gui.removeWindow(EDITOR_MAIN);
 		gui.removeWindow(EDITOR_CAMERA);
+		gui.removeWindow(EDITOR_PROFILER);
 	}
 
 	//Create viewport resources
@@ -95,87 +185,383 @@ namespace igx::rt {
 
 	void RaytracingInterface::resize(const ViewportInfo *vp, const Vec2u32& size) {
 
+		auto scope = profiler.scope("Resize");
+
 		g.wait();
-		cl->clear();
 
+		if (vp) {
+			swapchain->onResize(size);
+			gui.resize(size);
+		}
+
+		//The window only shows a preview of the export, the targets stay at export size
+
+		if (vp && exportState.isActive) {
+			compositeTask.setPreview(size);
+			previewSegment.markDirty();
+			return;
+		}
+
+		markCommandsDirty();
+
+		//Size is the output; the camera and every pass but the upscale are at render size (see applyFrameBudget)
+
+		const Vec2u32 renderSize = compositeTask.getRenderSize(size);
 		CPUCamera &camera = cameraInspector;
 
-		camera.width = size.x; 
-		camera.height = size.y;
-		camera.invRes = Vec2f32(1.f / size.x, 1.f / size.y);
+		camera.width = renderSize.x; 
+		camera.height = renderSize.y;
+		camera.invRes = Vec2f32(1.f / renderSize.x, 1.f / renderSize.y);
 
-		camera.tiles = size / THREADS_XY;
+		camera.tiles = renderSize / THREADS_XY;
 
-		if(vp)
-			swapchain->onResize(size);
+		//History targets are recreated, so there's nothing to reproject
+		//Exports always resize, so they only denoise spatially (accumulation takes care of the rest)
+
+		lastCamera.isValid = 0;
+		shouldResetAccumulation = true;
 
 		for (RenderTask *rt : prePasses)
-			rt->resize(size);
+			rt->resize(renderSize);
 
-		gui.resize(size);
 		compositeTask.resize(size);
 
 		for (RenderTask *rt : postPasses)
-			rt->resize(size);
+			rt->resize(renderSize);
 	}
 
 	//Execute commandList
 
-	void RaytracingInterface::onRenderFinish(UploadBuffer *result, const Pair<u64, u64> &allocation, TextureObject *image, const Vec3u16&, const Vec3u16 &dim, u16, u8, bool) {
+	//Sum of alpha^4 per tile; alpha stores the sqrt of the relative standard error of each pixel (see composite.comp)
+	//Our estimate for the image is the RMS of that
 
-		//Convert to IGXI representation
+	void RaytracingInterface::onExportErrorFinish(UploadBuffer *result, const Pair<u64, u64> &allocation, TextureObject *image, const Vec3u16&, const Vec3u16&, u16, u8, bool) {
 
-		igxi::IGXI igxi{};
+		Buffer data = result->readback(allocation, image->size());
 
-		igxi.header.width = dim.x;
-		igxi.header.height = dim.y;
-		igxi.header.length = dim.z;
-		igxi.header.layers = igxi.header.mips = igxi.header.formats = 1;
+		const f32 *tiles = (const f32*) data.data();
+		const usz count = data.size() / sizeof(f32);
 
-		igxi.header.flags = igxi::IGXI::Flags::CONTAINS_DATA;
-		igxi.header.type = TextureType::TEXTURE_2D;
+		f64 sum = 0;
 
-		igxi.format.push_back(image->getInfo().format);
-		igxi.data.push_back({ result->readback(allocation, image->size()) });
+		for (usz i = 0; i < count; ++i)
+			sum += tiles[i];
 
-		igxi::Helper::toDiskExternal(igxi, properties.value.targetOutput);
+		const f64 pixels = f64(exportState.tileSize.x) * exportState.tileSize.y;
+
+		exportState.error = pixels ? std::sqrt(sum / pixels) : 0;
+		exportState.isDone = shouldStopExport();
 	}
 
-	void RaytracingInterface::fillCommandList() {
+	//Only read back once the tile is done
 
-		bool needsCommandUpdate = false;
+	void RaytracingInterface::onRenderFinish(UploadBuffer *result, const Pair<u64, u64> &allocation, TextureObject *image, const Vec3u16&, const Vec3u16 &dim, u16, u8, bool) {
 
-		for (RenderTask *rt : prePasses)
-			if (rt->needsCommandUpdate()) {
-				needsCommandUpdate = true;
-				break;
-			}
+		auto scope = profiler.scope("Export readback");
 
-		if (compositeTask.needsCommandUpdate())
-			needsCommandUpdate = true;
+		Buffer data = result->readback(allocation, image->size());
 
-		for (RenderTask *rt : postPasses)
-			if (rt->needsCommandUpdate()) {
-				needsCommandUpdate = true;
-				break;
+		const u32 rows = std::max(u32(dim.y), 1u);
+		const usz rowPixels = data.size() / 4 / rows;
+
+		//Finalizing and writing happens on the writer thread; the readback is moved, not copied
+
+		if (exportState.tiledOutput) {
+
+			exportWriter.push({
+				properties.value.targetOutput + ".ppm",
+
+				[data = std::move(data), dim, file = exportState.tiledOutput, tile = exportState.tiles[exportState.tile]]() {
+					return file->writeTile(data.data(), dim.x, tile);
+				},
+
+				{}
+			});
+
+			return;
+		}
+
+		const auto format = image->getInfo().format;
+
+		exportWriter.push({
+			properties.value.targetOutput,
+
+			[data = std::move(data), dim, format, rows, rowPixels, path = properties.value.targetOutput]() mutable {
+
+				parallelFor(rows, 0, [&](u32 start, u32 end) {
+					for (usz i = start * rowPixels, j = end * rowPixels; i < j; ++i)
+						data[i * 4 + 3] = 255;
+				});
+
+				//Convert to IGXI representation
+
+				igxi::IGXI igxi{};
+
+				igxi.header.width = dim.x;
+				igxi.header.height = dim.y;
+				igxi.header.length = dim.z;
+				igxi.header.layers = igxi.header.mips = igxi.header.formats = 1;
+
+				igxi.header.flags = igxi::IGXI::Flags::CONTAINS_DATA;
+				igxi.header.type = TextureType::TEXTURE_2D;
+
+				igxi.format.push_back(format);
+				igxi.data.push_back({ std::move(data) });
+
+				igxi::Helper::toDiskExternal(igxi, path);
+				return true;
+			},
+
+			[](const String &path, bool, f64 ms) {
+				oic::System::log()->debug("Exported " + path + " in " + std::to_string(ms) + "ms");
 			}
+		});
+	}
+
+	//The resolved mean before exposure (see composite.comp); only read back after the last chunk
+
+	void RaytracingInterface::onHdrRenderFinish(UploadBuffer *result, const Pair<u64, u64> &allocation, TextureObject *image, const Vec3u16&, const Vec3u16 &dim, u16, u8, bool) {
+
+		if (exportState.isWorker) {
+
+			const u32 worker = std::min(u32(properties.value.workerIndex), u32(properties.value.workerCount) - 1);
+			const String path = partialAccumulationPath(properties.value.targetOutput, worker);
+
+			exportWriter.push({
+				path,
+
+				[data = result->readback(allocation, image->size()), dim, start = exportState.sampleStart, samples = exportState.samples, path]() {
+
+					//Mean to sum; every pixel has the same sample count, since workers don't sample adaptively
+
+					PartialAccumulation partial{ dim.x, dim.y, start, samples, List<f32>(usz(dim.x) * dim.y * 4) };
+					const f32 *mean = (const f32*) data.data();
+
+					for (usz i = 0; i < partial.sum.size(); ++i)
+						partial.sum[i] = samples ? mean[i] * f32(samples) : 0;
+
+					return writePartialAccumulation(path, partial);
+				},
+
+				[](const String &path, bool success, f64 ms) {
+
+					if (success)
+						oic::System::log()->debug("Wrote partial " + path + " in " + std::to_string(ms) + "ms");
+
+					else oic::System::log()->error("Couldn't write partial " + path);
+				}
+			});
+
+			return;
+		}
+
+		const String path = properties.value.targetOutput + "_hdr";
+
+		if (exportState.tiledHdrOutput) {
+
+			exportWriter.push({
+				path + ".pfm",
+
+				[data = result->readback(allocation, image->size()), dim, file = exportState.tiledHdrOutput, tile = exportState.tiles[exportState.tile]]() {
+					return file->writeTile(data.data(), dim.x, tile);
+				},
+
+				{}
+			});
 
-		if (!needsCommandUpdate)
 			return;
+		}
+
+		exportWriter.push({
+			path,
+
+			[data = result->readback(allocation, image->size()), dim, path]() {
+
+				//rgba32f to rgba16f over row bands
+
+				Buffer half(data.size() / 2);
+				convertToHalf((const f32*) data.data(), (u16*) half.data(), dim.x, dim.y);
+
+				igxi::IGXI igxi{};
+
+				igxi.header.width = dim.x;
+				igxi.header.height = dim.y;
+				igxi.header.length = dim.z;
+				igxi.header.layers = igxi.header.mips = igxi.header.formats = 1;
+
+				igxi.header.flags = igxi::IGXI::Flags::CONTAINS_DATA;
+				igxi.header.type = TextureType::TEXTURE_2D;
+
+				igxi.format.push_back(GPUFormat::rgba16f);
+				igxi.data.push_back({ std::move(half) });
+
+				igxi::Helper::toDiskExternal(igxi, path);
+				return true;
+			},
+
+			[](const String &path, bool, f64 ms) {
+				oic::System::log()->debug("Exported " + path + " in " + std::to_string(ms) + "ms");
+			}
+		});
+	}
+
+	void RaytracingInterface::markCommandsDirty() {
+
+		setupSegment.markDirty();
+		compositeSegment.markDirty();
+		errorSegment.markDirty();
+		previewSegment.markDirty();
 
-		cl->clear();
+		for (CommandSegment &seg : prePassSegments)
+			seg.markDirty();
 
-		cl->add(FlushBuffer(cameraBuffer, factory.getDefaultUploadBuffer()));
+		for (CommandSegment &seg : subtaskSegments)
+			seg.markDirty();
+
+		for (CommandSegment &seg : postPassSegments)
+			seg.markDirty();
+	}
+
+	void RaytracingInterface::fillCommandList() {
 
-		sceneGraph->fillCommandList(cl);
+		auto scope = profiler.scope("Record commands");
+		auto start = std::chrono::high_resolution_clock::now();
+
+		//Only re-record the segments of tasks that changed
+
+		const bool needsCompositeUpdate = compositeTask.needsCompositeUpdate();
+
+		bool hasChanged = setupSegment.record(needsCompositeUpdate, [this](CommandList *cl) {
+			cl->add(FlushBuffer(uniforms.getBuffer(), factory.getDefaultUploadBuffer()));
+			sceneGraph->fillCommandList(cl);
+			compositeTask.prepareInitCommands(cl);
+		});
+
+		usz i = 0;
 
 		for (RenderTask *rt : prePasses)
-			rt->prepareCommandList(cl);
+			hasChanged |= prePassSegments[i++].record(rt);
+
+		i = 0;
+
+		for (RenderTask *rt : compositeTask.getSubtasks())
+			hasChanged |= subtaskSegments[i++].record(rt);
+
+		if (exportState.isActive) {
 
-		compositeTask.prepareCommandList(cl);
+			errorSegment.record(needsCompositeUpdate, [this](CommandList *cl) {
+				compositeTask.prepareErrorCommands(cl);
+			});
+
+			previewSegment.record(needsCompositeUpdate, [this](CommandList *cl) {
+				compositeTask.preparePreviewCommands(cl);
+			});
+		}
+
+		hasChanged |= compositeSegment.record(needsCompositeUpdate, [this](CommandList *cl) {
+			compositeTask.prepareCompositeCommands(cl);
+		});
+
+		i = 0;
 
 		for (RenderTask *rt : postPasses)
-			rt->prepareCommandList(cl);
+			hasChanged |= postPassSegments[i++].record(rt);
+
+		//Concatenate segments
+
+		if (hasChanged) {
+
+			frameCommands.clear();
+			frameCommands.push_back(setupSegment.get());
+
+			for (CommandSegment &seg : prePassSegments)
+				frameCommands.push_back(seg.get());
+
+			for (CommandSegment &seg : subtaskSegments)
+				frameCommands.push_back(seg.get());
+
+			frameCommands.push_back(compositeSegment.get());
+
+			for (CommandSegment &seg : postPassSegments)
+				frameCommands.push_back(seg.get());
+		}
+
+		properties.value.recordTime = std::chrono::duration<f64, std::milli>(
+			std::chrono::high_resolution_clock::now() - start
+		).count();
+	}
+
+	//igx has no timestamp queries, but presentToCpu waits for the GPU
+	//So every segment is timed as the difference between submitting the frame up to and including it, and up to the one before
+	//Best of a few tries, since a single submit is noisy. That includes submit and readback overhead, so it's approximate
+	//The re-submits are frozen: they re-render the last frame without advancing accumulation or the denoiser's history parity
+
+	void RaytracingInterface::profileGpuPasses() {
+
+		static constexpr u32 tries = 4;
+
+		fillCommandList();
+
+		List<const CommandSegment*> segments = { &setupSegment };
+
+		for (const CommandSegment &seg : prePassSegments)
+			segments.push_back(&seg);
+
+		for (const CommandSegment &seg : subtaskSegments)
+			segments.push_back(&seg);
+
+		segments.push_back(&compositeSegment);
+
+		for (const CommandSegment &seg : postPassSegments)
+			segments.push_back(&seg);
+
+		UploadBufferRef readback = {
+			g, "Profiler readback",
+			UploadBuffer::Info(
+				compositeTask.getTexture()->size(), 0, 0
+			)
+		};
+
+		compositeTask.setFrozen(true);
+
+		using Clock = Profiler::Clock;
+
+		Clock::time_point passStart = Clock::now();
+		f64 previous{};
+
+		for (usz i = 0; i <= segments.size(); ++i) {
+
+			List<CommandList*> prefix;
+
+			for (usz j = 0; j < i; ++j)
+				prefix.push_back(segments[j]->get());
+
+			f64 best{};
+
+			for (u32 j = 0; j < tries; ++j) {
+
+				const Clock::time_point start = Clock::now();
+
+				g.presentToCpu<RaytracingInterface, &RaytracingInterface::onProfileFinish>(
+					prefix, compositeTask.getTexture(), readback, this
+				);
+
+				const f64 time = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+				best = j ? std::min(best, time) : time;
+			}
+
+			//First is the readback on its own
+
+			if (i) {
+				const f64 duration = std::max(best - previous, 0.0);
+				profiler.add(segments[i - 1]->getName(), Profiler::GPU, passStart, duration);
+				passStart += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64, std::milli>(duration));
+			}
+
+			previous = best;
+		}
+
+		compositeTask.setFrozen(false);
 	}
 
 	void RaytracingInterface::prepareMode(RenderMode mode) {
@@ -191,73 +577,388 @@ namespace igx::rt {
 			rt->prepareMode(mode);
 	}
 
-	void RaytracingInterface::render(const ViewportInfo *vi) {
+	//Frame time is the whole frame (dt); rendering, the UI and waiting for the swapchain
+	//Resolution changes recreate every target, so the governor holds a level for a while (see FrameGovernorInfo)
+
+	void RaytracingInterface::updateGovernor(f64 dt) {
 
-		if (properties.value.shouldOutputNextFrame) {
+		const RaytracingProperties &p = properties.value;
 
-			//Setup render
+		if (!p.useGovernor || renderMode != RenderMode::MQ) {
 
-			isResizeRequested = true;
-			resize(nullptr, properties.value.getRes().cast<Vec2u32>());
+			if (governor.getLevel()) {
+				governor.reset();
+				applyFrameBudget();
+			}
 
-			bool ui = bool(cameraInspector.value.flags & CameraFlags::USE_UI);
-			cameraInspector.value.flags &= ~CameraFlags::USE_UI;
+			return;
+		}
 
-			if(properties.value.targetSamples > 1)
-				cameraInspector.value.flags |= CameraFlags::USE_SUPERSAMPLING;
+		governor.setTarget(1000 / f64(p.targetFps));
 
-			update(vi, 0);
+		if (!governor.update(dt * 1000))
+			return;
 
-			fillCommandList();
+		oic::System::log()->debug("Frame governor: " + governor.report());
+		applyFrameBudget();
+	}
 
-			prepareMode(RenderMode::UQ);
+	void RaytracingInterface::applyFrameBudget(bool shouldResize) {
 
-			UploadBufferRef cpuOutput {
-				g, "Frame output",
+		const FrameBudget &budget = governor.getBudget();
+		RaytracingProperties &p = properties.value;
+
+		p.renderScale = budget.resolutionScale;
+		p.governorLevel = governor.getLevel();
+
+		compositeTask.setSampleBudget(budget.shadowSamples, budget.cloudSamples);
+
+		if (budget.resolutionScale == compositeTask.getRenderScale())
+			return;
+
+		compositeTask.setRenderScale(budget.resolutionScale);
+
+		if (!shouldResize)
+			return;
+
+		const Vec2u16 size = swapchain->getInfo().size;
+		resize(nullptr, Vec2u32(size.x, size.y));
+	}
+
+	void RaytracingInterface::beginExport(const ViewportInfo *vi) {
+
+		//Setup render; tiled exports only allocate the targets at tile size
+
+		const RaytracingProperties &p = properties.value;
+		CPUCamera &camera = cameraInspector;
+
+		const Vec2u32 size = p.getRes().cast<Vec2u32>();
+		const bool isWorker = p.workerCount > 1;
+		const bool isTiled = !isWorker && p.useTiledExport && camera.projectionType == ProjectionType::Default;
+
+		exportState.isWorker = isWorker;
+		exportState.size = size;
+		exportState.tileSize = isTiled ? Vec2u32(std::min(u32(p.exportTileSize), size.x), std::min(u32(p.exportTileSize), size.y)) : size;
+
+		//Exports are at full quality; the governor starts over after
+
+		governor.reset();
+		applyFrameBudget(false);
+
+		isResizeRequested = true;
+		compositeTask.setCompactAccumulation(p.useCompactAccumulation);
+		compositeTask.setHdrOutput(p.useHdrExport || isWorker);
+		resize(nullptr, exportState.tileSize);
+
+		//The window keeps showing the export (and the UI) in between chunks
+
+		const Vec2u16 windowSize = swapchain->getInfo().size;
+		compositeTask.setPreview(Vec2u32(windowSize.x, windowSize.y));
+
+		//Always accumulate, the error estimate needs the sum of squares too
+
+		cameraInspector.value.flags |= CameraFlags::USE_SUPERSAMPLING;
+
+		//update() builds the frustum from the camera size, so it has to see the full frame once
+
+		if (isTiled) {
+			camera.width = size.x;
+			camera.height = size.y;
+		}
+
+		update(vi, 0);
+
+		//Every sample is accumulated, denoising would only blur (and bias) the result
+
+		compositeTask.setDenoiseBypass(true);
+
+		exportState.tiles.clear();
+		exportState.tiledOutput.reset();
+		exportState.tiledHdrOutput.reset();
+		exportState.tile = 0;
+
+		if (isTiled) {
+
+			exportState.frame[0] = camera.p0;
+			exportState.frame[1] = camera.p1;
+			exportState.frame[2] = camera.p2;
+
+			camera.width = exportState.tileSize.x;
+			camera.height = exportState.tileSize.y;
+
+			exportState.tiles = planExportTiles(size, exportState.tileSize);
+			exportState.tiledOutput = std::make_shared<TiledImageFile>(p.targetOutput + ".ppm", size.x, size.y, false);
+
+			if (p.useHdrExport)
+				exportState.tiledHdrOutput = std::make_shared<TiledImageFile>(p.targetOutput + "_hdr.pfm", size.x, size.y, true);
+		}
+
+		//Workers render their own range of the same sequence, so the merged samples don't overlap
+		//They don't sample adaptively; a partial needs the same sample count everywhere
+
+		const u32 worker = std::min(u32(p.workerIndex), u32(p.workerCount) - 1);
+		const Vec2u32 range = workerSampleRange(u32(p.targetSamples), isWorker ? worker : 0, isWorker ? u32(p.workerCount) : 1);
+
+		exportState.sampleStart = range.x;
+		exportState.targetSamples = range.y - range.x;
+
+		if (isWorker)
+			compositeTask.setSampleRange(range.x);
+
+		else if (properties.value.useAdaptiveSampling)
+			compositeTask.setAdaptiveSampling(properties.value.targetError, minConvergedSamples);
+
+		fillCommandList();
+
+		prepareMode(RenderMode::UQ);
+
+		exportState.output = {
+			g, "Frame output",
+			UploadBuffer::Info(
+				compositeTask.getTexture()->size(), 0, 0
+			)
+		};
+
+		exportState.errorOutput = {
+			g, "Frame error output",
+			UploadBuffer::Info(
+				compositeTask.getErrorTiles()->size(), 0, 0
+			)
+		};
+
+		if (properties.value.useHdrExport || isWorker)
+			exportState.hdrOutput = {
+				g, "HDR frame output",
 				UploadBuffer::Info(
-					compositeTask.getTexture()->size(), 0, 0
+					compositeTask.getHdrOutput()->size(), 0, 0
 				)
 			};
 
-			List<CommandList*> cls(properties.value.targetSamples, cl);
+		beginExportTile();
+		exportState.isActive = true;
+
+		properties.value.shouldOutputNextFrame = false;
+		properties.value.shouldCancelExport = false;
+		properties.value.exportProgress = 0;
+		properties.value.exportError = 1;
+	}
+
+	//Points the camera at the current tile (if tiled) and accumulates from scratch
+
+	void RaytracingInterface::beginExportTile() {
+
+		if (!exportState.tiles.empty()) {
+
+			const ExportTile &tile = exportState.tiles[exportState.tile];
+			const Vec2f32 size = exportState.size.cast<Vec2f32>();
+
+			const Vec3f32 right = exportState.frame[1] - exportState.frame[0];
+			const Vec3f32 up = exportState.frame[2] - exportState.frame[0];
+
+			CPUCamera &camera = cameraInspector;
+
+			camera.p0 = exportState.frame[0] + right * (f32(tile.offset.x) / size.x) + up * (f32(tile.offset.y) / size.y);
+			camera.p1 = camera.p0 + right * (f32(exportState.tileSize.x) / size.x);
+			camera.p2 = camera.p0 + up * (f32(exportState.tileSize.y) / size.y);
+
+			uniforms.update();
+			compositeTask.resetAccumulation();
+		}
+
+		exportState.start = std::chrono::high_resolution_clock::now();
+		exportState.samples = 0;
+		exportState.error = 1;
+		exportState.isDone = false;
+	}
+
+	//Submit one chunk of samples, so the window stays responsive in between
+
+	void RaytracingInterface::renderExportChunk() {
+
+		auto scope = profiler.scope("Export chunk");
 
+		RaytracingProperties &p = properties.value;
+
+		fillCommandList();
+
+		const u32 chunk = std::min(u32(p.chunkSamples), exportState.targetSamples - exportState.samples);
+
+		List<CommandList*> cls;
+		cls.reserve(frameCommands.size() * chunk + 1);
+
+		for (u32 i = 0; i < chunk; ++i)
+			cls.insert(cls.end(), frameCommands.begin(), frameCommands.end());
+
+		cls.push_back(errorSegment.get());
+
+		exportState.samples += chunk;
+
+		g.presentToCpu<RaytracingInterface, &RaytracingInterface::onExportErrorFinish>(
+			cls, compositeTask.getErrorTiles(), exportState.errorOutput, this
+		);
+
+		//Nothing left to render; only copies the output. Workers only write their partial (see onHdrRenderFinish)
+
+		if (exportState.isDone && !exportState.isWorker)
 			g.presentToCpu<RaytracingInterface, &RaytracingInterface::onRenderFinish>(
-				cls, compositeTask.getTexture(), cpuOutput, this
+				{}, compositeTask.getTexture(), exportState.output, this
 			);
 
-			//Reset to old state and wait for work to finish
+		if (exportState.isDone && exportState.hdrOutput.exists())
+			g.presentToCpu<RaytracingInterface, &RaytracingInterface::onHdrRenderFinish>(
+				{}, compositeTask.getHdrOutput(), exportState.hdrOutput, this
+			);
+
+		//Every tile gets an equal share of the time budget
+
+		const f64 elapsed = std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - exportState.start).count();
+		const f64 tiles = f64(std::max(exportState.tiles.size(), usz(1)));
+		const f64 tileProgress = std::min(std::max(f64(exportState.samples) / std::max(exportState.targetSamples, 1u), elapsed * tiles / p.timeBudget), 1.0);
+
+		p.exportProgress = f32((exportState.tile + tileProgress) / tiles);
+		p.exportError = f32(exportState.error);
+
+		if (!exportState.isDone)
+			return;
+
+		if (exportState.tile + 1 < exportState.tiles.size() && !p.shouldCancelExport) {
+			++exportState.tile;
+			beginExportTile();
+		}
+
+		else endExport();
+	}
+
+	bool RaytracingInterface::shouldStopExport() const {
+
+		const RaytracingProperties &p = properties.value;
+
+		const f64 elapsed = std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - exportState.start).count();
+		const f64 tiles = f64(std::max(exportState.tiles.size(), usz(1)));
+
+		return 
+			p.shouldCancelExport || exportState.samples >= exportState.targetSamples || elapsed * tiles >= p.timeBudget ||
+			(exportState.samples >= minConvergedSamples && exportState.error <= p.targetError);
+	}
+
+	//Reset to old state
+
+	void RaytracingInterface::endExport() {
+
+		exportState.output.release();
+		exportState.hdrOutput.release();
+		exportState.errorOutput.release();
+		exportState.isActive = false;
+
+		exportState.tiles.clear();
+		exportState.tiledOutput.reset();
+		exportState.tiledHdrOutput.reset();
 
-			Vec2u16 actualSize = swapchain->getInfo().size;
-			resize(nullptr, Vec2u32(actualSize.x, actualSize.y));
+		Vec2u16 actualSize = swapchain->getInfo().size;
+		compositeTask.setCompactAccumulation(false);
+		compositeTask.setHdrOutput(false);
 
-			prepareMode(RenderMode::MQ);
+		if (exportState.isWorker)
+			compositeTask.setSampleRange(0);
 
-			isResizeRequested = false;
-			properties.value.shouldOutputNextFrame = false;
+		compositeTask.setPreview({});
+		resize(nullptr, Vec2u32(actualSize.x, actualSize.y));
 
-			if(ui)
-				cameraInspector.value.flags |= CameraFlags::USE_UI;
+		prepareMode(RenderMode::MQ);
 
-			cameraInspector.value.flags &= ~CameraFlags::USE_SUPERSAMPLING;
+		isResizeRequested = false;
+		properties.value.shouldCancelExport = false;
+
+		cameraInspector.value.flags &= ~CameraFlags::USE_SUPERSAMPLING;
+
+		compositeTask.setAdaptiveSampling(0, 0);
+	}
+
+	//Camera and scene are the export's, so this only shows its progress; the UI stays usable to cancel it
+
+	void RaytracingInterface::renderExportPreview(const ViewportInfo *vi) {
+
+		List<CommandList*> commands;
+
+		if (bool(cameraInspector.value.flags & CameraFlags::USE_UI)) {
+			gui.render(g, vi->offset, vi->monitors);
+			commands.push_back(gui.getCommands());
+		}
+
+		commands.push_back(previewSegment.get());
+
+		g.present(compositeTask.getOutput(), 0, 0, swapchain, commands);
+	}
+
+	void RaytracingInterface::render(const ViewportInfo *vi) {
+
+		if (properties.value.shouldOutputNextFrame && !exportState.isActive)
+			beginExport(vi);
+
+		if (exportState.isActive) {
+
+			renderExportChunk();
+
+			if (exportState.isActive)
+				renderExportPreview(vi);
+
+			return;
+		}
+
+		ProfilerProperties &prof = profilerInspector.value;
+
+		if (prof.shouldProfileGpu) {
+			prof.shouldProfileGpu = false;
+			profileGpuPasses();
+		}
+
+		if (prof.shouldDumpTrace) {
+
+			prof.shouldDumpTrace = false;
+
+			if (profiler.writeChromeTrace(prof.traceOutput))
+				oic::System::log()->debug("Wrote trace to " + prof.traceOutput);
+
+			else oic::System::log()->error("Couldn't write trace to " + prof.traceOutput);
 		}
 
 		//Regular render
 
+		auto scope = profiler.scope("Render");
+
 		fillCommandList();
 		
 		if (!bool(cameraInspector.value.flags & CameraFlags::USE_UI)) {
-			g.present(compositeTask.getTexture(), 0, 0, swapchain, cl);
+			g.present(compositeTask.getOutput(), 0, 0, swapchain, frameCommands);
 			return;
 		}
 
 		gui.render(g, vi->offset, vi->monitors);
-		g.present(compositeTask.getTexture(), 0, 0, swapchain, gui.getCommands(), cl);
+
+		List<CommandList*> commands = { gui.getCommands() };
+		commands.insert(commands.end(), frameCommands.begin(), frameCommands.end());
+
+		g.present(compositeTask.getOutput(), 0, 0, swapchain, commands);
 	}
 
 	//Update eye
 	void RaytracingInterface::update(const ViewportInfo *vi, f64 dt) {
 
+		auto scope = profiler.scope("Update");
+
+		ProfilerProperties &prof = profilerInspector.value;
+
 		if (frameTime >= 1) {
+
+			prof.cpu = profiler.report(Profiler::CPU);
+			prof.gpu = profiler.report(Profiler::GPU);
+			prof.events = u32(profiler.size());
+
+			TraversalCounters traversal;
+
+			if (compositeTask.readTraversalStats(traversal))
+				prof.traversal = traversalReport(traversalRates(traversal, frameTime));
+
 			properties.value.fps = frames / frameTime;
 			frameTime = 0;
 			frames = 0;
@@ -266,15 +967,36 @@ namespace igx::rt {
 		++frames;
 		frameTime += dt;
 
-		for(InputDevice *dev : vi->devices)
-			if (dynamic_cast<Keyboard*>(dev)) {
+		if (prof.shouldToggleRecording) {
 
-				if (dev->isDown(Key::Key_ctrl))
-					dt *= 2;
+			prof.shouldToggleRecording = false;
 
-				if (dev->isDown(Key::Key_shift))
-					dt *= 2;
-			}
+			if (cameraPathRecorder.isRecording())
+				stopRecordingCameraPath();
+
+			else recordCameraPath(prof.cameraPath);
+		}
+
+		//Camera and scene are frozen while exporting
+
+		if (exportState.isActive)
+			return;
+
+		//Replays don't have a viewport; they're also at a fixed size and quality
+
+		if (vi)
+			updateGovernor(dt);
+
+		if (vi)
+			for(InputDevice *dev : vi->devices)
+				if (dynamic_cast<Keyboard*>(dev)) {
+
+					if (dev->isDown(Key::Key_ctrl))
+						dt *= 2;
+
+					if (dev->isDown(Key::Key_shift))
+						dt *= 2;
+				}
 
 		CPUCamera &camera = cameraInspector;
 
@@ -324,18 +1046,110 @@ namespace igx::rt {
 			}
 		}
 
-		std::memcpy(cameraBuffer->getBuffer(), &camera, sizeof(Camera));
-		cameraBuffer->flush(0, sizeof(Camera));
+		previousCamera = lastCamera;
+		lastCamera.set(camera);
+
+		//Progressive accumulation uses the supersampling path, reset happens whenever something changes
+
+		RaytracingProperties &p = properties.value;
+
+		if (cameraPathRecorder.isRecording()) {
+
+			RecordedCamera recorded;
+			std::memset(&recorded, 0, sizeof(recorded));
+			std::memcpy(&recorded.camera, (const Camera*) &camera, sizeof(Camera));
+
+			//Replays are at full quality, so they're sized by the output rather than the governed render size
+
+			if (swapchain.exists()) {
+				const Vec2u16 output = swapchain->getInfo().size;
+				recorded.camera.width = output.x;
+				recorded.camera.height = output.y;
+			}
+
+			recorded.pitch = camera.pitch;
+			recorded.yaw = camera.yaw;
+			recorded.roll = camera.roll;
+			recorded.speed = camera.speed;
+			recorded.leftFov = camera.leftFov;
+			recorded.rightFov = camera.rightFov;
+
+			const RecordedProperties recordedProperties{ u8(p.useProgressive), u8(p.animateScene), {} };
+
+			cameraPathRecorder.add(dt, &recorded, &recordedProperties);
+			prof.recordedFrames = cameraPathRecorder.size();
+		}
+
+		if (p.useProgressive)
+			camera.flags |= CameraFlags::USE_SUPERSAMPLING;
+
+		else camera.flags &= ~CameraFlags::USE_SUPERSAMPLING;
 
-		sceneGraph->update(dt);
+		//Paused scenes (and clouds) don't move, so they can converge
+
+		const f64 sceneDt = p.animateScene ? dt : 0;
+
+		sceneGraph->update(sceneDt);
 
 		for (RenderTask *rt : prePasses)
-			rt->update(dt);
+			rt->update(sceneDt);
 
-		compositeTask.update(dt);
+		compositeTask.update(sceneDt);
 
 		for (RenderTask *rt : postPasses)
-			rt->update(dt);
+			rt->update(sceneDt);
+
+		//Only upload uniforms that changed since last frame
+		//Any change there (camera, properties) invalidates the accumulated samples
+
+		p.uniformBytes = u32(uniforms.update());
+
+		const bool sceneChanged = sceneDt > 0 && hasSceneChanged();
+
+		if (p.uniformBytes || sceneChanged || shouldResetAccumulation || !p.useProgressive) {
+			compositeTask.resetAccumulation();
+			shouldResetAccumulation = false;
+			p.accumulatedSamples = 0;
+		}
+
+		++p.accumulatedSamples;
+
+		//The accumulated mean converges on its own; the denoiser would only blur (and bias) it
+		//History isn't written while it's bypassed, so there's nothing to reproject once it's back
+
+		const bool isAccumulating = p.useProgressive && p.accumulatedSamples > 1;
+
+		if (compositeTask.setDenoiseBypass(isAccumulating) && !isAccumulating) {
+			previousCamera.isValid = 0;
+			uniforms.update();
+		}
+	}
+
+	template<SceneObjectType type>
+	static inline bool updateSceneData(SceneGraph *sceneGraph, List<u8> &cache) {
+
+		const auto &buffer = sceneGraph->getBuffer<type>();
+
+		const u8 *data = buffer->getBuffer();
+		const usz size = buffer->size();
+
+		if (cache.size() == size && !std::memcmp(cache.data(), data, size))
+			return false;
+
+		cache.assign(data, data + size);
+		return true;
+	}
+
+	//Only while the scene is animated; it's a copy of the scene, but paused (and static) scenes don't pay for it
+
+	bool RaytracingInterface::hasSceneChanged() {
+		return
+			updateSceneData<SceneObjectType::TRIANGLE>(sceneGraph, cachedSceneData[0]) |
+			updateSceneData<SceneObjectType::SPHERE>(sceneGraph, cachedSceneData[1]) |
+			updateSceneData<SceneObjectType::CUBE>(sceneGraph, cachedSceneData[2]) |
+			updateSceneData<SceneObjectType::PLANE>(sceneGraph, cachedSceneData[3]) |
+			updateSceneData<SceneObjectType::LIGHT>(sceneGraph, cachedSceneData[4]) |
+			updateSceneData<SceneObjectType::MATERIAL>(sceneGraph, cachedSceneData[5]);
 	}
 
 	//Input
@@ -384,12 +1198,314 @@ namespace igx::rt {
 		}
 	}
 	
+	bool RaytracingInterface::recordCameraPath(const String &path) {
+
+		if (!cameraPathRecorder.begin(path, u32(sizeof(RecordedCamera)), u32(sizeof(RecordedProperties)))) {
+			oic::System::log()->error("Couldn't record camera path to " + path);
+			return false;
+		}
+
+		profilerInspector.value.recordedFrames = 0;
+		oic::System::log()->debug("Recording camera path to " + path);
+		return true;
+	}
+
+	void RaytracingInterface::stopRecordingCameraPath() {
+
+		const u32 recorded = cameraPathRecorder.size();
+
+		if (cameraPathRecorder.end())
+			oic::System::log()->debug("Recorded " + std::to_string(recorded) + " frames of camera path");
+	}
+
+	static bool readRecordedPath(const String &path, CameraPath &cameraPath) {
+
+		if (
+			!readCameraPath(path, cameraPath) ||
+			cameraPath.cameraSize != sizeof(RecordedCamera) || cameraPath.propertiesSize != sizeof(RecordedProperties)
+		) {
+			oic::System::log()->error("Couldn't read camera path " + path + " (or it was recorded by another build)");
+			return false;
+		}
+
+		return true;
+	}
+
+	//Resolution is the current one (the replay's), the rest is as recorded; without UI, since the GUI isn't rendered
+
+	static void applyRecordedFrame(const CameraPath &cameraPath, const CameraPath::Frame &frame, CPUCamera &camera, RaytracingProperties &p) {
+
+		RecordedCamera recorded;
+		std::memcpy(&recorded, cameraPath.getCamera(frame), sizeof(recorded));
+
+		RecordedProperties recordedProperties;
+		std::memcpy(&recordedProperties, cameraPath.getProperties(frame), sizeof(recordedProperties));
+
+		const auto width = camera.width, height = camera.height;
+		const auto invRes = camera.invRes;
+		const auto tiles = camera.tiles;
+
+		(Camera&) camera = recorded.camera;
+
+		camera.width = width;
+		camera.height = height;
+		camera.invRes = invRes;
+		camera.tiles = tiles;
+		camera.flags &= ~CameraFlags::USE_UI;
+
+		camera.pitch = recorded.pitch;
+		camera.yaw = recorded.yaw;
+		camera.roll = recorded.roll;
+		camera.speed = recorded.speed;
+		camera.leftFov = recorded.leftFov;
+		camera.rightFov = recorded.rightFov;
+
+		p.useProgressive = bool(recordedProperties.useProgressive);
+		p.animateScene = bool(recordedProperties.animateScene);
+	}
+
+	bool RaytracingInterface::replayCameraPath(const String &path, List<f64> &frameMs, f64 fixedDt, u32 warmupFrames) {
+
+		CameraPath cameraPath;
+
+		if (!readRecordedPath(path, cameraPath))
+			return false;
+
+		//Offscreen at the size of the first frame; nothing is presented, the readback makes every frame wait for the GPU
+
+		RecordedCamera first;
+		std::memcpy(&first, cameraPath.getCamera(cameraPath.frames[0]), sizeof(first));
+
+		governor.reset();
+		applyFrameBudget(false);
+
+		resize(nullptr, Vec2u32(first.camera.width, first.camera.height));
+		dir = {};
+
+		UploadBufferRef readback = {
+			g, "Replay readback",
+			UploadBuffer::Info(
+				compositeTask.getTexture()->size(), 0, 0
+			)
+		};
+
+		CPUCamera &camera = cameraInspector;
+		RaytracingProperties &p = properties.value;
+
+		frameMs.clear();
+		frameMs.reserve(cameraPath.frames.size());
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		for (usz i = 0, j = cameraPath.frames.size() + warmupFrames; i < j; ++i) {
+
+			const CameraPath::Frame &frame = cameraPath.frames[i < warmupFrames ? 0 : i - warmupFrames];
+			applyRecordedFrame(cameraPath, frame, camera, p);
+
+			const Clock::time_point start = Clock::now();
+
+			update(nullptr, fixedDt > 0 ? fixedDt : frame.dt);
+			fillCommandList();
+
+			g.presentToCpu<RaytracingInterface, &RaytracingInterface::onProfileFinish>(
+				frameCommands, compositeTask.getTexture(), readback, this
+			);
+
+			if (i >= warmupFrames)
+				frameMs.push_back(std::chrono::duration<f64, std::milli>(Clock::now() - start).count());
+		}
+
+		return true;
+	}
+
+	bool RaytracingInterface::replayCameraPath(const String &path, const String &output, f64 fixedDt, u32 warmupFrames) {
+
+		List<f64> frameMs;
+
+		if (!replayCameraPath(path, frameMs, fixedDt, warmupFrames))
+			return false;
+
+		const FrameTimeStats stats = frameTimeStats(frameMs);
+		oic::System::log()->debug("Replayed " + path + ": " + frameTimeReport(stats));
+
+		if (!writeFrameTimes(output, stats, frameMs)) {
+			oic::System::log()->error("Couldn't write frame times to " + output);
+			return false;
+		}
+
+		return true;
+	}
+
+	//The HDR output of a quality run (rgba32f); only copied on the frames that are measured
+
+	void RaytracingInterface::onQualityReadback(UploadBuffer *result, const Pair<u64, u64> &allocation, TextureObject *image, const Vec3u16&, const Vec3u16 &dim, u16, u8, bool) {
+
+		if (!qualityOutput)
+			return;
+
+		Buffer data = result->readback(allocation, image->size());
+
+		*qualityOutput = DenoiseImage(Vec2u32(dim.x, dim.y));
+		std::memcpy(qualityOutput->pixels.data(), data.data(), std::min(data.size(), qualityOutput->pixels.size() * sizeof(Vec4f32)));
+	}
+
+	//Every frame is waited on through the readback, like a replay; the metrics aren't part of the time
+
+	template<typename OnImage>
+	void RaytracingInterface::renderQuality(const QualityConfig &config, const Vec2u32 &size, u32 maxSamples, const OnImage &onImage) {
+
+		//The denoiser only runs while nothing accumulates (see update)
+
+		properties.value.useProgressive = !config.denoise;
+		compositeTask.setShadowSamples(config.shadowSamples, config.denoise);
+
+		//Only while accumulating, same as exports
+
+		compositeTask.setAdaptiveSampling(config.adaptiveError, config.adaptiveError > 0 ? minConvergedSamples : 0);
+
+		compositeTask.setRenderScale(config.resolutionScale);
+		resize(nullptr, size);
+
+		UploadBufferRef readback = {
+			g, "Quality readback",
+			UploadBuffer::Info(
+				compositeTask.getHdrOutput()->size(), 0, 0
+			)
+		};
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		DenoiseImage image;
+		f64 ms{};
+
+		for (u32 samples = 1; samples <= maxSamples; ++samples) {
+
+			const bool isMeasured = !(samples & (samples - 1));
+			qualityOutput = isMeasured ? &image : nullptr;
+
+			const Clock::time_point start = Clock::now();
+
+			update(nullptr, 0);
+			fillCommandList();
+
+			g.presentToCpu<RaytracingInterface, &RaytracingInterface::onQualityReadback>(
+				frameCommands, compositeTask.getHdrOutput(), readback, this
+			);
+
+			ms += std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+			//Compared at output size; lower resolutions go through the same filter as upscale.comp
+
+			if (isMeasured)
+				onImage(samples, ms, upscaleImage(image, size));
+		}
+
+		qualityOutput = nullptr;
+	}
+
+	bool RaytracingInterface::measureQualityPerTime(
+		const String &path, const List<QualityConfig> &configs, const QualityBenchmarkInfo &info, List<QualityCurve> &curves
+	) {
+
+		CameraPath cameraPath;
+
+		if (!readRecordedPath(path, cameraPath))
+			return false;
+
+		//Paused, so every config converges to the same image
+
+		RecordedCamera first;
+		std::memcpy(&first, cameraPath.getCamera(cameraPath.frames[0]), sizeof(first));
+
+		RaytracingProperties &p = properties.value;
+		applyRecordedFrame(cameraPath, cameraPath.frames[0], cameraInspector.value, p);
+		p.animateScene = false;
+
+		governor.reset();
+		applyFrameBudget(false);
+
+		compositeTask.setHdrOutput(true);
+		dir = {};
+
+		const Vec2u32 size(first.camera.width, first.camera.height);
+
+		//Reference is keyed by everything that changes it; the camera, the objects of the scene, size and samples
+		//The skybox isn't, so a different one needs another referencePath
+
+		const u32 referenceSamples = 1u << u32(std::floor(std::log2(f64(std::max(info.referenceSamples, 1u)))));
+		const u32 settings[] = { referenceSamples, info.referenceShadowSamples };
+
+		hasSceneChanged();
+
+		List<u8> keyData((const u8*) &first, (const u8*) &first + sizeof(first));
+		keyData.insert(keyData.end(), (const u8*) settings, (const u8*) settings + sizeof(settings));
+
+		for (const List<u8> &data : cachedSceneData)
+			keyData.insert(keyData.end(), data.begin(), data.end());
+
+		const u64 key = SkyLighting::hash(keyData.data(), keyData.size());
+
+		DenoiseImage reference;
+
+		if (!readReferenceImage(info.referencePath, key, reference) || reference.size.x != size.x || reference.size.y != size.y) {
+
+			QualityConfig config;
+			config.shadowSamples = info.referenceShadowSamples;
+
+			renderQuality(config, size, referenceSamples, [&](u32 samples, f64 ms, const DenoiseImage &image) {
+				if (samples == referenceSamples) {
+					reference = image;
+					oic::System::log()->debug("Rendered quality reference in " + std::to_string(ms) + "ms");
+				}
+			});
+
+			if (!writeReferenceImage(info.referencePath, key, referenceSamples, reference))
+				oic::System::log()->warn("Couldn't cache quality reference to " + info.referencePath);
+		}
+
+		curves.clear();
+
+		for (const QualityConfig &config : configs) {
+
+			QualityCurve curve{ config, {} };
+
+			renderQuality(config, size, info.maxSamples, [&](u32 samples, f64 ms, const DenoiseImage &image) {
+
+				curve.points.push_back({ samples, ms, imageQuality(image, reference) });
+
+				const ImageQuality &quality = curve.points.back().quality;
+				c8 line[256];
+
+				std::snprintf(
+					line, sizeof(line), "%s: %u samples, %.1f ms, RMSE %.5f, PSNR %.2f, FLIP %.4f",
+					config.name.c_str(), samples, ms, quality.rmse, quality.psnr, quality.flip
+				);
+
+				oic::System::log()->debug(line);
+			});
+
+			curves.push_back(std::move(curve));
+		}
+
+		return true;
+	}
+
+	void RaytracingInterface::exportAsWorker(u32 index, u32 count) {
+
+		RaytracingProperties &p = properties.value;
+
+		p.workerCount = u16(std::clamp(count, 1u, 64u));
+		p.workerIndex = u16(std::min(index, u32(p.workerCount) - 1));
+		p.shouldOutputNextFrame = true;
+	}
+
 	void RaytracingInterface::addPrepass(RenderTask *t) {
 
 		t->switchToScene(sceneGraph);
 		t->prepareMode(renderMode);
 
 		prePasses.push_back(t);
+		prePassSegments.push_back(CommandSegment(g, t->getName()));
 	}
 
 	void RaytracingInterface::addPostpass(RenderTask *t) {
@@ -398,5 +1514,6 @@ namespace igx::rt {
 		t->prepareMode(renderMode);
 
 		postPasses.push_back(t);
+		postPassSegments.push_back(CommandSegment(g, t->getName()));
 	}
 };
\ No newline at end of file
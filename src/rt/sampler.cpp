@@ -0,0 +1,76 @@
+#include "rt/sampler.hpp"
+#include <cmath>
+
+namespace igx::rt {
+
+	u32 hashUint(u32 x) {
+		x ^= x >> 16;
+		x *= 0x7FEB352Du;
+		x ^= x >> 15;
+		x *= 0x846CA68Bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	u32 hashCombine(u32 seed, u32 v) {
+		return seed ^ (v + (seed << 6) + (seed >> 2));
+	}
+
+	static inline u32 reverseBits(u32 x) {
+		x = (x << 16) | (x >> 16);
+		x = ((x & 0x00FF00FFu) << 8) | ((x & 0xFF00FF00u) >> 8);
+		x = ((x & 0x0F0F0F0Fu) << 4) | ((x & 0xF0F0F0F0u) >> 4);
+		x = ((x & 0x33333333u) << 2) | ((x & 0xCCCCCCCCu) >> 2);
+		x = ((x & 0x55555555u) << 1) | ((x & 0xAAAAAAAAu) >> 1);
+		return x;
+	}
+
+	static inline u32 laineKarrasPermutation(u32 x, u32 seed) {
+		x += seed;
+		x ^= x * 0x6C50B47Cu;
+		x ^= x * 0xB82F1E52u;
+		x ^= x * 0xC7AFE638u;
+		x ^= x * 0x8D22F6E6u;
+		return x;
+	}
+
+	u32 nestedUniformScramble(u32 x, u32 seed) {
+		return reverseBits(laineKarrasPermutation(reverseBits(x), seed));
+	}
+
+	Vec2f32 sobolOwen2D(u32 index, u32 dimension, u32 seed) {
+
+		const u32 dimSeed = hashCombine(seed, hashUint(dimension));
+
+		u32 i = nestedUniformScramble(index, hashUint(dimSeed));
+		u32 x = reverseBits(i), y = 0;
+
+		for (u32 v = 1u << 31; i; i >>= 1, v ^= v >> 1)
+			if (i & 1)
+				y ^= v;
+
+		x = nestedUniformScramble(x, hashCombine(dimSeed, 1));
+		y = nestedUniformScramble(y, hashCombine(dimSeed, 2));
+
+		return Vec2f32(f32(x >> 8) / 16777216, f32(y >> 8) / 16777216);
+	}
+
+	static inline f32 fract(f32 v) {
+		return v - std::floor(v);
+	}
+
+	Vec2u32 blueNoiseTexel(const Vec2u32 &loc, u32 dimension, const Vec2u32 &size) {
+		return Vec2u32((loc.x + dimension * 47) % size.x, (loc.y + dimension * 17) % size.y);
+	}
+
+	Vec2f32 hashedRotation(const Vec2u32 &loc, u32 dimension) {
+		const u32 h = hashUint(hashCombine(hashCombine(hashUint(loc.x), loc.y), dimension)), h2 = hashUint(h);
+		return Vec2f32(f32(h & 0xFFFFFF) / 0x1000000, f32(h2 & 0xFFFFFF) / 0x1000000);
+	}
+
+	Vec2f32 sample2D(const Vec2f32 &rotation, u32 index, u32 dimension, u32 seed) {
+		const Vec2f32 s = sobolOwen2D(index, dimension, seed);
+		return Vec2f32(fract(s.x + rotation.x), fract(s.y + rotation.y));
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "rt/scene_generator.hpp"
+#include "rt/sampler.hpp"
+#include "rt/parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+
+namespace igx::rt {
+
+	bool parseSceneLayout(const String &name, SceneLayout &layout) {
+
+		if (name == "uniform")
+			layout = SceneLayout::Uniform;
+
+		else if (name == "clustered")
+			layout = SceneLayout::Clustered;
+
+		else if (name == "city")
+			layout = SceneLayout::City_grid;
+
+		else return false;
+
+		return true;
+	}
+
+	const c8 *sceneLayoutName(SceneLayout layout) {
+		switch (layout) {
+			case SceneLayout::Clustered:	return "clustered";
+			case SceneLayout::City_grid:	return "city";
+			default:						return "uniform";
+		}
+	}
+
+	//Sizes of Triangle, sphere, Cube, plane, Light and material index in primitive.glsl
+
+	usz GeneratedScene::gpuBytes() const {
+
+		const usz objects = geometry.triangles.size() / 3 + geometry.spheres.size() + geometry.cubes.size() / 2 + geometry.planes.size();
+
+		return
+			geometry.triangles.size() / 3 * 48 +
+			geometry.spheres.size() * 16 +
+			geometry.cubes.size() / 2 * 24 +
+			geometry.planes.size() * 16 +
+			lights.size() * 32 +
+			objects * sizeof(u32);
+	}
+
+	usz GeneratedScene::hostBytes() const {
+		return
+			geometry.triangles.capacity() * sizeof(Vec3f32) +
+			geometry.spheres.capacity() * sizeof(Vec4f32) +
+			geometry.cubes.capacity() * sizeof(Vec3f32) +
+			geometry.planes.capacity() * sizeof(Vec4f32) +
+			materials.capacity() * sizeof(u32) +
+			lights.capacity() * sizeof(GeneratedLight);
+	}
+
+	static inline f32 random01(u32 &state) {
+		state = hashUint(state);
+		return f32(state & 0xFFFFFF) / 0x1000000;
+	}
+
+	static inline f32 randomRange(u32 &state, f32 min, f32 max) {
+		return random01(state) * (max - min) + min;
+	}
+
+	//Where the next object goes; y is the bottom, so objects sit on or above the ground
+
+	class Placement {
+
+		const SceneGeneratorInfo &info;
+		List<Vec3f32> clusters;
+
+		f32 clusterRadius{};
+
+	public:
+
+		Placement(const SceneGeneratorInfo &info, u32 &state): info(info) {
+
+			if (info.layout != SceneLayout::Clustered)
+				return;
+
+			const usz count = usz(std::clamp<u64>(info.objects / 1000, 1, 4096));
+			clusters.resize(count);
+
+			for (Vec3f32 &center : clusters)
+				center = Vec3f32(
+					randomRange(state, -info.extent, info.extent),
+					randomRange(state, 0, info.extent * 0.1f),
+					randomRange(state, -info.extent, info.extent)
+				);
+
+			clusterRadius = info.extent * 0.05f;
+		}
+
+		Vec3f32 next(u32 &state) const {
+
+			const f32 e = info.extent;
+
+			switch (info.layout) {
+
+				//Roughly gaussian around a random cluster
+
+				case SceneLayout::Clustered: {
+
+					const Vec3f32 &center = clusters[usz(random01(state) * f32(clusters.size())) % clusters.size()];
+
+					auto offset = [&]() {
+						return (random01(state) + random01(state) + random01(state) - 1.5f) / 1.5f * clusterRadius;
+					};
+
+					const Vec3f32 p = center + Vec3f32(offset(), offset(), offset());
+					return Vec3f32(p.x, std::max(p.y, 0.f), p.z);
+				}
+
+				//Streets are the lines between the blocks; objects are anywhere along them
+
+				case SceneLayout::City_grid: {
+
+					const u32 cells = std::max(u32(std::ceil(std::sqrt(f64(info.objects) / 3))), 1u);
+					const f32 block = 2 * e / f32(cells);
+
+					const f32 street = (f32(u32(random01(state) * f32(cells))) + 0.925f) * block - e;
+					const f32 along = randomRange(state, -e, e);
+					const f32 height = randomRange(state, 0, block * 0.1f);
+
+					return random01(state) < 0.5f ? Vec3f32(street, height, along) : Vec3f32(along, height, street);
+				}
+
+				default:
+					return Vec3f32(randomRange(state, -e, e), randomRange(state, 0, e * 0.25f), randomRange(state, -e, e));
+			}
+		}
+	};
+
+	GeneratedScene generateScene(const SceneGeneratorInfo &info) {
+
+		GeneratedScene scene;
+		u32 state = hashUint(info.seed);
+
+		const u64 spheres = (info.objects + 2) / 3, cubes = (info.objects + 1) / 3, triangles = info.objects / 3;
+		const u32 perSoup = std::max(info.trianglesPerSoup, 1u), materials = std::max(info.materials, 1u);
+
+		//Objects get smaller as there are more of them, so dense scenes don't turn into one solid block
+
+		const f32 size = info.extent / std::cbrt(f32(std::max(info.objects, u64(1)))) * 0.5f;
+
+		Placement placement(info, state);
+
+		TraversalScene &geometry = scene.geometry;
+		geometry.triangles.reserve(usz(triangles) * 3);
+		geometry.spheres.reserve(usz(spheres));
+		geometry.cubes.reserve(usz(cubes) * 2);
+
+		scene.materials.reserve(usz(info.objects) + 1);
+
+		//Triangle soups; a few triangles around the same point
+
+		for (u64 i = 0; i < triangles; i += perSoup) {
+
+			const Vec3f32 center = placement.next(state) + Vec3f32(0, size, 0);
+			const u32 material = u32(random01(state) * f32(materials)) % materials;
+
+			for (u64 j = i; j < std::min(i + perSoup, triangles); ++j) {
+
+				for (u32 k = 0; k < 3; ++k)
+					geometry.triangles.push_back(center + Vec3f32(
+						randomRange(state, -size, size), randomRange(state, -size, size), randomRange(state, -size, size)
+					));
+
+				scene.materials.push_back(material);
+			}
+		}
+
+		for (u64 i = 0; i < spheres; ++i) {
+
+			const f32 radius = size * randomRange(state, 0.5f, 1);
+			const Vec3f32 p = placement.next(state);
+
+			geometry.spheres.push_back(Vec4f32(p.x, p.y + radius, p.z, radius));
+			scene.materials.push_back(u32(random01(state) * f32(materials)) % materials);
+		}
+
+		//Cubes are buildings on a grid for cities, otherwise placed like everything else
+
+		const u32 cells = std::max(u32(std::ceil(std::sqrt(f64(cubes)))), 1u);
+		const f32 block = 2 * info.extent / f32(cells);
+
+		for (u64 i = 0; i < cubes; ++i) {
+
+			Vec3f32 start, end;
+
+			if (info.layout == SceneLayout::City_grid) {
+
+				start = Vec3f32(f32(i % cells) * block - info.extent, 0, f32(i / cells) * block - info.extent);
+				end = start + Vec3f32(block * 0.85f, block * randomRange(state, 0.5f, 4), block * 0.85f);
+			}
+
+			else {
+				start = placement.next(state);
+				end = start + Vec3f32(size * randomRange(state, 0.5f, 1), size * randomRange(state, 0.5f, 2), size * randomRange(state, 0.5f, 1));
+			}
+
+			geometry.cubes.push_back(start);
+			geometry.cubes.push_back(end);
+			scene.materials.push_back(u32(random01(state) * f32(materials)) % materials);
+		}
+
+		geometry.planes.push_back(Vec4f32(0, 1, 0, 0));
+		scene.materials.push_back(0);
+
+		//Suns come from above, point lights hover over the ground
+
+		for (u32 i = 0; i < info.directionalLights; ++i)
+			scene.lights.push_back({
+				Vec3f32(randomRange(state, -1, 1), -randomRange(state, 0.5f, 1), randomRange(state, -1, 1)).normalize(),
+				Vec3f32(randomRange(state, 0.5f, 1), randomRange(state, 0.5f, 1), randomRange(state, 0.5f, 1)),
+				0, 0, false
+			});
+
+		for (u32 i = 0; i < info.pointLights; ++i)
+			scene.lights.push_back({
+				Vec3f32(
+					randomRange(state, -info.extent, info.extent),
+					randomRange(state, 0.1f, 0.3f) * info.extent,
+					randomRange(state, -info.extent, info.extent)
+				),
+				Vec3f32(randomRange(state, 0.5f, 1), randomRange(state, 0.5f, 1), randomRange(state, 0.5f, 1)),
+				info.extent * 0.2f, size * 0.5f, true
+			});
+
+		return scene;
+	}
+
+	SceneScaling measureSceneScaling(const SceneGeneratorInfo &info, u32 width, u32 height, u64 testBudget) {
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		static constexpr f32 noHit = std::numeric_limits<f32>::max();
+		static constexpr u32 noRayHit = 0xFFFFFFFF;
+
+		auto start = Clock::now();
+		const GeneratedScene scene = generateScene(info);
+		const f64 generateMs = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+		//A grid of primaries over the frame; as many as the budget allows
+
+		const u64 primitives = u64(scene.materials.size());
+		const u64 rays = std::clamp<u64>(testBudget / primitives, 16, u64(width) * height);
+		const u32 side = std::max(u32(std::sqrt(f64(rays))), 4u);
+
+		const Vec3f32 eye(0, info.extent * 0.15f, -info.extent * 1.2f);
+		const GeneratedLight &light = scene.lights[0];
+
+		TraversalCounters counters;
+		std::mutex mutex;
+
+		start = Clock::now();
+
+		parallelFor(side, 0, [&](u32 begin, u32 end) {
+
+			TraversalTracer tracer(scene.geometry);
+
+			for (u32 y = begin; y < end; ++y)
+				for (u32 x = 0; x < side; ++x) {
+
+					const Vec3f32 dir = Vec3f32(
+						((f32(x) + 0.5f) / f32(side) * 2 - 1) * f32(width) / f32(height),
+						1 - (f32(y) + 0.5f) / f32(side) * 2 - 0.3f,
+						1.5f
+					).normalize();
+
+					u32 object;
+					const f32 hitT = tracer.traceGeometry(eye, dir, noRayHit, object);
+
+					if (hitT == noHit)
+						continue;
+
+					const Vec3f32 hitPos = eye + dir * hitT;
+
+					if (light.isPoint) {
+						const Vec3f32 toLight = light.posOrDir - hitPos;
+						const f32 dist = std::sqrt(toLight.x * toLight.x + toLight.y * toLight.y + toLight.z * toLight.z);
+						tracer.traceOcclusion(hitPos, toLight * (1 / dist), dist, object);
+					}
+
+					else tracer.traceOcclusion(hitPos, light.posOrDir * -1, noHit, object);
+				}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			counters += tracer.counters;
+		});
+
+		const f64 traceMs = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+		const TraversalRates rates = traversalRates(counters, traceMs / 1000);
+		const f64 msPerRay = traceMs / f64(counters[STAT_RAYS] + counters[STAT_SHADOW_RAYS]);
+
+		return {
+			info.objects, generateMs, {}, msPerRay,
+			msPerRay * f64(width) * height * (1 + rates.shadowRaysPerPrimary),
+			rates.testsPerRay,
+			scene.gpuBytes(), scene.hostBytes()
+		};
+	}
+
+	bool appendSceneScaling(const String &path, SceneLayout layout, const SceneScaling &step) {
+
+		const std::filesystem::path file(path);
+		std::error_code ec;
+
+		if (file.has_parent_path())
+			std::filesystem::create_directories(file.parent_path(), ec);
+
+		const bool isNew = !std::filesystem::exists(file, ec);
+
+		std::ofstream out(file, std::ios::app);
+
+		if (isNew)
+			out << "layout,objects,generateMs,frames,meanMs,p50Ms,p95Ms,p99Ms,proxyMsPerRay,proxyFrameMs,testsPerRay,gpuBytes,hostBytes\n";
+
+		c8 line[384];
+
+		std::snprintf(
+			line, sizeof(line), "%s,%llu,%.3f,%u,%.3f,%.3f,%.3f,%.3f,%.6f,%.3f,%.1f,%llu,%llu\n",
+			sceneLayoutName(layout), (unsigned long long) step.objects, step.generateMs,
+			step.frames.frames, step.frames.meanMs, step.frames.p50Ms, step.frames.p95Ms, step.frames.p99Ms,
+			step.proxyMsPerRay, step.proxyFrameMs, step.testsPerRay,
+			(unsigned long long) step.gpuBytes, (unsigned long long) step.hostBytes
+		);
+
+		out << line;
+		return bool(out);
+	}
+
+}
\ No newline at end of file
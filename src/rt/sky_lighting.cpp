@@ -0,0 +1,423 @@
+#include "rt/sky_lighting.hpp"
+#include "rt/environment_map.hpp"
+#include "rt/parallel.hpp"
+#include "rt/half.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace igx::rt {
+
+	static constexpr f32 pi = 3.14159265f;
+
+	static constexpr u32 cacheMagic = 0x4C424949;		//IIBL
+	static constexpr u32 cacheVersion = 1;
+
+	//Prefiltering reads from a box filtered pyramid of at most this size
+
+	static constexpr u32 sourceWidth = 512, sourceHeight = 256;
+
+	struct SkyLightingCache {
+		u32 magic, version, levels, samples;
+		u64 sourceHash, texels;
+	};
+
+	struct Image {
+		List<f32> rgb;
+		u32 width, height;
+	};
+
+	static inline f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	static inline f32 luminance(const Vec3f32 &c) {
+		return c.x * 0.2126f + c.y * 0.7152f + c.z * 0.0722f;
+	}
+
+	//Real SH basis up to l = 2
+
+	static inline void shBasis(const Vec3f32 &d, f32 (&y)[9]) {
+		y[0] = 0.282095f;
+		y[1] = 0.488603f * d.y;
+		y[2] = 0.488603f * d.z;
+		y[3] = 0.488603f * d.x;
+		y[4] = 1.092548f * d.x * d.y;
+		y[5] = 1.092548f * d.y * d.z;
+		y[6] = 0.315392f * (3 * d.z * d.z - 1);
+		y[7] = 1.092548f * d.x * d.z;
+		y[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+	}
+
+	//Hammersley
+
+	static inline f32 radicalInverse2(u32 i) {
+		i = (i << 16) | (i >> 16);
+		i = ((i & 0x00FF00FFu) << 8) | ((i & 0xFF00FF00u) >> 8);
+		i = ((i & 0x0F0F0F0Fu) << 4) | ((i & 0xF0F0F0F0u) >> 4);
+		i = ((i & 0x33333333u) << 2) | ((i & 0xCCCCCCCCu) >> 2);
+		i = ((i & 0x55555555u) << 1) | ((i & 0xAAAAAAAAu) >> 1);
+		return f32(i >> 8) / f32(1 << 24);
+	}
+
+	static inline f32 ggx(f32 NdotH, f32 a2) {
+		const f32 denom = NdotH * NdotH * (a2 - 1) + 1;
+		return a2 / (pi * denom * denom);
+	}
+
+	//Average every block of pixels into a cell
+
+	static Image downsample(const f32 *rgb, u32 srcWidth, u32 srcHeight, u32 width, u32 height, u32 threads) {
+
+		Image res{ List<f32>(usz(width) * height * 3), width, height };
+
+		parallelFor(height, threads, [&](u32 start, u32 end) {
+
+			for (u32 cy = start; cy < end; ++cy) {
+
+				const u32 y0 = u32(u64(cy) * srcHeight / height);
+				const u32 y1 = std::max(u32(u64(cy + 1) * srcHeight / height), y0 + 1);
+
+				for (u32 cx = 0; cx < width; ++cx) {
+
+					const u32 x0 = u32(u64(cx) * srcWidth / width);
+					const u32 x1 = std::max(u32(u64(cx + 1) * srcWidth / width), x0 + 1);
+
+					f64 sum[3]{};
+
+					for (u32 y = y0; y < y1; ++y)
+						for (u32 x = x0; x < x1; ++x)
+							for (u32 c = 0; c < 3; ++c)
+								sum[c] += rgb[(usz(y) * srcWidth + x) * 3 + c];
+
+					const f64 count = f64(y1 - y0) * (x1 - x0);
+
+					for (u32 c = 0; c < 3; ++c)
+						res.rgb[(usz(cy) * width + cx) * 3 + c] = f32(sum[c] / count);
+				}
+			}
+		});
+
+		return res;
+	}
+
+	//Wraps horizontally, clamps vertically
+
+	static inline Vec3f32 bilinear(const Image &image, const Vec3f32 &dir) {
+
+		const Vec2f32 uv = equirectUv(dir);
+
+		const f32 fx = uv.x * f32(image.width) - 0.5f, fy = uv.y * f32(image.height) - 0.5f;
+		const f32 x0 = std::floor(fx), y0 = std::floor(fy);
+		const f32 tx = fx - x0, ty = fy - y0;
+
+		Vec3f32 res{};
+
+		for (u32 j = 0; j < 4; ++j) {
+
+			const i32 x = i32(x0) + i32(j & 1), y = i32(y0) + i32(j >> 1);
+
+			const u32 wx = u32((x % i32(image.width) + i32(image.width)) % i32(image.width));
+			const u32 wy = u32(std::clamp(y, 0, i32(image.height) - 1));
+
+			const f32 weight = (j & 1 ? tx : 1 - tx) * (j >> 1 ? ty : 1 - ty);
+			const f32 *texel = image.rgb.data() + (usz(wy) * image.width + wx) * 3;
+
+			res = res + Vec3f32(texel[0], texel[1], texel[2]) * weight;
+		}
+
+		return res;
+	}
+
+	//GGX importance sampled with n = v = r; samples read from a coarser mip the less likely they are
+	//(Karis 2013, Colbert & Krivanek 2007)
+
+	static Vec3f32 prefilter(const List<Image> &pyramid, const Vec3f32 &n, f32 roughness) {
+
+		const f32 alpha = roughness * roughness, a2 = alpha * alpha;
+
+		const Vec3f32 up = std::abs(n.y) < 0.999f ? Vec3f32(0, 1, 0) : Vec3f32(1, 0, 0);
+		const Vec3f32 tangent = Vec3f32(
+			up.y * n.z - up.z * n.y, up.z * n.x - up.x * n.z, up.x * n.y - up.y * n.x
+		).normalize();
+		const Vec3f32 bitangent(
+			n.y * tangent.z - n.z * tangent.y, n.z * tangent.x - n.x * tangent.z, n.x * tangent.y - n.y * tangent.x
+		);
+
+		const f32 texelSolidAngle = 4 * pi / (f32(pyramid[0].width) * f32(pyramid[0].height));
+		const f32 maxLod = f32(pyramid.size() - 1);
+
+		Vec3f32 sum{};
+		f32 weight{};
+
+		for (u32 i = 0; i < SkyLighting::prefilterSamples; ++i) {
+
+			const f32 u0 = (f32(i) + 0.5f) / f32(SkyLighting::prefilterSamples), u1 = radicalInverse2(i);
+
+			const f32 phi = 2 * pi * u0;
+			const f32 cosTheta = std::sqrt((1 - u1) / (1 + (a2 - 1) * u1));
+			const f32 sinTheta = std::sqrt(std::max(1 - cosTheta * cosTheta, 0.f));
+
+			const Vec3f32 h =
+				tangent * (sinTheta * std::cos(phi)) + bitangent * (sinTheta * std::sin(phi)) + n * cosTheta;
+
+			const Vec3f32 l = h * (2 * cosTheta) - n;
+			const f32 NdotL = dot(n, l);
+
+			if (NdotL <= 0)
+				continue;
+
+			const f32 pdf = ggx(cosTheta, a2) / 4;
+			const f32 sampleSolidAngle = 1 / (f32(SkyLighting::prefilterSamples) * pdf + 1e-6f);
+
+			const f32 lod = std::clamp(0.5f * std::log2(sampleSolidAngle / texelSolidAngle), 0.f, maxLod);
+			const u32 lod0 = u32(lod), lod1 = std::min(lod0 + 1, u32(maxLod));
+			const f32 t = lod - f32(lod0);
+
+			const Vec3f32 color = bilinear(pyramid[lod0], l) * (1 - t) + bilinear(pyramid[lod1], l) * t;
+
+			sum = sum + color * NdotL;
+			weight += NdotL;
+		}
+
+		return weight > 0 ? sum * (1 / weight) : sum;
+	}
+
+	void SkyLighting::build(const List<f32> &rgb, u32 width, u32 height, u32 threads) {
+
+		header = {};
+		texels.clear();
+
+		if (!width || !height)
+			return;
+
+		//Project onto SH9; every row sums into its own slot so there's nothing to synchronize
+
+		List<f64> rows(usz(height) * 27);
+
+		parallelFor(height, threads, [&](u32 start, u32 end) {
+
+			f32 y[9];
+
+			for (u32 py = start; py < end; ++py) {
+
+				const f32 v = (f32(py) + 0.5f) / f32(height);
+				const f64 solidAngle = (2 * f64(pi) / width) * (f64(pi) / height) * std::cos((v - 0.5f) * pi);
+
+				f64 *row = rows.data() + usz(py) * 27;
+
+				for (u32 px = 0; px < width; ++px) {
+
+					shBasis(equirectDirection(Vec2f32((f32(px) + 0.5f) / f32(width), v)), y);
+
+					const f32 *texel = rgb.data() + (usz(py) * width + px) * 3;
+
+					for (u32 i = 0; i < 9; ++i)
+						for (u32 c = 0; c < 3; ++c)
+							row[i * 3 + c] += texel[c] * y[i] * solidAngle;
+				}
+			}
+		});
+
+		//Convolve with the cosine lobe (pi, 2pi/3, pi/4) and divide by pi
+
+		static constexpr f64 band[] = { 1, 2 / 3.0, 2 / 3.0, 2 / 3.0, 0.25, 0.25, 0.25, 0.25, 0.25 };
+
+		for (u32 i = 0; i < 9; ++i) {
+
+			f64 sum[3]{};
+
+			for (u32 py = 0; py < height; ++py)
+				for (u32 c = 0; c < 3; ++c)
+					sum[c] += rows[usz(py) * 27 + i * 3 + c];
+
+			header.sh[i] = Vec4f32(f32(sum[0] * band[i]), f32(sum[1] * band[i]), f32(sum[2] * band[i]), 0);
+		}
+
+		//Box filtered pyramid to prefilter from
+
+		List<Image> pyramid;
+		pyramid.push_back(downsample(
+			rgb.data(), width, height, std::min(width, sourceWidth), std::min(height, sourceHeight), threads
+		));
+
+		while (pyramid.back().width > 1 && pyramid.back().height > 1) {
+			const Image &last = pyramid.back();
+			pyramid.push_back(downsample(last.rgb.data(), last.width, last.height, last.width / 2, last.height / 2, threads));
+		}
+
+		//Mips; level 0 stays the skybox itself
+
+		header.levels = levels;
+
+		u32 offset{};
+
+		for (u32 i = 1; i < levels; ++i) {
+			header.mips[i] = Vec4u32(std::max(baseWidth >> (i - 1), 1u), std::max(baseHeight >> (i - 1), 1u), offset, 0);
+			offset += header.mips[i].x * header.mips[i].y;
+		}
+
+		texels.resize(usz(offset) * 4);
+
+		for (u32 i = 1; i < levels; ++i) {
+
+			const u32 w = header.mips[i].x, h = header.mips[i].y;
+			u16 *mip = texels.data() + usz(header.mips[i].z) * 4;
+
+			const f32 roughness = f32(i) / f32(levels - 1);
+
+			parallelFor(h, threads, [&](u32 start, u32 end) {
+				for (u32 y = start; y < end; ++y)
+					for (u32 x = 0; x < w; ++x) {
+
+						const Vec3f32 n = equirectDirection(Vec2f32((f32(x) + 0.5f) / f32(w), (f32(y) + 0.5f) / f32(h)));
+						const Vec3f32 color = prefilter(pyramid, n, roughness);
+
+						u16 *texel = mip + (usz(y) * w + x) * 4;
+						texel[0] = toHalf(color.x);
+						texel[1] = toHalf(color.y);
+						texel[2] = toHalf(color.z);
+						texel[3] = toHalf(1);
+					}
+			});
+		}
+	}
+
+	//FNV-1a
+
+	u64 SkyLighting::hash(const u8 *data, usz size) {
+
+		u64 h = 0xCBF29CE484222325;
+
+		for (usz i = 0; i < size; ++i)
+			h = (h ^ data[i]) * 0x100000001B3;
+
+		return h;
+	}
+
+	bool SkyLighting::save(const String &path, u64 sourceHash) const {
+
+		if (empty())
+			return false;
+
+		const std::filesystem::path file(path);
+
+		if (file.has_parent_path()) {
+			std::error_code ec;
+			std::filesystem::create_directories(file.parent_path(), ec);
+		}
+
+		std::ofstream out(file, std::ios::binary);
+
+		if (!out)
+			return false;
+
+		const SkyLightingCache cache{ cacheMagic, cacheVersion, levels, prefilterSamples, sourceHash, texels.size() };
+
+		out.write((const c8*) &cache, sizeof(cache));
+		out.write((const c8*) &header, sizeof(header));
+		out.write((const c8*) texels.data(), std::streamsize(texels.size() * sizeof(u16)));
+
+		return bool(out);
+	}
+
+	bool SkyLighting::load(const String &path, u64 sourceHash) {
+
+		std::ifstream in(std::filesystem::path(path), std::ios::binary);
+
+		if (!in)
+			return false;
+
+		SkyLightingCache cache{};
+		in.read((c8*) &cache, sizeof(cache));
+
+		if (
+			!in || cache.magic != cacheMagic || cache.version != cacheVersion || cache.levels != levels ||
+			cache.samples != prefilterSamples || cache.sourceHash != sourceHash
+		)
+			return false;
+
+		SkyLightingHeader loaded{};
+		in.read((c8*) &loaded, sizeof(loaded));
+
+		//Texel count has to match the layout; otherwise the file is corrupt
+
+		u64 expected{};
+
+		for (u32 i = 1; i < levels; ++i)
+			expected += u64(loaded.mips[i].x) * loaded.mips[i].y * 4;
+
+		if (!in || loaded.levels != levels || cache.texels != expected || !expected)
+			return false;
+
+		List<u16> data(usz(cache.texels));
+		in.read((c8*) data.data(), std::streamsize(data.size() * sizeof(u16)));
+
+		if (!in)
+			return false;
+
+		header = loaded;
+		texels = std::move(data);
+		return true;
+	}
+
+	Vec3f32 SkyLighting::irradiance(const Vec3f32 &dir) const {
+
+		f32 y[9];
+		shBasis(dir, y);
+
+		Vec3f32 res{};
+
+		for (u32 i = 0; i < 9; ++i)
+			res = res + Vec3f32(header.sh[i].x, header.sh[i].y, header.sh[i].z) * y[i];
+
+		return Vec3f32(std::max(res.x, 0.f), std::max(res.y, 0.f), std::max(res.z, 0.f));
+	}
+
+	Vec3f32 SkyLighting::fetch(u32 level, i32 x, i32 y) const {
+
+		const Vec4u32 &mip = header.mips[level];
+
+		const u32 wx = u32((x % i32(mip.x) + i32(mip.x)) % i32(mip.x));
+		const u32 wy = u32(std::clamp(y, 0, i32(mip.y) - 1));
+
+		const u16 *texel = texels.data() + (usz(mip.z) + usz(wy) * mip.x + wx) * 4;
+		return Vec3f32(fromHalf(texel[0]), fromHalf(texel[1]), fromHalf(texel[2]));
+	}
+
+	Vec3f32 SkyLighting::prefiltered(u32 level, const Vec3f32 &dir) const {
+
+		const Vec4u32 &mip = header.mips[level];
+		const Vec2f32 uv = equirectUv(dir);
+
+		const f32 fx = uv.x * f32(mip.x) - 0.5f, fy = uv.y * f32(mip.y) - 0.5f;
+		const f32 x0 = std::floor(fx), y0 = std::floor(fy);
+		const f32 tx = fx - x0, ty = fy - y0;
+
+		const i32 x = i32(x0), y = i32(y0);
+
+		return
+			(fetch(level, x, y) * (1 - tx) + fetch(level, x + 1, y) * tx) * (1 - ty) +
+			(fetch(level, x, y + 1) * (1 - tx) + fetch(level, x + 1, y + 1) * tx) * ty;
+	}
+
+	List<u8> SkyLighting::getGPUData(bool useIrradiance) const {
+
+		SkyLightingHeader gpuHeader = header;
+		gpuHeader.useIrradiance = useIrradiance && !empty();
+		gpuHeader.enabled = !empty();
+
+		const usz texelBytes = std::max(texels.size(), usz(4)) * sizeof(u16);
+
+		List<u8> data(sizeof(gpuHeader) + texelBytes);
+		std::memcpy(data.data(), &gpuHeader, sizeof(gpuHeader));
+
+		if (!empty())
+			std::memcpy(data.data() + sizeof(gpuHeader), texels.data(), texels.size() * sizeof(u16));
+
+		return data;
+	}
+
+}
\ No newline at end of file
@@ -2,6 +2,15 @@
 
 namespace igx::rt {
 
+	void PreviousCamera::set(const Camera &camera) {
+		eye = camera.eye;
+		p0 = camera.p0;
+		p1 = camera.p1;
+		p2 = camera.p2;
+		projectionType = u32(camera.projectionType.value);
+		isValid = 1;
+	}
+
 	Mat3x3f32 CPUCamera::getRot() const {
 
 		const f32
@@ -5,9 +5,12 @@
 
 namespace igx::rt {
 
-	CloudNoiseTask::CloudNoiseTask(FactoryContainer &factory, const String &name, const GPUBufferRef &data, const TextureRef &output) :
+	CloudNoiseTask::CloudNoiseTask(
+		FactoryContainer &factory, const String &name,
+		const UniformManager &uniforms, u32 data, const TextureRef &output
+	) :
 		RenderTask(factory.getGraphics(), NAME("Cloud noise"), Vec4f32(0.5f, 0.5f, 0.5f, 1.f)), 
-		factory(factory), output(output), data(data)
+		factory(factory), output(output)
 	{
 		Vec3u32 inf = output->getDimensions().cast<Vec3u32>();
 
@@ -21,7 +24,7 @@ namespace igx::rt {
 
 		layout = factory.get(
 			NAME(name + " layout"), {
-				RegisterLayout(NAME("NoiseData"), 0, GPUBufferType::UNIFORM, 0, 0, ShaderAccess::COMPUTE, data->size()),
+				RegisterLayout(NAME("NoiseData"), 0, GPUBufferType::UNIFORM, 0, 0, ShaderAccess::COMPUTE, uniforms.getSize(data)),
 				RegisterLayout(NAME("Target"), 1, GPUBufferType::UNIFORM, 1, 0, ShaderAccess::COMPUTE, sizeof(inf)),
 				RegisterLayout(NAME("worleyOutput"), 2, TextureType::TEXTURE_3D, 0, 0, ShaderAccess::COMPUTE, GPUFormat::r8, true)
 			}
@@ -31,7 +34,7 @@ namespace igx::rt {
 			factory.getGraphics(), NAME(name + " descriptors"),
 			Descriptors::Info(
 				layout, 0, {
-					{ 0, GPUSubresource(data, GPUBufferType::UNIFORM) },
+					{ 0, uniforms.getSubresource(data) },
 					{ 1, GPUSubresource(targetRes, GPUBufferType::UNIFORM) },
 					{ 2, GPUSubresource(output, TextureType::TEXTURE_3D) }
 				}
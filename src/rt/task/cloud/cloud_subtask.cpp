@@ -6,23 +6,27 @@
 namespace igx::rt {
 
 	CloudSubtask::CloudSubtask(
-		FactoryContainer &factory, const String &name, bool, RaygenTask *primaries, 
+		FactoryContainer &factory, const String &name, bool isShadowPass, RaygenTask *primaries, 
 		List<RegisterLayout> layouts, const DescriptorsRef &cloudDescriptors,
-		const GPUBufferRef &uniformBuffer, const TextureRef &noiseOutputHQ, const TextureRef &noiseOutputLQ,
-		const DescriptorsRef &cameraDescriptor
+		const TextureRef &noiseOutputHQ, const TextureRef &noiseOutputLQ,
+		const DescriptorsRef &cameraDescriptor, u32 shadowRes
 	):
 		TextureRenderTask(
 			factory.getGraphics(),
-			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::outputFormat, GPUMemoryUsage::GPU_WRITE_ONLY), 
+			Texture::Info(
+				TextureType::TEXTURE_2D, isShadowPass ? GPUFormat::r8 : GPUFormat::outputFormat, 
+				GPUMemoryUsage::GPU_WRITE_ONLY
+			), 
 			name
 		),
 
 		factory(factory), primaries(primaries), cloudDescriptors(cloudDescriptors),
-		uniformBuffer(uniformBuffer), noiseOutputHQ(noiseOutputHQ), noiseOutputLQ(noiseOutputLQ),
-		cameraDescriptor(cameraDescriptor)
+		noiseOutputHQ(noiseOutputHQ), noiseOutputLQ(noiseOutputLQ),
+		cameraDescriptor(cameraDescriptor), shadowRes(shadowRes), isShadowPass(isShadowPass)
 	{
 		layouts.push_back(RegisterLayout(
-			NAME("Output"), 5, TextureType::TEXTURE_2D, 0, 2, ShaderAccess::COMPUTE, GPUFormat::outputFormat, true
+			NAME("Output"), 5, TextureType::TEXTURE_2D, 0, 2, ShaderAccess::COMPUTE, 
+			isShadowPass ? GPUFormat::r8 : GPUFormat::outputFormat, true
 		));
 
 		shaderLayout = factory.get(NAME(name + " layout"), layouts);
@@ -31,7 +35,7 @@ namespace igx::rt {
 			NAME(name + " shader"), 
 			Pipeline::Info(
 				Pipeline::Flag::NONE,
-				VIRTUAL_FILE("shaders/clouds.comp.spv"),
+				VIRTUAL_FILE(isShadowPass ? "shaders/cloud_shadow.comp.spv" : "shaders/clouds.comp.spv"),
 				{},
 				shaderLayout,
 				Vec3u32(THREADS_XY, THREADS_XY, 1)
@@ -41,7 +45,7 @@ namespace igx::rt {
 
 	void CloudSubtask::resize(const Vec2u32 &size) {
 
-		TextureRenderTask::resize(size);
+		TextureRenderTask::resize(isShadowPass ? Vec2u32(shadowRes, shadowRes) : size);
 
 		outputDescriptor.release();
 		outputDescriptor = {
@@ -54,6 +58,11 @@ namespace igx::rt {
 		};
 	}
 
+	void CloudSubtask::setShadowResolution(u32 res) {
+		shadowRes = res;
+		resize(Vec2u32(res, res));
+	}
+
 	void CloudSubtask::prepareCommandList(CommandList *cl) {
 		cl->add(
 			BindDescriptors({ cameraDescriptor, cloudDescriptors, outputDescriptor }),
@@ -3,6 +3,7 @@
 #include "rt/task/cloud/cloud_noise.hpp"
 #include "rt/enums.hpp"
 #include "rt/structs.hpp"
+#include "rt/frame_governor.hpp"
 #include "helpers/scene_graph.hpp"
 
 namespace igx::rt {
@@ -12,7 +13,7 @@ namespace igx::rt {
 	CloudTask::CloudTask(
 		RaygenTask *primaries,
 		FactoryContainer &factory, ui::GUI &gui,
-		const DescriptorsRef &camera
+		UniformManager &uniforms, const DescriptorsRef &camera
 	) :
 		RenderTask(factory.getGraphics(), NAME("Cloud task"), Vec4f32(1, 1, 1, 1)),
 		gui(gui),
@@ -22,24 +23,22 @@ namespace igx::rt {
 
 		//Set up buffers and samplers
 
-		uniformBuffer = {
-			factory.getGraphics(), NAME("Cloud uniform buffer"),
-			GPUBuffer::Info(
-				sizeof(CloudBuffer), GPUBufferUsage::UNIFORM, GPUMemoryUsage::CPU_WRITE
-			)
-		};
-
-		noiseUniformData = {
-			factory.getGraphics(), NAME("Noise uniform buffer"),
-			GPUBuffer::Info(
-				sizeof(NoiseUniformData), GPUBufferUsage::UNIFORM, GPUMemoryUsage::CPU_WRITE
-			)
-		};
+		uniformBuffer = uniforms.add<CloudBuffer>(&cloudBuffer.value);
+		noiseUniformData = uniforms.add(&noiseUniforms.value);
 
 		linearSampler = factory.get(
 			NAME("Linear repeat sampler"), Sampler::Info(SamplerMin::LINEAR, SamplerMag::LINEAR, SamplerMode::REPEAT, 1.f)
 		);
 
+		//The G-buffer is an integer format, so it can't be filtered
+
+		nearestSampler = factory.get(
+			NAME("Nearest clamp sampler"),
+			Sampler::Info(
+				SamplerMin::NEAREST, SamplerMag::NEAREST, SamplerMode::CLAMP_BORDER, 1.f
+			)
+		);
+
 		//Set up noise output
 		
 		noiseOutputHQ = {
@@ -63,6 +62,13 @@ namespace igx::rt {
 			RegisterLayout(NAME("Lights"),			4, GPUBufferType::STRUCTURED,	0, 1, ShaderAccess::COMPUTE, sizeof(Light))
 		};
 
+		//Density taps; only counted by debug shaders (see stats.glsl)
+
+		#ifndef NDEBUG
+			cloudLayouts.push_back(RegisterLayout(NAME("TraversalTotals"), 6, GPUBufferType::STRUCTURED, 12, 1, ShaderAccess::COMPUTE, sizeof(u64), true));
+			cloudLayouts.push_back(RegisterLayout(NAME("TraversalPixels"), 7, GPUBufferType::STRUCTURED, 13, 1, ShaderAccess::COMPUTE, sizeof(u32), true));
+		#endif
+
 		cloudLayout = factory.get(NAME("Cloud layout"), cloudLayouts);
 
 		cloudDescriptors = {
@@ -71,19 +77,27 @@ namespace igx::rt {
 				cloudLayout, 1,
 				{
 					{ 1, GPUSubresource(linearSampler, noiseOutputHQ, TextureType::TEXTURE_3D) },
-					{ 3, GPUSubresource(uniformBuffer, GPUBufferType::UNIFORM) }
+					{ 3, uniforms.getSubresource(uniformBuffer) }
 				}
 			)
 		};
 
+		cachedShadowRes = shadowProperties->Resolution;
+
 		tasks.add(
 
-			new CloudNoiseTask(factory, NAME("Cloud noise HQ"), noiseUniformData, noiseOutputHQ),
-			new CloudNoiseTask(factory, NAME("Cloud noise LQ"), noiseUniformData, noiseOutputLQ),
+			noiseTasks[0] = new CloudNoiseTask(factory, NAME("Cloud noise HQ"), uniforms, noiseUniformData, noiseOutputHQ),
+			noiseTasks[1] = new CloudNoiseTask(factory, NAME("Cloud noise LQ"), uniforms, noiseUniformData, noiseOutputLQ),
 
 			subtasks[0] = new CloudSubtask(
 				factory, NAME("Cloud subtask"), false, primaries,
-				cloudLayouts, cloudDescriptors, uniformBuffer, noiseOutputHQ, noiseOutputLQ, camera
+				cloudLayouts, cloudDescriptors, noiseOutputHQ, noiseOutputLQ, camera
+			),
+
+			subtasks[1] = new CloudSubtask(
+				factory, NAME("Cloud shadow subtask"), true, primaries,
+				cloudLayouts, cloudDescriptors, noiseOutputHQ, noiseOutputLQ, camera,
+				cachedShadowRes
 			)
 		);
 
@@ -96,10 +110,16 @@ namespace igx::rt {
 			"Cloud noise editor", EDITOR_CLOUD_NOISE, Vec2f32(0, 900), Vec2f32(300, 180),
 			&noiseUniforms, ui::Window::Flags::DEFAULT_SCROLL_NO_CLOSE
 		));
+
+		gui.addWindow(ui::Window(
+			"Cloud shadow editor", EDITOR_CLOUD_SHADOW, Vec2f32(300, 900), Vec2f32(300, 180),
+			&shadowProperties, ui::Window::Flags::DEFAULT_SCROLL_NO_CLOSE
+		));
 	}
 
 	CloudTask::~CloudTask() {
 		gui.removeWindow(EDITOR_CLOUDS);
+		gui.removeWindow(EDITOR_CLOUD_SHADOW);
 	}
 
 	bool CloudTask::needsCommandUpdate() const {
@@ -107,6 +127,11 @@ namespace igx::rt {
 		if (RenderTask::needsCommandUpdate())
 			return true;
 
+		//Noise is only recorded for the frame after it changed
+
+		if (noiseDirty || noiseRecorded || cachedShadowEnabled != shadowProperties->Enabled)
+			return true;
+
 		for (RenderTask *task : tasks)
 			if (task->needsCommandUpdate())
 				return true;
@@ -119,10 +144,16 @@ namespace igx::rt {
 		RenderTask::resize(size);
 		tasks.resize(size);
 
-		cloudDescriptors->updateDescriptor(2, GPUSubresource(linearSampler, primaries->getTexture(), TextureType::TEXTURE_2D));
+		cloudDescriptors->updateDescriptor(2, GPUSubresource(nearestSampler, primaries->getTexture(), TextureType::TEXTURE_2D));
 		cloudDescriptors->flush({ { 2, 1 } });
 	}
 
+	void CloudTask::setTraversalStats(const GPUBufferRef &totals, const GPUBufferRef &pixels) {
+		cloudDescriptors->updateDescriptor(6, GPUSubresource(totals, GPUBufferType::STRUCTURED));
+		cloudDescriptors->updateDescriptor(7, GPUSubresource(pixels, GPUBufferType::STRUCTURED));
+		cloudDescriptors->flush({ { 6, 2 } });
+	}
+
 	void CloudTask::switchToScene(SceneGraph *sceneGraph) {
 
 		tasks.switchToScene(sceneGraph);
@@ -135,16 +166,22 @@ namespace igx::rt {
 		cloudDescriptors->flush({ { 4, 1 } });
 	}
 
-	void CloudTask::prepareCommandList(CommandList * /*cl*/) {
+	void CloudTask::prepareCommandList(CommandList *cl) {
 
-		/* TODO: Make Clouds more efficient
+		if ((noiseRecorded = noiseDirty)) {
 
-		cl->add(
-			FlushBuffer(uniformBuffer, factory.getDefaultUploadBuffer()),
-			FlushBuffer(noiseUniformData, factory.getDefaultUploadBuffer())
-		);
+			for (CloudNoiseTask *noise : noiseTasks)
+				noise->prepareCommandList(cl);
+
+			noiseDirty = false;
+		}
+
+		if ((cachedShadowEnabled = shadowProperties->Enabled))
+			subtasks[1]->prepareCommandList(cl);
 
-		tasks.prepareCommandList(cl); */
+		/* TODO: Make Clouds more efficient
+
+		subtasks[0]->prepareCommandList(cl); */
 	}
 
 	void CloudTask::update(f64 dt) {
@@ -154,15 +191,65 @@ namespace igx::rt {
 		cloudBuffer->Offset_x += f32(dt * cloudBuffer->Wind_direction_x * cloudBuffer->Wind_speed);
 		cloudBuffer->Offset_z += f32(dt * cloudBuffer->Wind_direction_z * cloudBuffer->Wind_speed);
 
-		std::memcpy(uniformBuffer->getBuffer(), &cloudBuffer.value, sizeof(CloudBuffer));
-		uniformBuffer->flush(0, sizeof(CloudBuffer));
+		//Anything other than what was applied last is a change from the UI
+
+		if (cloudBuffer->Samples != appliedSamples)
+			requestedSamples = cloudBuffer->Samples;
+
+		if (cloudBuffer->Light_samples != appliedLightSamples)
+			requestedLightSamples = cloudBuffer->Light_samples;
+
+		cloudBuffer->Samples = appliedSamples = budgetSamples(requestedSamples, sampleBudget);
+		cloudBuffer->Light_samples = appliedLightSamples = budgetSamples(requestedLightSamples, sampleBudget);
+
+		if (std::memcmp(&cachedNoise, &noiseUniforms.value, sizeof(NoiseUniformData))) {
+			cachedNoise = noiseUniforms.value;
+			noiseDirty = true;
+		}
+
+		//Cloud shadows; only refreshed every Update_interval frames
+
+		const CloudShadowProperties &shadow = shadowProperties.value;
 
-		std::memcpy(noiseUniformData->getBuffer(), &noiseUniforms.value, sizeof(NoiseUniformData));
-		noiseUniformData->flush(0, sizeof(NoiseUniformData));
+		if (shadow.Resolution != cachedShadowRes) {
+			subtasks[1]->setShadowResolution(cachedShadowRes = shadow.Resolution);
+			cachedShadowClouds = {};
+			markNeedCmdUpdate();
+		}
+
+		if (!shadow.Enabled)
+			cachedShadowClouds = {};
+
+		cloudBuffer->shadowOrigin = Vec2f32(shadow.Center_x, shadow.Center_z);
+		cloudBuffer->shadowExtent = shadow.Extent;
+		cloudBuffer->updateShadow = false;
+
+		//Only re-render the shadow map if the clouds changed; so a still view keeps the same uniforms
+
+		if (shadow.Enabled && !shadowFrame && std::memcmp(&cachedShadowClouds, &cloudBuffer.value, sizeof(CPUCloudBuffer))) {
+			cachedShadowClouds = cloudBuffer.value;
+			cloudBuffer->updateShadow = true;
+		}
+
+		shadowFrame = (shadowFrame + 1) % shadow.Update_interval;
 	}
 
-	Texture *CloudTask::getOutput(bool) const {
-		return subtasks[0]->getTexture();
+	Texture *CloudTask::getOutput(bool isShadow) const {
+		return subtasks[isShadow]->getTexture();
+	}
+
+	CloudShadowMapping CloudTask::getShadowMapping() const {
+
+		const CloudShadowProperties &shadow = shadowProperties.value;
+
+		if (!shadow.Enabled)
+			return {};
+
+		return {
+			Vec2f32(shadow.Center_x, shadow.Center_z),
+			shadow.Extent,
+			std::min(cloudBuffer.value.Height_a, cloudBuffer.value.Height_b)
+		};
 	}
 
 }
\ No newline at end of file
@@ -7,24 +7,33 @@
 #include "rt/structs.hpp"
 #include "helpers/scene_graph.hpp"
 #include "igxi/convert.hpp"
+#include "system/system.hpp"
+#include "system/local_file_system.hpp"
+#include "system/log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include "../res/shaders/defines.glsl"
 
 namespace igx::rt {
 
-	CompositeTask::CompositeTask(const GPUBufferRef &cameraBuffer, FactoryContainer &factory, ui::GUI &gui) :
+	CompositeTask::CompositeTask(
+		UniformManager &uniforms, u32 cameraUniform, u32 previousCameraUniform, 
+		FactoryContainer &factory, ui::GUI &gui
+	) :
 
 		ParentTextureRenderTask(
 			factory.getGraphics(), 
 			NAME("Composite task"),
 			Vec4f32(0, 0, 1, 1),
-			{ NAME("Main task"), NAME("Accumulation buffer") },
-			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba8, GPUMemoryUsage::GPU_WRITE_ONLY),
-			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY)
+			{ NAME("Main task") },
+			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba8, GPUMemoryUsage::GPU_WRITE_ONLY)
 		),
 
-		cameraRef(cameraBuffer),
+		gui(gui),
 		factory(factory),
-		gui(gui)
+		uniforms(uniforms)
 	{
 		//Setting up important shared resources
 
@@ -44,12 +53,20 @@ namespace igx::rt {
 			g, NAME("Camera descriptor"),
 			Descriptors::Info(
 				layout, 0,
-				{ { 0, GPUSubresource(cameraBuffer, GPUBufferType::UNIFORM) } }
+				{ { 0, uniforms.getSubresource(cameraUniform) } }
 			)
 		};
 
 		seed = (Seed*) seedBuffer->getBuffer();
+		seed->sampleCount = 0;
 		seed->sampleOffset = 0;
+		seed->adaptiveError = 0;
+		seed->adaptiveMinSamples = 0;
+		seed->compactAccumulation = 0;
+		seed->hdrOutput = 0;
+		seed->sampleStart = 0;
+		seed->isUpscaled = 0;
+		seed->isFrozen = 0;
 
 		//Create descriptors and post processing shader
 
@@ -66,17 +83,27 @@ namespace igx::rt {
 		));
 
 		raytracingLayout.push_back(RegisterLayout(
-			NAME("dirT"), 12, SamplerType::SAMPLER_2D, 2, 2,
+			NAME("gBuffer"), 12, SamplerType::SAMPLER_2D, 2, 2,
 			ShaderAccess::COMPUTE
 		));
 
 		raytracingLayout.push_back(RegisterLayout(
-			NAME("uvObjectNormal"), 13, SamplerType::SAMPLER_2D, 3, 2,
-			ShaderAccess::COMPUTE
+			NAME("accumulation"), 14, TextureType::TEXTURE_2D, 1, 2,
+			ShaderAccess::COMPUTE, GPUFormat::rgba32f, true
 		));
 
 		raytracingLayout.push_back(RegisterLayout(
-			NAME("accumulation"), 14, TextureType::TEXTURE_2D, 1, 2,
+			NAME("accumulationMean"), 20, TextureType::TEXTURE_2D, 2, 2,
+			ShaderAccess::COMPUTE, GPUFormat::rgba16f, true
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("accumulationResidual"), 21, TextureType::TEXTURE_2D, 3, 2,
+			ShaderAccess::COMPUTE, GPUFormat::rgba8, true
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("hdrOutput"), 23, TextureType::TEXTURE_2D, 4, 2,
 			ShaderAccess::COMPUTE, GPUFormat::rgba32f, true
 		));
 
@@ -93,22 +120,42 @@ namespace igx::rt {
 			ShaderAccess::COMPUTE, sizeof(Seed)
 		));
 
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("Tiles"), 19, GPUBufferType::STRUCTURED, 8, 2,
+			ShaderAccess::COMPUTE, sizeof(TileInfo), true
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("SkyLighting"), 22, GPUBufferType::STRUCTURED, 11, 2,
+			ShaderAccess::COMPUTE, sizeof(u16) * 4
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("blueNoise"), 25, SamplerType::SAMPLER_2D, 3, 2, ShaderAccess::COMPUTE
+		));
+
 		#ifndef NDEBUG
 
-			debugBuffer = {
-				g, NAME("Debug buffer"),
+			u32 debugUniform = uniforms.add(&debData.value);
+
+			raytracingLayout.push_back(RegisterLayout(
+				NAME("DebugInfo"), 18, GPUBufferType::UNIFORM, 3, 2,
+				ShaderAccess::COMPUTE, sizeof(DebugData)
+			));
+
+			traversalTotals = {
+				g, NAME("Traversal totals"),
 				GPUBuffer::Info(
-					sizeof(DebugData), GPUBufferUsage::UNIFORM,
-					GPUMemoryUsage::CPU_WRITE
+					sizeof(TraversalCounters), GPUBufferUsage::STORAGE, GPUMemoryUsage::CPU_WRITE | GPUMemoryUsage::GPU_WRITE
 				)
 			};
 
-			debData = (DebugData*) debugBuffer->getBuffer();
-			::new(debData) DebugData();
+			*(TraversalCounters*) traversalTotals->getBuffer() = {};
+			traversalTotals->flush(0, sizeof(TraversalCounters));
 
 			raytracingLayout.push_back(RegisterLayout(
-				NAME("DebugInfo"), 18, GPUBufferType::UNIFORM, 3, 2,
-				ShaderAccess::COMPUTE, sizeof(DebugData)
+				NAME("TraversalPixels"), 24, GPUBufferType::STRUCTURED, 13, 2,
+				ShaderAccess::COMPUTE, sizeof(u32), true
 			));
 
 			gui.addWindow(
@@ -129,6 +176,17 @@ namespace igx::rt {
 			)
 		);
 
+		//Rotates every pixel's sample sequence (see sampler.glsl); loaded through igxi like the scene's skybox
+
+		igxi::IGXI blueNoiseImage{};
+
+		if (igxi::Helper::loadDiskExternal(blueNoiseImage, VIRTUAL_FILE("textures/blue_noise_rg.png")) != igxi::Helper::ErrorMessage::SUCCESS)
+			oic::System::log()->fatal("Couldn't load the blue noise texture");
+
+		blueNoise = { g, NAME("Blue noise"), igxi::Helper::convert(blueNoiseImage) };
+
+		const GPUSubresource blueNoiseSampler(nearestSampler, blueNoise, TextureType::TEXTURE_2D);
+
 		//Set up composite shader
 
 		shaderLayout = factory.get(
@@ -141,15 +199,18 @@ namespace igx::rt {
 			Descriptors::Info(shaderLayout, 2, {
 
 				{ 10, GPUSubresource(nearestSampler, gui.getFramebuffer()->getTarget(0), TextureType::TEXTURE_MS) },
-				{ 17, GPUSubresource(seedBuffer, GPUBufferType::UNIFORM) }
+				{ 17, GPUSubresource(seedBuffer, GPUBufferType::UNIFORM) },
+				{ 25, blueNoiseSampler }
 
 				#ifndef NDEBUG
-				, { 18, GPUSubresource(debugBuffer, GPUBufferType::UNIFORM) }
+				, { 18, uniforms.getSubresource(debugUniform) }
 				#endif
 
 			})
 		};
 
+		uploadSkyLighting();
+
 		shader = factory.get(
 			NAME("Composite shader"),
 			Pipeline::Info(
@@ -189,15 +250,85 @@ namespace igx::rt {
 			)
 		);
 
+		//Set up upscale shader; only used when rendering below the output size
+		//The input is sampled at clamped coordinates, so the border doesn't bleed in
+
+		linearSampler = factory.get(
+			NAME("Linear clamp sampler"),
+			Sampler::Info(
+				SamplerMin::LINEAR, SamplerMag::LINEAR, SamplerMode::CLAMP_BORDER, 1
+			)
+		);
+
+		List<RegisterLayout> upscaleLayout = {
+			RegisterLayout(NAME("CameraData"),	0, GPUBufferType::UNIFORM,		0, 0, ShaderAccess::COMPUTE, sizeof(Camera)),
+			RegisterLayout(NAME("upscaled"),	1, TextureType::TEXTURE_2D,		0, 0, ShaderAccess::COMPUTE, GPUFormat::rgba8, true),
+			RegisterLayout(NAME("rendered"),	2, SamplerType::SAMPLER_2D,		0, 0, ShaderAccess::COMPUTE),
+			RegisterLayout(NAME("UI"),			3, SamplerType::SAMPLER_MS,		1, 0, ShaderAccess::COMPUTE)
+		};
+
+		upscaleShaderLayout = factory.get(
+			NAME("Upscale shader layout"),
+			PipelineLayout::Info(upscaleLayout)
+		);
+
+		upscaleDescriptors = {
+			g, NAME("Upscale descriptors"),
+			Descriptors::Info(upscaleShaderLayout, 0, {
+				{ 0, uniforms.getSubresource(cameraUniform) },
+				{ 3, GPUSubresource(nearestSampler, gui.getFramebuffer()->getTarget(0), TextureType::TEXTURE_MS) }
+			})
+		};
+
+		upscaleShader = factory.get(
+			NAME("Upscale shader"),
+			Pipeline::Info(
+				Pipeline::Flag::NONE,
+				VIRTUAL_FILE("shaders/upscale.comp.spv"),
+				{},
+				upscaleShaderLayout,
+				Vec3u32(THREADS_XY, THREADS_XY, 1)
+			)
+		);
+
+		//Set up the export error reduction; one texel per tile of the output
+
+		List<RegisterLayout> errorLayout = {
+			RegisterLayout(NAME("errorTiles"),	0, TextureType::TEXTURE_2D,		0, 0, ShaderAccess::COMPUTE, GPUFormat::r32f, true),
+			RegisterLayout(NAME("rayOutput"),	1, SamplerType::SAMPLER_2D,		0, 0, ShaderAccess::COMPUTE)
+		};
+
+		errorShaderLayout = factory.get(
+			NAME("Export error shader layout"),
+			PipelineLayout::Info(errorLayout)
+		);
+
+		errorDescriptors = {
+			g, NAME("Export error descriptors"),
+			Descriptors::Info(errorShaderLayout, 0, {})
+		};
+
+		errorShader = factory.get(
+			NAME("Export error shader"),
+			Pipeline::Info(
+				Pipeline::Flag::NONE,
+				VIRTUAL_FILE("shaders/export_error.comp.spv"),
+				{},
+				errorShaderLayout,
+				Vec3u32(THREADS_XY, THREADS_XY, 1)
+			)
+		);
+
 		//Subtasks
 
-		auto raygen = new RaygenTask(factory, seedBuffer, cameraDescriptor);
+		auto raygen = new RaygenTask(factory, seedBuffer, cameraDescriptor, blueNoiseSampler);
+		auto clouds = new CloudTask(raygen, factory, gui, uniforms, cameraDescriptor);
 
 		tasks.add(
 
 			raygen,
-			new CloudTask(raygen, factory, gui, cameraDescriptor),
-			new ShadowTask(factory, raygen, seedBuffer, cameraDescriptor)
+			clouds,
+			new ShadowTask(factory, uniforms, previousCameraUniform, raygen, clouds, seedBuffer, cameraDescriptor, blueNoiseSampler)
 			
 			/*,new LightCullingTask(raygen, factory, cameraDescriptor)*/
 		);
@@ -205,7 +336,12 @@ namespace igx::rt {
 
 	CompositeTask::~CompositeTask() { }
 
-	void CompositeTask::resize(const Vec2u32 &size) {
+	void CompositeTask::resize(const Vec2u32 &target) {
+
+		//Everything but the upscaled output is at render size
+
+		const Vec2u32 size = getRenderSize(target);
+		outputSize = target;
 
 		ParentTextureRenderTask::resize(size);
 
@@ -214,12 +350,289 @@ namespace igx::rt {
 		auto shadow = tasks.get<ShadowTask>(2);
 
 		descriptors->updateDescriptor(11, GPUSubresource(getTexture(0), TextureType::TEXTURE_2D));
-		descriptors->updateDescriptor(12, GPUSubresource(nearestSampler, raygen->getTexture(0), TextureType::TEXTURE_2D));
-		descriptors->updateDescriptor(13, GPUSubresource(nearestSampler, raygen->getTexture(1), TextureType::TEXTURE_2D));
-		descriptors->updateDescriptor(14, GPUSubresource(getTexture(1), TextureType::TEXTURE_2D));
+		descriptors->updateDescriptor(12, GPUSubresource(nearestSampler, raygen->getTexture(), TextureType::TEXTURE_2D));
 		descriptors->updateDescriptor(15, GPUSubresource(nearestSampler, cloud->getOutput(), TextureType::TEXTURE_2D));
 		descriptors->updateDescriptor(16, GPUSubresource(nearestSampler, shadow->getTexture(), TextureType::TEXTURE_2D));
-		descriptors->flush({ { 11, 6 } });
+		descriptors->flush({ { 11, 2 }, { 15, 2 } });
+
+		//Accumulation; the targets of the mode that isn't used are kept at 1x1 (see accumulation.glsl)
+
+		const bool compact = seed->compactAccumulation != 0;
+		const Vec2u16 full = size.cast<Vec2u16>(), none = Vec2u16(1, 1);
+
+		accumulation.release();
+		accumulationMean.release();
+		accumulationResidual.release();
+		hdrOutput.release();
+
+		accumulation = {
+			g, NAME("Accumulation buffer"),
+			Texture::Info(compact ? none : full, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		};
+
+		accumulationMean = {
+			g, NAME("Accumulation mean"),
+			Texture::Info(compact ? full : none, GPUFormat::rgba16f, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		};
+
+		accumulationResidual = {
+			g, NAME("Accumulation residual"),
+			Texture::Info(compact ? full : none, GPUFormat::rgba8, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		};
+
+		hdrOutput = {
+			g, NAME("HDR output"),
+			Texture::Info(seed->hdrOutput ? full : none, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		};
+
+		descriptors->updateDescriptor(14, GPUSubresource(accumulation, TextureType::TEXTURE_2D));
+		descriptors->updateDescriptor(20, GPUSubresource(accumulationMean, TextureType::TEXTURE_2D));
+		descriptors->updateDescriptor(21, GPUSubresource(accumulationResidual, TextureType::TEXTURE_2D));
+		descriptors->updateDescriptor(23, GPUSubresource(hdrOutput, TextureType::TEXTURE_2D));
+		descriptors->flush({ { 14, 1 }, { 20, 2 }, { 23, 1 } });
+
+		//Adaptive sampling state; one per work group
+
+		auto tileCount = (size.cast<Vec2f32>() / Vec2f32(THREADS_XY, THREADS_XY)).ceil().cast<Vec2u32>().prod<usz>();
+
+		tiles.release();
+		tiles = {
+			g, NAME("Adaptive tiles"),
+			GPUBuffer::Info(sizeof(TileInfo) * tileCount, GPUBufferUsage::STORAGE, GPUMemoryUsage::GPU_WRITE_ONLY)
+		};
+
+		raygen->setTiles(tiles);
+		shadow->setTiles(tiles);
+
+		descriptors->updateDescriptor(19, GPUSubresource(tiles, GPUBufferType::STRUCTURED));
+		descriptors->flush({ { 19, 1 } });
+
+		//Traversal counts per pixel; tests, nodes, shadow rays and density taps
+
+		#ifndef NDEBUG
+
+			traversalPixels.release();
+			traversalPixels = {
+				g, NAME("Traversal pixels"),
+				GPUBuffer::Info(
+					GPUBufferUsage::STORAGE, GPUMemoryUsage::GPU_WRITE_ONLY, 
+					Buffer(usz(size.x) * size.y * sizeof(u32) * 4)
+				)
+			};
+
+			raygen->setTraversalStats(traversalTotals, traversalPixels);
+			cloud->setTraversalStats(traversalTotals, traversalPixels);
+			shadow->setTraversalStats(traversalTotals, traversalPixels);
+
+			descriptors->updateDescriptor(24, GPUSubresource(traversalPixels, GPUBufferType::STRUCTURED));
+			descriptors->flush({ { 24, 1 } });
+
+		#endif
+
+		//Export error per tile
+
+		const Vec2u16 errorRes = (size.cast<Vec2f32>() / Vec2f32(THREADS_XY, THREADS_XY)).ceil().cast<Vec2u16>();
+
+		errorTiles.release();
+		errorTiles = {
+			g, NAME("Export error tiles"),
+			Texture::Info(errorRes, GPUFormat::r32f, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		};
+
+		errorDescriptors->updateDescriptor(0, GPUSubresource(errorTiles, TextureType::TEXTURE_2D));
+		errorDescriptors->updateDescriptor(1, GPUSubresource(nearestSampler, getTexture(0), TextureType::TEXTURE_2D));
+		errorDescriptors->flush({ { 0, 2 } });
+
+		//Upscaled output; only allocated if the render size is lower or it's previewed
+
+		if (previewSize.x)
+			resizeUpscaled(previewSize);
+
+		else resizeUpscaled(size.x != target.x || size.y != target.y ? target : Vec2u32());
+	}
+
+	void CompositeTask::resizeUpscaled(const Vec2u32 &size) {
+
+		seed->isUpscaled = size.x != 0;
+		seedBuffer->flush(offsetof(Seed, isUpscaled), sizeof(u32));
+
+		upscaled.release();
+
+		if (!seed->isUpscaled)
+			return;
+
+		upscaled = {
+			g, NAME("Upscaled output"),
+			Texture::Info(size.cast<Vec2u16>(), GPUFormat::rgba8, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		};
+
+		upscaleDescriptors->updateDescriptor(1, GPUSubresource(upscaled, TextureType::TEXTURE_2D));
+		upscaleDescriptors->updateDescriptor(2, GPUSubresource(linearSampler, getTexture(0), TextureType::TEXTURE_2D));
+		upscaleDescriptors->flush({ { 1, 2 } });
+	}
+
+	//Large exports are scaled down bilinearly, so the preview aliases; it's only there to see progress
+
+	void CompositeTask::setPreview(const Vec2u32 &size) {
+
+		previewSize = size;
+
+		if (size.x)
+			resizeUpscaled(size);
+
+		markNeedCmdUpdate();
+	}
+
+	void CompositeTask::setRenderScale(f32 scale) {
+		renderScale = std::clamp(scale, 0.25f, 1.f);
+	}
+
+	Vec2u32 CompositeTask::getRenderSize(const Vec2u32 &target) const {
+
+		if (renderScale >= 1)
+			return target;
+
+		return Vec2u32(
+			std::max(u32(f32(target.x) * renderScale + 0.5f), 1u),
+			std::max(u32(f32(target.y) * renderScale + 0.5f), 1u)
+		);
+	}
+
+	void CompositeTask::setSampleBudget(f32 shadowSamples, f32 cloudSamples) {
+		tasks.get<ShadowTask>(2)->setSampleBudget(shadowSamples);
+		tasks.get<CloudTask>(1)->setSampleBudget(cloudSamples);
+	}
+
+	void CompositeTask::setShadowSamples(u32 samples, bool denoise) {
+		tasks.get<ShadowTask>(2)->setSamples(samples, denoise);
+	}
+
+	bool CompositeTask::setDenoiseBypass(bool bypass) {
+		return tasks.get<ShadowTask>(2)->setDenoiseBypass(bypass);
+	}
+
+	void CompositeTask::setAdaptiveSampling(f32 maxError, u32 minSamples) {
+
+		seed->adaptiveError = maxError;
+		seed->adaptiveMinSamples = minSamples;
+
+		seedBuffer->flush(offsetof(Seed, adaptiveError), sizeof(f32) + sizeof(u32));
+	}
+
+	void CompositeTask::setCompactAccumulation(bool compact) {
+		seed->compactAccumulation = compact;
+		seedBuffer->flush(offsetof(Seed, compactAccumulation), sizeof(u32));
+	}
+
+	void CompositeTask::setHdrOutput(bool enabled) {
+		seed->hdrOutput = enabled;
+		seedBuffer->flush(offsetof(Seed, hdrOutput), sizeof(u32));
+	}
+
+	void CompositeTask::setFrozen(bool frozen) {
+		seed->isFrozen = frozen;
+		seedBuffer->flush(offsetof(Seed, isFrozen), sizeof(u32));
+	}
+
+	bool CompositeTask::readTraversalStats(TraversalCounters &counters) {
+
+		#ifdef NDEBUG
+
+			counters = {};
+			return false;
+
+		#else
+
+			//Frames in flight can land on either side of the reset; fine for rates over a second
+
+			TraversalCounters *totals = (TraversalCounters*) traversalTotals->getBuffer();
+
+			counters = *totals;
+			*totals = {};
+
+			traversalTotals->flush(0, sizeof(TraversalCounters));
+			return true;
+
+		#endif
+	}
+
+	void CompositeTask::setEnvironmentMap(const List<f32> &rgb, u32 width, u32 height, const String &cacheDirectory) {
+
+		auto build = [rgb, width, height, cacheDirectory]() {
+
+			PendingEnvironment result;
+			result.environment.build(rgb, width, height);
+
+			//Prefiltering takes seconds, so it's only done once per sky
+
+			const u64 hash = SkyLighting::hash((const u8*) rgb.data(), rgb.size() * sizeof(f32));
+
+			c8 name[32];
+			std::snprintf(name, sizeof(name), "/%016llx.ibl", (unsigned long long) hash);
+
+			const String cache = cacheDirectory + name;
+
+			if (!result.skyLighting.load(cache, hash)) {
+
+				result.skyLighting.build(rgb, width, height);
+
+				if (!result.skyLighting.save(cache, hash))
+					oic::System::log()->warn("Couldn't cache sky lighting to " + cache);
+			}
+
+			return result;
+		};
+
+		if (pendingEnvironment.valid())
+			queuedEnvironment = build;
+
+		else pendingEnvironment = std::async(std::launch::async, build);
+	}
+
+	void CompositeTask::applyEnvironmentMap() {
+
+		if (!pendingEnvironment.valid() || pendingEnvironment.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+
+		PendingEnvironment result = pendingEnvironment.get();
+
+		if (queuedEnvironment) {
+			pendingEnvironment = std::async(std::launch::async, std::move(queuedEnvironment));
+			queuedEnvironment = {};
+		}
+
+		auto shadow = tasks.get<ShadowTask>(2);
+		shadow->setEnvironmentMap(std::move(result.environment));
+
+		skyLighting = std::move(result.skyLighting);
+		cachedSkySampled = shadow->isSkySampled();
+		uploadSkyLighting();
+	}
+
+	//Header + prefiltered mips; the buffer is only recreated when the size changes
+
+	void CompositeTask::uploadSkyLighting() {
+
+		const List<u8> data = skyLighting.getGPUData(!cachedSkySampled);
+
+		if (!skyLightingBuffer.exists() || skyLightingBuffer->size() != data.size()) {
+
+			skyLightingBuffer.release();
+			skyLightingBuffer = {
+				g, NAME("Sky lighting"),
+				GPUBuffer::Info(
+					data.size(), GPUBufferUsage::STORAGE, GPUMemoryUsage::CPU_WRITE | GPUMemoryUsage::GPU_WRITE
+				)
+			};
+
+			descriptors->updateDescriptor(22, GPUSubresource(skyLightingBuffer, GPUBufferType::STRUCTURED));
+			descriptors->flush({ { 22, 1 } });
+		}
+
+		std::memcpy(skyLightingBuffer->getBuffer(), data.data(), data.size());
+		skyLightingBuffer->flush(0, data.size());
+
+		markNeedCmdUpdate();
 	}
 
 	void CompositeTask::switchToScene(SceneGraph *_sceneGraph) {
@@ -236,36 +649,77 @@ namespace igx::rt {
 
 		ParentTextureRenderTask::update(dt);
 
-		seed->sampleCount = 0;
+		//Sample count is owned by the GPU (init.comp) unless accumulation is reset
+
 		seed->cpuOffsetX = r.range(-1000.f, 1000.f);
 		seed->cpuOffsetY = r.range(-1000.f, 1000.f);
 
-		seedBuffer->flush(0, offsetof(Seed, sampleOffset));
+		seedBuffer->flush(offsetof(Seed, cpuOffsetX), sizeof(f32) * 2);
+
+		applyEnvironmentMap();
+
+		//Irradiance would count the sky twice if it's also sampled as a light
+
+		const bool skySampled = tasks.get<ShadowTask>(2)->isSkySampled();
+
+		if (cachedSkySampled != skySampled) {
+
+			cachedSkySampled = skySampled;
+
+			const u32 useIrradiance = !skySampled && !skyLighting.empty();
+			std::memcpy(skyLightingBuffer->getBuffer() + offsetof(SkyLightingHeader, useIrradiance), &useIrradiance, sizeof(u32));
+			skyLightingBuffer->flush(offsetof(SkyLightingHeader, useIrradiance), sizeof(u32));
+		}
+	}
+
+	void CompositeTask::resetAccumulation() {
+		seed->sampleCount = 0;
+		seedBuffer->flush(offsetof(Seed, sampleCount), sizeof(u32));
+	}
+
+	//The scramble is hashed from sampleOffset - sampleCount (see sampler.glsl), so both restart at 0
+
+	void CompositeTask::setSampleRange(u32 start) {
+
+		seed->sampleCount = seed->sampleOffset = 0;
+		seed->sampleStart = start;
+
+		seedBuffer->flush(offsetof(Seed, sampleCount), sizeof(u32) * 2);
+		seedBuffer->flush(offsetof(Seed, sampleStart), sizeof(u32));
+	}
 
-		if(debugBuffer)
-			debugBuffer->flush(0, sizeof(DebugData));
+	bool CompositeTask::needsCompositeUpdate() const {
+		return RenderTask::needsCommandUpdate();
 	}
 
 	void CompositeTask::prepareCommandList(CommandList *cl) {
 
+		prepareInitCommands(cl);
+
+		//All sub tasks
+
+		ParentTextureRenderTask::prepareCommandList(cl);
+
+		prepareCompositeCommands(cl);
+	}
+
+	void CompositeTask::prepareInitCommands(CommandList *cl) {
+
 		//Setup all GPU data
 
 		cl->add(
-			FlushBuffer(seedBuffer, factory.getDefaultUploadBuffer())
+			FlushBuffer(seedBuffer, factory.getDefaultUploadBuffer()),
+			FlushBuffer(skyLightingBuffer, factory.getDefaultUploadBuffer())
 		);
-
-		if(debugBuffer)
-			cl->add(FlushBuffer(debugBuffer, factory.getDefaultUploadBuffer()));
 		
 		cl->add(
 			BindDescriptors(initDescriptors),
 			BindPipeline(initShader),
 			Dispatch(1)
 		);
+	}
 
-		//All sub tasks
-
-		ParentTextureRenderTask::prepareCommandList(cl);
+	void CompositeTask::prepareCompositeCommands(CommandList *cl) {
 
 		//Composite render task
 
@@ -274,6 +728,29 @@ namespace igx::rt {
 			BindPipeline(shader),
 			Dispatch(size())
 		);
+
+		if (seed->isUpscaled && !previewSize.x)
+			cl->add(
+				BindDescriptors(upscaleDescriptors),
+				BindPipeline(upscaleShader),
+				Dispatch(outputSize)
+			);
+	}
+
+	void CompositeTask::preparePreviewCommands(CommandList *cl) {
+		cl->add(
+			BindDescriptors(upscaleDescriptors),
+			BindPipeline(upscaleShader),
+			Dispatch(previewSize)
+		);
+	}
+
+	void CompositeTask::prepareErrorCommands(CommandList *cl) {
+		cl->add(
+			BindDescriptors(errorDescriptors),
+			BindPipeline(errorShader),
+			Dispatch(size())
+		);
 	}
 
 }
\ No newline at end of file
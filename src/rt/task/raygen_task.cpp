@@ -9,15 +9,15 @@ namespace igx::rt {
 	RaygenTask::RaygenTask(
 		FactoryContainer &factory,
 		const GPUBufferRef &seedBuffer,
-		const DescriptorsRef &cameraDescriptor
+		const DescriptorsRef &cameraDescriptor,
+		const GPUSubresource &blueNoise
 	) :
 		TextureRenderTask(
 			factory.getGraphics(),
 			NAME("Raygen task"),
 			Vec4f32(0, 0.25, 1, 1),
-			{ NAME("dirT"), NAME("uvObjectNormal") },
-			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY), 
-			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY)
+			{ NAME("gBuffer") },
+			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba32u, GPUMemoryUsage::GPU_WRITE_ONLY)
 		),
 
 		factory(factory),
@@ -28,14 +28,11 @@ namespace igx::rt {
 
 		auto raytracingLayout = SceneGraph::getLayout();
 
-		raytracingLayout.push_back(RegisterLayout(
-			NAME("DirT buffer"), 10, TextureType::TEXTURE_2D, 0, 2,
-			ShaderAccess::COMPUTE, GPUFormat::rgba32f, true
-		));
+		//Packed G-buffer (see gbuffer.glsl)
 
 		raytracingLayout.push_back(RegisterLayout(
-			NAME("UvObjectNormal buffer"), 11, TextureType::TEXTURE_2D, 1, 2,
-			ShaderAccess::COMPUTE, GPUFormat::rgba32f, true
+			NAME("GBuffer"), 10, TextureType::TEXTURE_2D, 0, 2,
+			ShaderAccess::COMPUTE, GPUFormat::rgba32u, true
 		));
 
 		raytracingLayout.push_back(RegisterLayout(
@@ -43,6 +40,32 @@ namespace igx::rt {
 			ShaderAccess::COMPUTE, sizeof(Seed)
 		));
 
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("Tiles"), 13, GPUBufferType::STRUCTURED, 8, 2,
+			ShaderAccess::COMPUTE, sizeof(TileInfo), true
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("blueNoise"), 16, SamplerType::SAMPLER_2D, 1, 2,
+			ShaderAccess::COMPUTE
+		));
+
+		//Traversal statistics; only counted by debug shaders (see stats.glsl)
+
+		#ifndef NDEBUG
+
+			raytracingLayout.push_back(RegisterLayout(
+				NAME("TraversalTotals"), 14, GPUBufferType::STRUCTURED, 12, 2,
+				ShaderAccess::COMPUTE, sizeof(u64), true
+			));
+
+			raytracingLayout.push_back(RegisterLayout(
+				NAME("TraversalPixels"), 15, GPUBufferType::STRUCTURED, 13, 2,
+				ShaderAccess::COMPUTE, sizeof(u32), true
+			));
+
+		#endif
+
 		shaderLayout = factory.get(
 			NAME("Raygen shader layout"),
 			PipelineLayout::Info(raytracingLayout)
@@ -52,7 +75,8 @@ namespace igx::rt {
 			g, NAME("Raygen task descriptors"),
 			Descriptors::Info(
 				shaderLayout, 2, {
-					{ 12, GPUSubresource(seedBuffer, GPUBufferType::UNIFORM) }
+					{ 12, GPUSubresource(seedBuffer, GPUBufferType::UNIFORM) },
+					{ 16, blueNoise }
 				}
 			)
 		};
@@ -73,9 +97,19 @@ namespace igx::rt {
 
 		TextureRenderTask::resize(size);
 
-		descriptors->updateDescriptor(10, GPUSubresource(getTexture(0), TextureType::TEXTURE_2D));
-		descriptors->updateDescriptor(11, GPUSubresource(getTexture(1), TextureType::TEXTURE_2D));
-		descriptors->flush({ { 10, 2 } });
+		descriptors->updateDescriptor(10, GPUSubresource(getTexture(), TextureType::TEXTURE_2D));
+		descriptors->flush({ { 10, 1 } });
+	}
+
+	void RaygenTask::setTiles(const GPUBufferRef &tiles) {
+		descriptors->updateDescriptor(13, GPUSubresource(tiles, GPUBufferType::STRUCTURED));
+		descriptors->flush({ { 13, 1 } });
+	}
+
+	void RaygenTask::setTraversalStats(const GPUBufferRef &totals, const GPUBufferRef &pixels) {
+		descriptors->updateDescriptor(14, GPUSubresource(totals, GPUBufferType::STRUCTURED));
+		descriptors->updateDescriptor(15, GPUSubresource(pixels, GPUBufferType::STRUCTURED));
+		descriptors->flush({ { 14, 2 } });
 	}
 
 	void RaygenTask::switchToScene(SceneGraph *_sceneGraph) { 
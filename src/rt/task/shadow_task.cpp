@@ -1,38 +1,47 @@
 #include "rt/task/raygen_task.hpp"
 #include "rt/task/shadow_task.hpp"
+#include "rt/task/cloud/cloud_task.hpp"
 #include "rt/enums.hpp"
 #include "rt/structs.hpp"
+#include "rt/frame_governor.hpp"
 #include "helpers/scene_graph.hpp"
+#include <cstring>
 #include "../res/shaders/defines.glsl"
 
 namespace igx::rt {
 
 	ShadowTask::ShadowTask(
 		FactoryContainer &factory,
+		UniformManager &uniforms,
+		u32 previousCameraUniform,
 		RaygenTask *raygen,
+		CloudTask *clouds,
 		const GPUBufferRef &seed,
-		const DescriptorsRef &cameraDescriptor
+		const DescriptorsRef &cameraDescriptor,
+		const GPUSubresource &blueNoise
 	) :
 		TextureRenderTask(
 			factory.getGraphics(),
 			NAME("Shadow task"),
 			Vec4f32(0, 0, 0, 1),
-			{ NAME("Lighting"), NAME("History") },
+			{ NAME("Lighting"), NAME("History even"), NAME("Moments"), NAME("Filter"), NAME("Current moments"), NAME("History odd") },
 			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::outputFormat, GPUMemoryUsage::GPU_WRITE_ONLY), 
+			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::outputFormat, GPUMemoryUsage::GPU_WRITE_ONLY),
+			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY),
+			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::outputFormat, GPUMemoryUsage::GPU_WRITE_ONLY),
+			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::rgba32f, GPUMemoryUsage::GPU_WRITE_ONLY),
 			Texture::Info(TextureType::TEXTURE_2D, GPUFormat::outputFormat, GPUMemoryUsage::GPU_WRITE_ONLY)
 		),
 
 		factory(factory),
 		raygen(raygen),
+		clouds(clouds),
 		cameraDescriptor(cameraDescriptor),
 		seed(seed)
 	{
 		//Setup uniforms and samplers
 
-		shadowProperties = {
-			factory.getGraphics(), NAME("Shadow properties"),
-			GPUBuffer::Info(sizeof(ShadowProperties), GPUBufferUsage::UNIFORM, GPUMemoryUsage::CPU_WRITE)
-		};
+		propertiesUniform = uniforms.add(&properties.value);
 
 		nearestSampler = factory.get(
 			NAME("Nearest clamp sampler"),
@@ -67,13 +76,37 @@ namespace igx::rt {
 		));
 
 		raytracingLayout.push_back(RegisterLayout(
-			NAME("dirObject"), 14, SamplerType::SAMPLER_2D, 1, 2, ShaderAccess::COMPUTE
+			NAME("gBuffer"), 14, SamplerType::SAMPLER_2D, 1, 2, ShaderAccess::COMPUTE
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("Tiles"), 18, GPUBufferType::STRUCTURED, 8, 2, ShaderAccess::COMPUTE, sizeof(TileInfo)
 		));
 
 		raytracingLayout.push_back(RegisterLayout(
-			NAME("uvNormal"), 15, SamplerType::SAMPLER_2D, 2, 2, ShaderAccess::COMPUTE
+			NAME("LightTree"), 19, GPUBufferType::STRUCTURED, 9, 2, ShaderAccess::COMPUTE, sizeof(LightNode)
 		));
 
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("Environment"), 20, GPUBufferType::STRUCTURED, 10, 2, ShaderAccess::COMPUTE, sizeof(f32)
+		));
+
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("blueNoise"), 23, SamplerType::SAMPLER_2D, 2, 2, ShaderAccess::COMPUTE
+		));
+
+		#ifndef NDEBUG
+
+			raytracingLayout.push_back(RegisterLayout(
+				NAME("TraversalTotals"), 21, GPUBufferType::STRUCTURED, 12, 2, ShaderAccess::COMPUTE, sizeof(u64), true
+			));
+
+			raytracingLayout.push_back(RegisterLayout(
+				NAME("TraversalPixels"), 22, GPUBufferType::STRUCTURED, 13, 2, ShaderAccess::COMPUTE, sizeof(u32), true
+			));
+
+		#endif
+
 		//Setup shadow
 
 		shadowLayout = factory.get(
@@ -85,8 +118,9 @@ namespace igx::rt {
 			g, NAME("Shadow descriptors"),
 			Descriptors::Info(
 				shadowLayout, 2, {
-					{ 10, GPUSubresource(shadowProperties, GPUBufferType::UNIFORM) },
-					{ 11, GPUSubresource(seed, GPUBufferType::UNIFORM) }
+					{ 10, uniforms.getSubresource(propertiesUniform) },
+					{ 11, GPUSubresource(seed, GPUBufferType::UNIFORM) },
+					{ 23, blueNoise }
 				}
 			)
 		};
@@ -116,6 +150,10 @@ namespace igx::rt {
 			ShaderAccess::COMPUTE, GPUFormat::outputFormat, true
 		));
 
+		raytracingLayout.push_back(RegisterLayout(
+			NAME("cloudShadow"), 17, SamplerType::SAMPLER_2D, 3, 2, ShaderAccess::COMPUTE
+		));
+
 		lightingLayout = factory.get(
 			NAME("Lighting layout"),
 			PipelineLayout::Info(raytracingLayout)
@@ -125,8 +163,9 @@ namespace igx::rt {
 			g, NAME("Lighting descriptors"),
 			Descriptors::Info(
 				lightingLayout, 2, {
-					{ 10, GPUSubresource(shadowProperties, GPUBufferType::UNIFORM) },
-					{ 11, GPUSubresource(seed, GPUBufferType::UNIFORM) }
+					{ 10, uniforms.getSubresource(propertiesUniform) },
+					{ 11, GPUSubresource(seed, GPUBufferType::UNIFORM) },
+					{ 23, blueNoise }
 				}
 			)
 		};
@@ -141,6 +180,163 @@ namespace igx::rt {
 				Vec3u32(THREADS_XY, THREADS_XY, 1)
 			)
 		);
+
+		//Empty light tree until the scene's point lights are known
+
+		lightTreeBuffer = {
+			g, NAME("Light tree"),
+			GPUBuffer::Info(
+				sizeof(LightNode), GPUBufferUsage::STORAGE, GPUMemoryUsage::CPU_WRITE | GPUMemoryUsage::GPU_WRITE
+			)
+		};
+
+		cachedLightTreeNodes = 1;
+
+		shadowDescriptors->updateDescriptor(19, GPUSubresource(lightTreeBuffer, GPUBufferType::STRUCTURED));
+		shadowDescriptors->flush({ { 19, 1 } });
+
+		lightingDescriptors->updateDescriptor(19, GPUSubresource(lightTreeBuffer, GPUBufferType::STRUCTURED));
+		lightingDescriptors->flush({ { 19, 1 } });
+
+		uploadEnvironment();
+
+		//Denoiser; temporal accumulation into filter, then a-trous ping-pongs between filter and lighting
+		//History ping-pongs between frames (by seed.sampleOffset), so it's never sampled and written in the same set
+		//Temporal only samples it and a-trous only writes it; the rest of the layout is shared
+
+		auto denoiseRegisters = SceneGraph::getLayout();
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("ShadowProperties"), 10, GPUBufferType::UNIFORM, 2, 2, ShaderAccess::COMPUTE, sizeof(ShadowProperties)
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("DenoisePass"), 11, GPUBufferType::UNIFORM, 3, 2, ShaderAccess::COMPUTE, sizeof(DenoisePass)
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("gBuffer"), 12, SamplerType::SAMPLER_2D, 1, 2, ShaderAccess::COMPUTE
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("Seed"), 13, GPUBufferType::UNIFORM, 5, 2, ShaderAccess::COMPUTE, sizeof(Seed)
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("input"), 14, SamplerType::SAMPLER_2D, 3, 2, ShaderAccess::COMPUTE
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("filtered"), 16, TextureType::TEXTURE_2D, 0, 2, 
+			ShaderAccess::COMPUTE, GPUFormat::outputFormat, true
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("moments"), 17, TextureType::TEXTURE_2D, 1, 2, 
+			ShaderAccess::COMPUTE, GPUFormat::rgba32f, true
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("PreviousCamera"), 19, GPUBufferType::UNIFORM, 4, 2, ShaderAccess::COMPUTE, sizeof(PreviousCamera)
+		));
+
+		denoiseRegisters.push_back(RegisterLayout(
+			NAME("currentMoments"), 20, TextureType::TEXTURE_2D, 3, 2, 
+			ShaderAccess::COMPUTE, GPUFormat::rgba32f, true
+		));
+
+		auto temporalRegisters = denoiseRegisters;
+
+		temporalRegisters.push_back(RegisterLayout(
+			NAME("historyEven"), 15, SamplerType::SAMPLER_2D, 4, 2, ShaderAccess::COMPUTE
+		));
+
+		temporalRegisters.push_back(RegisterLayout(
+			NAME("historyOdd"), 21, SamplerType::SAMPLER_2D, 5, 2, ShaderAccess::COMPUTE
+		));
+
+		temporalRegisters.push_back(RegisterLayout(
+			NAME("blueNoise"), 23, SamplerType::SAMPLER_2D, 2, 2, ShaderAccess::COMPUTE
+		));
+
+		temporalLayout = factory.get(
+			NAME("Temporal denoise layout"),
+			PipelineLayout::Info(temporalRegisters)
+		);
+
+		auto atrousRegisters = denoiseRegisters;
+
+		atrousRegisters.push_back(RegisterLayout(
+			NAME("historyEvenOutput"), 18, TextureType::TEXTURE_2D, 2, 2, 
+			ShaderAccess::COMPUTE, GPUFormat::outputFormat, true
+		));
+
+		atrousRegisters.push_back(RegisterLayout(
+			NAME("historyOddOutput"), 22, TextureType::TEXTURE_2D, 4, 2, 
+			ShaderAccess::COMPUTE, GPUFormat::outputFormat, true
+		));
+
+		atrousLayout = factory.get(
+			NAME("A-trous denoise layout"),
+			PipelineLayout::Info(atrousRegisters)
+		);
+
+		for (u32 i = 0; i < atrousIterations; ++i) {
+
+			denoisePasses[i] = { 1u << i, i == 0 };
+
+			u32 passUniform = uniforms.add(denoisePasses + i);
+
+			atrousDescriptors[i] = {
+				g, NAME("A-trous descriptors " + std::to_string(i)),
+				Descriptors::Info(
+					atrousLayout, 2, {
+						{ 10, uniforms.getSubresource(propertiesUniform) },
+						{ 11, uniforms.getSubresource(passUniform) },
+						{ 13, GPUSubresource(seed, GPUBufferType::UNIFORM) },
+						{ 19, uniforms.getSubresource(previousCameraUniform) }
+					}
+				)
+			};
+
+			//Temporal doesn't use the pass data, but most of the layout is shared
+
+			if(i == 0)
+				temporalDescriptors = {
+					g, NAME("Temporal descriptors"),
+					Descriptors::Info(
+						temporalLayout, 2, {
+							{ 10, uniforms.getSubresource(propertiesUniform) },
+							{ 11, uniforms.getSubresource(passUniform) },
+							{ 13, GPUSubresource(seed, GPUBufferType::UNIFORM) },
+							{ 19, uniforms.getSubresource(previousCameraUniform) },
+							{ 23, blueNoise }
+						}
+					)
+				};
+		}
+
+		temporalShader = factory.get(
+			NAME("Temporal denoise shader"),
+			Pipeline::Info(
+				Pipeline::Flag::NONE,
+				VIRTUAL_FILE("shaders/denoise_temporal.comp.spv"),
+				{},
+				temporalLayout,
+				Vec3u32(THREADS_XY, THREADS_XY, 1)
+			)
+		);
+
+		atrousShader = factory.get(
+			NAME("A-trous denoise shader"),
+			Pipeline::Info(
+				Pipeline::Flag::NONE,
+				VIRTUAL_FILE("shaders/denoise_atrous.comp.spv"),
+				{},
+				atrousLayout,
+				Vec3u32(THREADS_XY, THREADS_XY, 1)
+			)
+		);
 	}
 
 	void ShadowTask::resize(const Vec2u32 &size) {
@@ -156,6 +352,9 @@ namespace igx::rt {
 		}
 
 		auto warps = (size.cast<Vec2f32>() / Vec2f32(THREADS_XY, threadsY)).ceil().cast<Vec2u16>();
+
+		//Sized for what was set, so the budget can go back up without a resize
+
 		usz warps1D = warps.prod<usz>() * properties->Shadow_samples;
 
 		shadowOutput.release();
@@ -165,14 +364,120 @@ namespace igx::rt {
 		};
 
 		shadowDescriptors->updateDescriptor(13, GPUSubresource(shadowOutput, GPUBufferType::STRUCTURED));
-		shadowDescriptors->updateDescriptor(14, GPUSubresource(nearestSampler, raygen->getTexture(0), TextureType::TEXTURE_2D));
+		shadowDescriptors->updateDescriptor(14, GPUSubresource(nearestSampler, raygen->getTexture(), TextureType::TEXTURE_2D));
 		shadowDescriptors->flush({ { 13, 2 } });
 
 		lightingDescriptors->updateDescriptor(13, GPUSubresource(shadowOutput, GPUBufferType::STRUCTURED));
-		lightingDescriptors->updateDescriptor(14, GPUSubresource(nearestSampler, raygen->getTexture(0), TextureType::TEXTURE_2D));
-		lightingDescriptors->updateDescriptor(15, GPUSubresource(nearestSampler, raygen->getTexture(1), TextureType::TEXTURE_2D));
+		lightingDescriptors->updateDescriptor(14, GPUSubresource(nearestSampler, raygen->getTexture(), TextureType::TEXTURE_2D));
 		lightingDescriptors->updateDescriptor(16, GPUSubresource(getTexture(0), TextureType::TEXTURE_2D));
-		lightingDescriptors->flush({ { 13, 4 } });
+		lightingDescriptors->updateDescriptor(17, GPUSubresource(linearSampler, clouds->getOutput(true), TextureType::TEXTURE_2D));
+		lightingDescriptors->flush({ { 13, 2 }, { 16, 2 } });
+
+		//Temporal: lighting + reprojected history and moments -> filter and current moments
+		//A-trous: filter -> lighting -> filter -> ...; first pass also writes history (of the other parity) and moments
+
+		auto gBuffer = GPUSubresource(nearestSampler, raygen->getTexture(), TextureType::TEXTURE_2D);
+
+		auto bindDenoise = [&](DescriptorsRef &desc, u32 input, u32 output) {
+			desc->updateDescriptor(12, gBuffer);
+			desc->updateDescriptor(14, GPUSubresource(nearestSampler, getTexture(input), TextureType::TEXTURE_2D));
+			desc->updateDescriptor(16, GPUSubresource(getTexture(output), TextureType::TEXTURE_2D));
+			desc->updateDescriptor(17, GPUSubresource(getTexture(2), TextureType::TEXTURE_2D));
+			desc->updateDescriptor(20, GPUSubresource(getTexture(4), TextureType::TEXTURE_2D));
+			desc->flush({ { 12, 1 }, { 14, 1 }, { 16, 2 }, { 20, 1 } });
+		};
+
+		bindDenoise(temporalDescriptors, 0, 3);
+
+		temporalDescriptors->updateDescriptor(15, GPUSubresource(nearestSampler, getTexture(1), TextureType::TEXTURE_2D));
+		temporalDescriptors->updateDescriptor(21, GPUSubresource(nearestSampler, getTexture(5), TextureType::TEXTURE_2D));
+		temporalDescriptors->flush({ { 15, 1 }, { 21, 1 } });
+
+		for (u32 i = 0; i < atrousIterations; ++i) {
+
+			bindDenoise(atrousDescriptors[i], i & 1 ? 0 : 3, i & 1 ? 3 : 0);
+
+			atrousDescriptors[i]->updateDescriptor(18, GPUSubresource(getTexture(1), TextureType::TEXTURE_2D));
+			atrousDescriptors[i]->updateDescriptor(22, GPUSubresource(getTexture(5), TextureType::TEXTURE_2D));
+			atrousDescriptors[i]->flush({ { 18, 1 }, { 22, 1 } });
+		}
+
+		cachedCloudShadowRes = clouds->getShadowResolution();
+	}
+
+	void ShadowTask::setTiles(const GPUBufferRef &tiles) {
+
+		shadowDescriptors->updateDescriptor(18, GPUSubresource(tiles, GPUBufferType::STRUCTURED));
+		shadowDescriptors->flush({ { 18, 1 } });
+
+		lightingDescriptors->updateDescriptor(18, GPUSubresource(tiles, GPUBufferType::STRUCTURED));
+		lightingDescriptors->flush({ { 18, 1 } });
+	}
+
+	void ShadowTask::setTraversalStats(const GPUBufferRef &totals, const GPUBufferRef &pixels) {
+
+		shadowDescriptors->updateDescriptor(21, GPUSubresource(totals, GPUBufferType::STRUCTURED));
+		shadowDescriptors->updateDescriptor(22, GPUSubresource(pixels, GPUBufferType::STRUCTURED));
+		shadowDescriptors->flush({ { 21, 2 } });
+
+		lightingDescriptors->updateDescriptor(21, GPUSubresource(totals, GPUBufferType::STRUCTURED));
+		lightingDescriptors->updateDescriptor(22, GPUSubresource(pixels, GPUBufferType::STRUCTURED));
+		lightingDescriptors->flush({ { 21, 2 } });
+	}
+
+	void ShadowTask::setSamples(u32 samples, bool denoise) {
+		properties->Shadow_samples = samples;
+		properties->Denoise = denoise;
+	}
+
+	bool ShadowTask::setDenoiseBypass(bool bypass) {
+
+		if (denoiseBypass == bypass)
+			return false;
+
+		denoiseBypass = bypass;
+		return true;
+	}
+
+	void ShadowTask::setEnvironmentMap(EnvironmentMap &&map) {
+		environment = std::move(map);
+		uploadEnvironment();
+	}
+
+	//Header + cdfs; the buffer is only recreated when the size changes
+
+	void ShadowTask::uploadEnvironment() {
+
+		List<u8> data = environment.getGPUData();
+
+		//Sky lighting without rays (toggle) keeps the map, but the header disables it
+
+		cachedSkyLightRays = properties->Sky_light_rays;
+
+		if (!cachedSkyLightRays)
+			((EnvironmentHeader*) data.data())->enabled = 0;
+
+		if (!environmentBuffer.exists() || environmentBuffer->size() != data.size()) {
+
+			environmentBuffer.release();
+			environmentBuffer = {
+				g, NAME("Environment importance"),
+				GPUBuffer::Info(
+					data.size(), GPUBufferUsage::STORAGE, GPUMemoryUsage::CPU_WRITE | GPUMemoryUsage::GPU_WRITE
+				)
+			};
+
+			shadowDescriptors->updateDescriptor(20, GPUSubresource(environmentBuffer, GPUBufferType::STRUCTURED));
+			shadowDescriptors->flush({ { 20, 1 } });
+
+			lightingDescriptors->updateDescriptor(20, GPUSubresource(environmentBuffer, GPUBufferType::STRUCTURED));
+			lightingDescriptors->flush({ { 20, 1 } });
+		}
+
+		std::memcpy(environmentBuffer->getBuffer(), data.data(), data.size());
+		environmentBuffer->flush(0, data.size());
+
+		markNeedCmdUpdate();
 	}
 
 	void ShadowTask::switchToScene(SceneGraph *_sceneGraph) {
@@ -183,35 +488,133 @@ namespace igx::rt {
 	}
 
 	bool ShadowTask::needsCommandUpdate() const {
-		return TextureRenderTask::needsCommandUpdate() || cachedSamples != properties->Shadow_samples;
+		return 
+			TextureRenderTask::needsCommandUpdate() || cachedSamples != properties->tracedSamples || 
+			cachedDenoise != isDenoised();
 	}
 
 	void ShadowTask::update(f64) {
-		std::memcpy(shadowProperties->getBuffer(), &properties.value, sizeof(ShadowProperties));
-		shadowProperties->flush(0, sizeof(ShadowProperties));
+
+		//Derived every frame, so the UI value is kept when the budget goes back up
+
+		properties->tracedSamples = budgetSamples(properties->Shadow_samples, sampleBudget);
+
+		//Cloud shadow map could've been resized
+
+		if (cachedCloudShadowRes && cachedCloudShadowRes != clouds->getShadowResolution()) {
+
+			lightingDescriptors->updateDescriptor(17, GPUSubresource(linearSampler, clouds->getOutput(true), TextureType::TEXTURE_2D));
+			lightingDescriptors->flush({ { 17, 1 } });
+
+			cachedCloudShadowRes = clouds->getShadowResolution();
+		}
+
+		CloudShadowMapping mapping = clouds->getShadowMapping();
+
+		properties->cloudShadowExtent = mapping.extent;
+		properties->cloudShadowOrigin = mapping.origin;
+		properties->cloudShadowHeight = mapping.height;
+
+		updateLightTree();
+
+		if (cachedSkyLightRays != properties->Sky_light_rays)
+			uploadEnvironment();
+	}
+
+	//Rebuild when point lights are added or removed, refit when they only moved or changed
+
+	void ShadowTask::updateLightTree() {
+
+		const auto &info = sceneGraph->getInfo();
+
+		const u32 firstPoint = info.directionalLightCount + info.spotLightCount;
+		const usz lightBytes = usz(info.pointLightCount) * sizeof(Light);
+
+		const u8 *lights = sceneGraph->getBuffer<SceneObjectType::LIGHT>()->getBuffer() + usz(firstPoint) * sizeof(Light);
+
+		const bool sameLights = cachedFirstPointLight == firstPoint && cachedPointLights.size() == lightBytes;
+
+		if (sameLights && !std::memcmp(cachedPointLights.data(), lights, lightBytes))
+			return;
+
+		const List<LightTreeInput> inputs = LightTree::fromSceneLights(lights, info.pointLightCount);
+
+		if (sameLights)
+			lightTree.refit(inputs);
+
+		else lightTree.build(inputs, firstPoint);
+
+		cachedPointLights.assign(lights, lights + lightBytes);
+		cachedFirstPointLight = firstPoint;
+
+		const List<LightNode> &nodes = lightTree.getNodes();
+
+		if (nodes.empty())
+			return;
+
+		if (cachedLightTreeNodes != nodes.size()) {
+
+			cachedLightTreeNodes = u32(nodes.size());
+
+			lightTreeBuffer.release();
+			lightTreeBuffer = {
+				g, NAME("Light tree"),
+				GPUBuffer::Info(
+					nodes.size() * sizeof(LightNode), GPUBufferUsage::STORAGE, 
+					GPUMemoryUsage::CPU_WRITE | GPUMemoryUsage::GPU_WRITE
+				)
+			};
+
+			shadowDescriptors->updateDescriptor(19, GPUSubresource(lightTreeBuffer, GPUBufferType::STRUCTURED));
+			shadowDescriptors->flush({ { 19, 1 } });
+
+			lightingDescriptors->updateDescriptor(19, GPUSubresource(lightTreeBuffer, GPUBufferType::STRUCTURED));
+			lightingDescriptors->flush({ { 19, 1 } });
+
+			markNeedCmdUpdate();
+		}
+
+		std::memcpy(lightTreeBuffer->getBuffer(), nodes.data(), nodes.size() * sizeof(LightNode));
+		lightTreeBuffer->flush(0, nodes.size() * sizeof(LightNode));
 	}
 
 	void ShadowTask::prepareCommandList(CommandList *cl) {
 
 		cl->add(
 
-			FlushBuffer(shadowProperties, factory.getDefaultUploadBuffer()),
+			FlushBuffer(lightTreeBuffer, factory.getDefaultUploadBuffer()),
+			FlushBuffer(environmentBuffer, factory.getDefaultUploadBuffer()),
 
 			//Trace shadow rays
 
 			BindDescriptors({ cameraDescriptor, sceneGraph->getDescriptors(), shadowDescriptors }),
 			BindPipeline(shadowShader),
-			Dispatch(Vec3u32(size().x, size().y, cachedSamples = properties->Shadow_samples)),
+			Dispatch(Vec3u32(size().x, size().y, cachedSamples = properties->tracedSamples)),
 
 			//Do lighting 
 
 			BindDescriptors({ cameraDescriptor, sceneGraph->getDescriptors(), lightingDescriptors }),
 			BindPipeline(lightingShader),
 			Dispatch(Vec2u32(size().x, size().y))
+		);
+
+		//Do denoising
 
-			//Do denoising
+		if (!(cachedDenoise = isDenoised()))
+			return;
 
+		cl->add(
+			BindDescriptors({ cameraDescriptor, sceneGraph->getDescriptors(), temporalDescriptors }),
+			BindPipeline(temporalShader),
+			Dispatch(Vec2u32(size().x, size().y)),
+			BindPipeline(atrousShader)
 		);
+
+		for (u32 i = 0; i < atrousIterations; ++i)
+			cl->add(
+				BindDescriptors({ cameraDescriptor, sceneGraph->getDescriptors(), atrousDescriptors[i] }),
+				Dispatch(Vec2u32(size().x, size().y))
+			);
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "rt/tiled_export.hpp"
+#include "rt/accumulation.hpp"
+#include "rt/gbuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace igx::rt {
+
+	List<ExportTile> planExportTiles(const Vec2u32 &size, const Vec2u32 &tileSize) {
+
+		const u32 w = std::max(tileSize.x, 1u), h = std::max(tileSize.y, 1u);
+
+		List<ExportTile> tiles;
+		tiles.reserve(usz((size.x + w - 1) / w) * ((size.y + h - 1) / h));
+
+		for (u32 y = 0; y < size.y; y += h)
+			for (u32 x = 0; x < size.x; x += w)
+				tiles.push_back({
+					Vec2u32(x, y),
+					Vec2u32(std::min(w, size.x - x), std::min(h, size.y - y))
+				});
+
+		return tiles;
+	}
+
+	//The file is sized up front, so tiles can be written in any order
+
+	TiledImageFile::TiledImageFile(const String &path, u32 width, u32 height, bool isFloat):
+		width(width), height(height), isFloat(isFloat)
+	{
+		const std::filesystem::path filePath(path);
+		std::error_code ec;
+
+		if (filePath.has_parent_path())
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+
+		//PFM is little endian if the scale is negative
+
+		const String header =
+			(isFloat ? "PF\n" : "P6\n") + std::to_string(width) + " " + std::to_string(height) +
+			(isFloat ? "\n-1.0\n" : "\n255\n");
+
+		headerSize = header.size();
+
+		{
+			std::ofstream out(filePath, std::ios::binary);
+			out.write(header.data(), std::streamsize(header.size()));
+
+			if (!out)
+				return;
+		}
+
+		const u64 pixelBytes = isFloat ? sizeof(f32) * 3 : 3;
+		std::filesystem::resize_file(filePath, headerSize + u64(width) * height * pixelBytes, ec);
+
+		if (!ec)
+			file.open(filePath, std::ios::binary | std::ios::in | std::ios::out);
+
+		else file.setstate(std::ios::failbit);
+	}
+
+	bool TiledImageFile::writeTile(const u8 *rgba, u32 tileWidth, const ExportTile &tile) {
+
+		if (!file || tile.offset.x + tile.size.x > width || tile.offset.y + tile.size.y > height)
+			return false;
+
+		const usz channelBytes = isFloat ? sizeof(f32) : 1;
+
+		List<u8> row(usz(tile.size.x) * 3 * channelBytes);
+
+		for (u32 y = 0; y < tile.size.y; ++y) {
+
+			//rgba to rgb
+
+			const u8 *src = rgba + usz(y) * tileWidth * 4 * channelBytes;
+
+			for (usz x = 0; x < tile.size.x; ++x)
+				std::memcpy(row.data() + x * 3 * channelBytes, src + x * 4 * channelBytes, 3 * channelBytes);
+
+			const u32 dstY = isFloat ? height - 1 - (tile.offset.y + y) : tile.offset.y + y;
+
+			file.seekp(std::streamoff(headerSize + (u64(dstY) * width + tile.offset.x) * 3 * channelBytes));
+			file.write((const c8*) row.data(), std::streamsize(row.size()));
+		}
+
+		file.flush();
+		return bool(file);
+	}
+
+	usz estimateExportMemory(const Vec2u32 &size, bool compactAccumulation, bool hdr) {
+
+		static constexpr usz outputFormat = sizeof(u16) * 4;
+
+		const usz bytesPerPixel =
+			gBufferBytesPerPixel +																		//gBuffer
+			outputFormat * 3 + sizeof(f32) * 4 * 2 +													//Lighting, history, filter, moments
+			4 +																							//Composite output
+			(compactAccumulation ? compactAccumulationBytesPerPixel : accumulationBytesPerPixel) +
+			(hdr ? sizeof(f32) * 4 : 0) +																//HDR output
+			4 + (hdr ? sizeof(f32) * 4 : 0);															//Readback
+
+		return usz(size.x) * size.y * bytesPerPixel;
+	}
+
+}
\ No newline at end of file
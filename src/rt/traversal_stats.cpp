@@ -0,0 +1,193 @@
+#include "rt/traversal_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace igx::rt {
+
+	static constexpr f32 noHit = std::numeric_limits<f32>::max();
+	static constexpr u32 noRayHit = 0xFFFFFFFF;
+
+	TraversalCounters &TraversalCounters::operator+=(const TraversalCounters &other) {
+
+		for (usz i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+			counts[i] += other.counts[i];
+
+		return *this;
+	}
+
+	bool TraversalCounters::operator==(const TraversalCounters &other) const {
+		return std::equal(counts, counts + STAT_COUNT, other.counts);
+	}
+
+	TraversalRates traversalRates(const TraversalCounters &counters, f64 seconds) {
+
+		const f64 primaries = f64(counters[STAT_RAYS]);
+		const f64 rays = primaries + f64(counters[STAT_SHADOW_RAYS]);
+
+		return {
+			seconds > 0 ? rays / seconds : 0,
+			rays > 0 ? f64(counters[STAT_PRIMITIVE_TESTS]) / rays : 0,
+			rays > 0 ? f64(counters[STAT_NODES_VISITED]) / rays : 0,
+			primaries > 0 ? f64(counters[STAT_SHADOW_RAYS]) / primaries : 0,
+			primaries > 0 ? f64(counters[STAT_DENSITY_TAPS]) / primaries : 0
+		};
+	}
+
+	String traversalReport(const TraversalRates &rates) {
+
+		c8 report[256];
+
+		std::snprintf(
+			report, sizeof(report),
+			"Rays/s: %.2fM\nTests/ray: %.1f\nNodes/ray: %.1f\nShadow rays/primary: %.2f\nDensity taps/primary: %.1f\n",
+			rates.raysPerSecond * 1e-6, rates.testsPerRay, rates.nodesPerRay, rates.shadowRaysPerPrimary, rates.tapsPerPrimary
+		);
+
+		return report;
+	}
+
+	//Mirror of primitive.glsl
+
+	static inline f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	static inline Vec3f32 cross(const Vec3f32 &a, const Vec3f32 &b) {
+		return Vec3f32(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	static inline bool intersectTri(
+		const Vec3f32 &pos, const Vec3f32 &dir, const Vec3f32 *p, f32 &hitT, u32 obj, u32 prevObj
+	) {
+		const Vec3f32 p1_p0 = p[1] - p[0];
+		const Vec3f32 p2_p0 = p[2] - p[0];
+
+		const Vec3f32 h = cross(dir, p2_p0);
+		const f32 a = dot(p1_p0, h);
+
+		const f32 f = 1 / a;
+		const Vec3f32 s = pos - p[0];
+		const f32 u = f * dot(s, h);
+
+		if (u < 0 || u > 1)
+			return false;
+
+		const Vec3f32 q = cross(s, p1_p0);
+		const f32 v = f * dot(dir, q);
+
+		if (v < 0 || u + v > 1)
+			return false;
+
+		const f32 t = f * dot(p2_p0, q);
+
+		if (t <= 0 || obj == prevObj || t >= hitT)
+			return false;
+
+		hitT = t;
+		return true;
+	}
+
+	static inline bool intersectSphere(
+		const Vec3f32 &pos, const Vec3f32 &dir, const Vec4f32 &sphere, f32 &hitT, u32 obj, u32 prevObj
+	) {
+		const Vec3f32 dif = Vec3f32(sphere.x, sphere.y, sphere.z) - pos;
+		const f32 t = dot(dif, dir);
+
+		const Vec3f32 Q = dif - dir * t;
+		const f32 Q2 = dot(Q, Q);
+		const f32 R2 = sphere.w * sphere.w;
+
+		if (Q2 > R2)
+			return false;
+
+		const f32 sphereT = t - std::sqrt(R2 - Q2);
+
+		if (obj == prevObj || sphereT < 0 || sphereT >= hitT)
+			return false;
+
+		hitT = sphereT;
+		return true;
+	}
+
+	static inline bool intersectCube(
+		const Vec3f32 &pos, const Vec3f32 &dir, const Vec3f32 *cube, f32 &hitT, u32 obj, u32 prevObj
+	) {
+		const f32 start[] = { (cube[0].x - pos.x) / dir.x, (cube[0].y - pos.y) / dir.y, (cube[0].z - pos.z) / dir.z };
+		const f32 end[] = { (cube[1].x - pos.x) / dir.x, (cube[1].y - pos.y) / dir.y, (cube[1].z - pos.z) / dir.z };
+
+		f32 tmin = -noHit, tmax = noHit;
+
+		for (usz i = 0; i < 3; ++i) {
+			tmin = std::max(tmin, std::min(start[i], end[i]));
+			tmax = std::min(tmax, std::max(start[i], end[i]));
+		}
+
+		if (tmax < 0 || tmin > tmax || tmin > hitT || obj == prevObj)
+			return false;
+
+		hitT = tmin;
+		return true;
+	}
+
+	static inline bool intersectPlane(
+		const Vec3f32 &pos, const Vec3f32 &dir, const Vec4f32 &plane, f32 &hitT, u32 obj, u32 prevObj
+	) {
+		const Vec3f32 n = Vec3f32(plane.x, plane.y, plane.z).normalize();
+		const f32 planeT = -(-dot(pos, n) + plane.w) / -dot(dir, n);
+
+		if (planeT < 0 || obj == prevObj || planeT >= hitT)
+			return false;
+
+		hitT = planeT;
+		return true;
+	}
+
+	//Same order as trace.glsl, so the object ids match
+
+	template<bool closest>
+	static inline f32 traceLists(
+		const TraversalScene &scene, TraversalCounters &counters,
+		const Vec3f32 &pos, const Vec3f32 &dir, u32 prevHit, u32 &object
+	) {
+		f32 hitT = noHit;
+		u32 j = 0;
+
+		const usz triangles = scene.triangles.size() / 3, cubes = scene.cubes.size() / 2;
+
+		counters[STAT_PRIMITIVE_TESTS] += triangles + scene.spheres.size() + cubes + scene.planes.size();
+		counters[STAT_NODES_VISITED] += u64(triangles != 0) + u64(!scene.spheres.empty()) + u64(cubes != 0) + u64(!scene.planes.empty());
+
+		for (usz i = 0; i < triangles; ++i, ++j)
+			if (intersectTri(pos, dir, scene.triangles.data() + i * 3, hitT, j, prevHit) && closest)
+				object = j;
+
+		for (usz i = 0; i < scene.spheres.size(); ++i, ++j)
+			if (intersectSphere(pos, dir, scene.spheres[i], hitT, j, prevHit) && closest)
+				object = j;
+
+		for (usz i = 0; i < cubes; ++i, ++j)
+			if (intersectCube(pos, dir, scene.cubes.data() + i * 2, hitT, j, prevHit) && closest)
+				object = j;
+
+		for (usz i = 0; i < scene.planes.size(); ++i, ++j)
+			if (intersectPlane(pos, dir, scene.planes[i], hitT, j, prevHit) && closest)
+				object = j;
+
+		return hitT;
+	}
+
+	f32 TraversalTracer::traceGeometry(const Vec3f32 &pos, const Vec3f32 &dir, u32 prevHit, u32 &object) {
+		++counters[STAT_RAYS];
+		object = noRayHit;
+		return traceLists<true>(scene, counters, pos, dir, prevHit, object);
+	}
+
+	bool TraversalTracer::traceOcclusion(const Vec3f32 &pos, const Vec3f32 &dir, f32 maxDist, u32 prevHit) {
+		++counters[STAT_SHADOW_RAYS];
+		u32 object{};
+		return traceLists<false>(scene, counters, pos, dir, prevHit, object) < maxDist;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "rt/uniform_manager.hpp"
+#include "graphics/graphics.hpp"
+#include "system/system.hpp"
+#include "system/log.hpp"
+
+namespace igx::rt {
+
+	UniformManager::UniformManager(Graphics &g, usz capacity):
+		buffer {
+			g, NAME("Uniform buffer"),
+			GPUBuffer::Info(
+				capacity, GPUBufferUsage::UNIFORM, GPUMemoryUsage::CPU_WRITE
+			)
+		},
+		shadow(capacity)
+	{ }
+
+	u32 UniformManager::add(const void *src, usz size) {
+
+		if (head + size > buffer->size())
+			oic::System::log()->fatal("Uniform buffer is out of space");
+
+		uniforms.push_back(Uniform{ src, head, size, true });
+		head = (head + size + alignment - 1) / alignment * alignment;
+
+		return u32(uniforms.size() - 1);
+	}
+
+	void UniformManager::markDirty(u32 id) {
+		uniforms[id].isDirty = true;
+	}
+
+	usz UniformManager::update() {
+
+		bytesUploaded = 0;
+
+		//CPU copy; frames that were already submitted staged their ranges, so it can be rewritten right away (see header)
+
+		u8 *mapped = buffer->getBuffer();
+
+		for (Uniform &u : uniforms) {
+
+			const u8 *src = (const u8*) u.src;
+			u8 *prev = shadow.data() + u.offset;
+
+			usz start = 0, end = u.size;
+
+			//Find the first and last byte that changed
+
+			if (!u.isDirty) {
+
+				for (; start < u.size && src[start] == prev[start]; ++start);
+
+				if (start == u.size)
+					continue;
+
+				for (; end > start && src[end - 1] == prev[end - 1]; --end);
+			}
+
+			const usz size = end - start;
+
+			std::memcpy(prev + start, src + start, size);
+			std::memcpy(mapped + u.offset + start, src + start, size);
+			buffer->flush(u.offset + start, size);
+
+			u.isDirty = false;
+			bytesUploaded += size;
+		}
+
+		return bytesUploaded;
+	}
+
+	GPUSubresource UniformManager::getSubresource(u32 id) const {
+		const Uniform &u = uniforms[id];
+		return GPUSubresource(buffer, GPUBufferType::UNIFORM, u.offset, u.size);
+	}
+
+}
\ No newline at end of file
@@ -1,20 +1,161 @@
 #include "rt/raytracing_interface.hpp"
 #include "scene/niels_scene.hpp"
+#include "scene/generated_scene.hpp"
+#include "system/log.hpp"
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <string>
 
 //Create window and wait for exit
+//Distributed exports: --worker <index> <count> renders one share, --merge <targetOutput> <count> merges them
+//Scaling: --scene <uniform/clustered/city> <objects> [seed] replaces the default scene with a generated one
+//	--scaling <uniform/clustered/city> <objects> <camera path> [csv output] replays the path over it headless and appends
+//	the frame times and the CPU proxy to the csv; one process per object count, e.g. for n in 10 100 ... 10000000
+//Camera paths: --record <path> logs the flythrough, --replay <path> [output json] renders it headless and writes frame times
+//Quality: --quality <camera path> [csv output] [target FLIP] renders every default config from the first frame of the path
+//	and writes the error against a cached reference over time (see image_quality.hpp)
 
-int main() {
+//The whole argument has to be a number; bad input prints usage instead of throwing
+
+template<typename T>
+static bool parseNumber(const char *text, T &value) {
+	const char *end = text + std::strlen(text);
+	const auto [ptr, ec] = std::from_chars(text, end, value);
+	return ec == std::errc() && ptr == end && ptr != text;
+}
+
+int main(int argc, char *argv[]) {
 
 	using namespace oic;
 
+	const std::string mode = argc >= 3 ? argv[1] : "";
+
+	if (mode == "--merge" && argc >= 4) {
+
+		u32 count;
+
+		if (!parseNumber(argv[3], count)) {
+			System::log()->error("Expected --merge <targetOutput> <count>");
+			return 1;
+		}
+
+		return igx::rt::mergeDistributedExport(argv[2], count) ? 0 : 1;
+	}
+
+	u32 workerIndex{}, workerCount{};
+	const bool isWorker = mode == "--worker" && argc >= 4;
+
+	if (isWorker && (!parseNumber(argv[2], workerIndex) || !parseNumber(argv[3], workerCount))) {
+		System::log()->error("Expected --worker <index> <count>");
+		return 1;
+	}
+
+	igx::rt::SceneGeneratorInfo generated;
+
+	const bool isScaling = mode == "--scaling";
+
+	const bool isGenerated =
+		(mode == "--scene" || isScaling) && argc >= 4 &&
+		igx::rt::parseSceneLayout(argv[2], generated.layout) &&
+		parseNumber(argv[3], generated.objects) &&
+		(argc <= 4 || isScaling || parseNumber(argv[4], generated.seed));
+
+	if (isScaling && (!isGenerated || argc < 5)) {
+		System::log()->error("Expected --scaling <uniform/clustered/city> <objects> <camera path> [csv output]");
+		return 1;
+	}
+
+	if (mode == "--scene" && !isGenerated) {
+		System::log()->error("Expected --scene <uniform/clustered/city> <objects> [seed]");
+		return 1;
+	}
+
+	f64 targetFlip = 0.02;
+
+	if (mode == "--quality" && argc > 4 && !parseNumber(argv[4], targetFlip)) {
+		System::log()->error("Expected --quality <camera path> [csv output] [target FLIP]");
+		return 1;
+	}
+
 	ignis::Graphics g("Igx raytracing test", 1, "Igx", 1);
 
 	igx::FactoryContainer factory(g);
 	igx::ui::GUI gui(g);
 
-	igx::rt::NielsScene nielscene(gui, factory);
+	//Both the scene and the lighting use the skybox
+
+	const String skybox = VIRTUAL_FILE("textures/qwantani_4k.hdr");
+
+	std::unique_ptr<igx::SceneGraph> scene;
+
+	if (isGenerated)
+		scene = std::make_unique<igx::rt::GeneratedSceneGraph>(gui, factory, skybox, generated);
+
+	else scene = std::make_unique<igx::rt::NielsScene>(gui, factory, skybox);
+
+	igx::rt::RaytracingInterface viewportInterface(g, gui, factory, *scene, skybox);
+
+	if (isWorker)
+		viewportInterface.exportAsWorker(workerIndex, workerCount);
+
+	else if (mode == "--replay")
+		return viewportInterface.replayCameraPath(argv[2], argc > 3 ? argv[3] : "./output/replay.json") ? 0 : 1;
+
+	else if (isScaling) {
+
+		List<f64> frameMs;
+
+		if (!viewportInterface.replayCameraPath(argv[4], frameMs))
+			return 1;
+
+		igx::rt::SceneScaling step = igx::rt::measureSceneScaling(generated);
+		step.frames = igx::rt::frameTimeStats(frameMs);
+
+		const std::string output = argc > 5 ? argv[5] : std::string("./output/scaling_") + igx::rt::sceneLayoutName(generated.layout) + ".csv";
+		return igx::rt::appendSceneScaling(output, generated.layout, step) ? 0 : 1;
+	}
+
+	else if (mode == "--quality") {
+
+		List<igx::rt::QualityCurve> curves;
+
+		if (!viewportInterface.measureQualityPerTime(argv[2], igx::rt::defaultQualityConfigs(), {}, curves))
+			return 1;
+
+		f64 ms;
+		const i32 best = igx::rt::cheapestToTarget(curves, targetFlip, ms);
+
+		if (best >= 0)
+			System::log()->debug("Cheapest to FLIP " + std::to_string(targetFlip) + ": " + curves[best].config.name + " in " + std::to_string(ms) + "ms");
+
+		else System::log()->debug("No config reaches FLIP " + std::to_string(targetFlip));
+
+		//Adaptive against uniform sampling (the first config) at equal error
+
+		for (const igx::rt::QualityCurve &curve : curves)
+			if (curve.config.adaptiveError > 0) {
+
+				const f64 speedup = igx::rt::equalErrorSpeedup(curves[0], curve, targetFlip);
+
+				if (speedup > 0)
+					System::log()->debug(curve.config.name + " is " + std::to_string(speedup) + "x as fast as " + curves[0].config.name + " to FLIP " + std::to_string(targetFlip));
+
+				else System::log()->debug(curve.config.name + " or " + curves[0].config.name + " doesn't reach FLIP " + std::to_string(targetFlip));
+			}
+
+		const std::string output = argc > 3 ? argv[3] : "./output/quality.csv";
+
+		if (!igx::rt::writeQualityCurves(output, curves)) {
+			System::log()->error("Couldn't write " + output);
+			return 1;
+		}
+
+		return 0;
+	}
 
-	igx::rt::RaytracingInterface viewportInterface(g, gui, factory, nielscene);
+	else if (mode == "--record")
+		viewportInterface.recordCameraPath(argv[2]);
 
 	g.pause();
 
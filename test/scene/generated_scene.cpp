@@ -0,0 +1,57 @@
+#include "generated_scene.hpp"
+#include "rt/sampler.hpp"
+
+namespace igx::rt {
+
+	static inline f32 random01(u32 &state) {
+		state = hashUint(state);
+		return f32(state & 0xFFFFFF) / 0x1000000;
+	}
+
+	GeneratedSceneGraph::GeneratedSceneGraph(ui::GUI &gui, FactoryContainer &factory, const String &skybox, const SceneGeneratorInfo &info):
+		SceneGraph(gui, factory, NAME("Generated scene"), skybox)
+	{
+		const GeneratedScene scene = generateScene(info);
+
+		//Random dielectrics and metals; the first is the ground
+
+		u32 state = hashUint(info.seed ^ 0x9E3779B9);
+
+		for (u32 i = 0, j = std::max(info.materials, 1u); i < j; ++i) {
+
+			const Vec3f32 albedo(random01(state), random01(state), random01(state));
+			const f32 metallic = random01(state) < 0.25f ? 1.f : 0.f;
+
+			add(Material{ albedo, albedo * 0.05f, { 0, 0, 0 }, metallic, random01(state), 1 });
+		}
+
+		const TraversalScene &geometry = scene.geometry;
+		usz object{};
+
+		for (usz i = 0; i < geometry.triangles.size(); i += 3)
+			addGeometry(Triangle{ geometry.triangles[i], geometry.triangles[i + 1], geometry.triangles[i + 2] }, scene.materials[object++]);
+
+		for (const Vec4f32 &sphere : geometry.spheres)
+			addGeometry(Sphere{ Vec3f32(sphere.x, sphere.y, sphere.z), sphere.w }, scene.materials[object++]);
+
+		for (usz i = 0; i < geometry.cubes.size(); i += 2)
+			addGeometry(Cube{ geometry.cubes[i], geometry.cubes[i + 1] }, scene.materials[object++]);
+
+		for (const Vec4f32 &plane : geometry.planes)
+			addGeometry(Plane{ Vec3f32(plane.x, plane.y, plane.z), plane.w }, scene.materials[object++]);
+
+		for (const GeneratedLight &light : scene.lights)
+			if (light.isPoint)
+				add(Light{ light.posOrDir, light.color, light.radius, light.origin });
+
+			else add(Light{ light.posOrDir, light.color });
+
+		oic::System::log()->debug(
+			"Generated " + std::to_string(scene.materials.size()) + " objects (" + sceneLayoutName(info.layout) +
+			", seed " + std::to_string(info.seed) + "), " + std::to_string(scene.gpuBytes() >> 10) + " KiB of geometry"
+		);
+
+		update(0);
+	}
+
+}
\ No newline at end of file
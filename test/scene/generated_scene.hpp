@@ -0,0 +1,17 @@
+#pragma once
+#include "helpers/scene_graph.hpp"
+#include "rt/scene_generator.hpp"
+
+namespace igx::rt {
+
+	//Procedural scene for scaling runs (see scene_generator.hpp); static, so update only forwards
+
+	class GeneratedSceneGraph : public SceneGraph {
+
+	public:
+
+		GeneratedSceneGraph(ui::GUI &gui, FactoryContainer &factory, const String &skybox, const SceneGeneratorInfo &info);
+
+	};
+
+}
\ No newline at end of file
@@ -2,8 +2,8 @@
 
 namespace igx::rt {
 
-	NielsScene::NielsScene(ui::GUI &gui, FactoryContainer &factory):
-		SceneGraph(gui, factory, NAME("Niels scene"), VIRTUAL_FILE("textures/qwantani_4k.hdr"))
+	NielsScene::NielsScene(ui::GUI &gui, FactoryContainer &factory, const String &skybox):
+		SceneGraph(gui, factory, NAME("Niels scene"), skybox)
 	{
 		Vec3f32 sunDir = Vec3f32{ -0.5f, -2, -1 }.normalize();
 
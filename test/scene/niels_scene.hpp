@@ -10,7 +10,7 @@ namespace igx::rt {
 
 	public:
 
-		NielsScene(ui::GUI &gui, FactoryContainer &factory);
+		NielsScene(ui::GUI &gui, FactoryContainer &factory, const String &skybox);
 
 		void update(f64 dt) override;
 
@@ -0,0 +1,86 @@
+#include "tests.hpp"
+#include "rt/accumulation.hpp"
+#include "rt/half.hpp"
+#include "rt/sampler.hpp"
+#include <algorithm>
+
+using namespace igx::rt;
+
+static f32 random01(u32 &state) {
+	state = hashUint(state);
+	return f32(state & 0xFFFFFF) / 0x1000000;
+}
+
+//Relative error of the rgba32f sum, the compact mean and a plain fp16 mean against an f64 reference, on HDR noise
+//Max over all pixels, per power of two samples
+
+RT_TEST(compactAccumulation) {
+
+	static constexpr u32 maxSamples = 4096, pixels = 256;
+	static constexpr usz steps = 13;
+
+	f64 fullError[steps]{}, compactError[steps]{}, halfError[steps]{};
+	u32 state = 1;
+
+	for (u32 j = 0; j < pixels; ++j) {
+
+		//Exponential noise around a mean between 1e-3 and 1e2
+
+		const f32 scale = std::pow(10.f, random01(state) * 5 - 3);
+
+		f64 reference[3]{};
+		f32 halfMean[3]{};
+		Vec4f32 sum;
+		CompactAccumulator compact;
+
+		usz step = 0;
+
+		for (u32 i = 1; i <= maxSamples; ++i) {
+
+			const Vec3f32 color(
+				-std::log(1 - random01(state) * 0.999f) * scale,
+				-std::log(1 - random01(state) * 0.999f) * scale,
+				-std::log(1 - random01(state) * 0.999f) * scale
+			);
+
+			const f32 lum = color.x * 0.2126f + color.y * 0.7152f + color.z * 0.0722f;
+
+			reference[0] += color.x;
+			reference[1] += color.y;
+			reference[2] += color.z;
+
+			sum += Vec4f32(color.x, color.y, color.z, lum * lum);
+			compact.add(Vec4f32(color.x, color.y, color.z, lum), i);
+
+			const f32 sample[3] = { color.x, color.y, color.z };
+
+			for (usz k = 0; k < 3; ++k)
+				halfMean[k] = fromHalf(toHalf(halfMean[k] + (sample[k] - halfMean[k]) / f32(i)));
+
+			if (i != 1u << step)
+				continue;
+
+			const Vec4f32 compactMean = compact.get();
+
+			const f32 full[3] = { sum.x / f32(i), sum.y / f32(i), sum.z / f32(i) };
+			const f32 comp[3] = { compactMean.x, compactMean.y, compactMean.z };
+
+			for (usz k = 0; k < 3; ++k) {
+				const f64 ref = reference[k] / i;
+				fullError[step] = std::max(fullError[step], std::abs(full[k] - ref) / ref);
+				compactError[step] = std::max(compactError[step], std::abs(comp[k] - ref) / ref);
+				halfError[step] = std::max(halfError[step], std::abs(halfMean[k] - ref) / ref);
+			}
+
+			++step;
+		}
+	}
+
+	//The residual has to win back most of what fp16 loses; at 4096 samples a plain fp16 mean is off by 20%
+
+	for (usz i = 0; i < steps; ++i) {
+		RT_CHECK(fullError[i] < 1e-5);
+		RT_CHECK(compactError[i] < 5e-4);
+		RT_CHECK(compactError[i] < halfError[i] * 0.1);
+	}
+}
\ No newline at end of file
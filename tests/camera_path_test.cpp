@@ -0,0 +1,118 @@
+#include "tests.hpp"
+#include "rt/camera_path.hpp"
+#include <cstring>
+#include <filesystem>
+
+using namespace igx::rt;
+
+static void fillSnapshot(List<u8> &snapshot, u32 i) {
+	for (usz j = 0; j < snapshot.size(); ++j)
+		snapshot[j] = u8((i * 31 + j * 7) ^ (i >> 8));
+}
+
+//Records a synthetic path (camera moving every frame, properties every 600 frames) and reads it back
+//Unchanged snapshots aren't stored, so a frame is the camera and a few bytes
+
+static void recordTestPath(const String &path, u32 frames, u32 cameraSize, u32 propertiesSize) {
+
+	List<u8> camera(cameraSize), properties(propertiesSize);
+
+	CameraPathRecorder recorder;
+	RT_CHECK(recorder.begin(path, cameraSize, propertiesSize));
+
+	for (u32 i = 0; i < frames; ++i) {
+
+		fillSnapshot(camera, i);
+		fillSnapshot(properties, i / 600);
+
+		recorder.add(1.0 / 60, camera.data(), properties.data());
+	}
+
+	RT_CHECK(recorder.size() == frames);
+	RT_CHECK(recorder.end());
+}
+
+static bool matchesTestPath(const CameraPath &cameraPath, u32 frames) {
+
+	List<u8> camera(cameraPath.cameraSize), properties(cameraPath.propertiesSize);
+
+	if (cameraPath.frames.size() != frames)
+		return false;
+
+	for (u32 i = 0; i < frames; ++i) {
+
+		const CameraPath::Frame &frame = cameraPath.frames[i];
+
+		fillSnapshot(camera, i);
+		fillSnapshot(properties, i / 600);
+
+		if (
+			frame.dt != 1.0 / 60 ||
+			std::memcmp(cameraPath.getCamera(frame), camera.data(), camera.size()) ||
+			std::memcmp(cameraPath.getProperties(frame), properties.data(), properties.size())
+		)
+			return false;
+	}
+
+	return true;
+}
+
+RT_TEST(cameraPathRoundTrip) {
+
+	static constexpr u32 frames = 36000, cameraSize = 256, propertiesSize = 4;
+
+	const String path = tests::outputPath("camera_path_test.bin");
+
+	recordTestPath(path, frames, cameraSize, propertiesSize);
+
+	const f64 bytesPerFrame = f64(std::filesystem::file_size(path)) / frames;
+
+	CameraPath cameraPath;
+	RT_CHECK(readCameraPath(path, cameraPath));
+	RT_CHECK(cameraPath.cameraSize == cameraSize && cameraPath.propertiesSize == propertiesSize);
+	RT_CHECK(matchesTestPath(cameraPath, frames));
+	RT_CHECK(cameraPath.properties.size() == usz(frames / 600) * propertiesSize);
+	RT_CHECK(bytesPerFrame < sizeof(f64) + 1 + cameraSize + 1);
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
+
+//A recording that was cut short is still readable up to the last whole frame
+
+RT_TEST(cameraPathTruncated) {
+
+	static constexpr u32 frames = 100, cameraSize = 64, propertiesSize = 16;
+
+	const String path = tests::outputPath("camera_path_truncated.bin");
+
+	recordTestPath(path, frames, cameraSize, propertiesSize);
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - cameraSize / 2);
+
+	CameraPath cameraPath;
+	RT_CHECK(readCameraPath(path, cameraPath));
+	RT_CHECK(matchesTestPath(cameraPath, frames - 1));
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
+
+//Nearest rank; the order of the frames doesn't matter
+
+RT_TEST(frameTimePercentiles) {
+
+	List<f64> frameMs;
+
+	for (u32 i = 100; i > 0; --i)
+		frameMs.push_back(f64(i));
+
+	const FrameTimeStats stats = frameTimeStats(frameMs);
+
+	RT_CHECK(stats.frames == 100);
+	RT_CHECK_NEAR(stats.meanMs, 50.5, 1e-9);
+	RT_CHECK(stats.p50Ms == 50 && stats.p95Ms == 95 && stats.p99Ms == 99 && stats.maxMs == 100);
+	RT_CHECK(frameTimeReport(stats) == "p50 50.00 / p95 95.00 / p99 99.00 / max 100.00 ms (100 frames)");
+
+	RT_CHECK(frameTimeStats({}).frames == 0);
+	RT_CHECK(frameTimeStats({ 3 }).p99Ms == 3);
+}
\ No newline at end of file
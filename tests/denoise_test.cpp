@@ -0,0 +1,178 @@
+#include "tests.hpp"
+#include "rt/denoise_reference.hpp"
+#include "rt/sampler.hpp"
+#include <cstring>
+
+using namespace igx::rt;
+
+//Floor (object 1) and a wall behind it (object 2) that doesn't span the screen, so there's sky on both sides
+//Lighting is a smooth pattern times white noise of mean 1; denoised frames should get close to the pattern
+
+static constexpr u32 width = 64, height = 48;
+static constexpr f32 wallZ = 6, wallHalfWidth = 3;
+
+static f32 asFloat(u32 v) {
+	f32 res;
+	std::memcpy(&res, &v, sizeof(res));
+	return res;
+}
+
+static f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static DenoiseCamera cameraAt(f32 x) {
+	const Vec3f32 eye(x, 1, -4);
+	return { eye, eye + Vec3f32(-1.f, -0.75f, 1), eye + Vec3f32(1.f, -0.75f, 1), eye + Vec3f32(-1.f, 0.75f, 1) };
+}
+
+static Vec3f32 truth(const Vec3f32 &pos, u32 object) {
+
+	if (object == 1)
+		return Vec3f32(0.5f + 0.3f * std::sin(pos.x * 0.7f), 0.4f, 0.3f + 0.1f * std::cos(pos.z));
+
+	return pos.x < 0 ? Vec3f32(0.8f, 0.8f, 0.8f) : Vec3f32(0.2f, 0.3f, 0.6f);
+}
+
+//Same convention as reproject; p0 is the bottom left, x goes to p1 and y (down) from p2
+
+static DenoiseFrame renderFrame(const DenoiseCamera &camera, u32 frame, DenoiseImage &expected) {
+
+	DenoiseFrame res{ DenoiseImage({ width, height }), DenoiseImage({ width, height }), DenoiseImage({ width, height }) };
+	expected = DenoiseImage({ width, height });
+
+	const Vec3f32 right = camera.p1 - camera.p0, up = camera.p2 - camera.p0;
+
+	for (i32 y = 0; y < i32(height); ++y)
+		for (i32 x = 0; x < i32(width); ++x) {
+
+			const Vec2i32 loc(x, y);
+			const Vec3f32 target = camera.p0 + right * ((x + 0.5f) / width) + up * (1 - (y + 0.5f) / height);
+			const Vec3f32 dir = target - camera.eye;
+
+			f32 t = -1;
+			u32 object{};
+			Vec3f32 normal;
+
+			if (dir.y < 0) {
+				t = -camera.eye.y / dir.y;
+				object = 1;
+				normal = Vec3f32(0, 1, 0);
+			}
+
+			const f32 wallT = (wallZ - camera.eye.z) / dir.z;
+
+			if (wallT > 0 && (t < 0 || wallT < t) && std::abs(camera.eye.x + dir.x * wallT) <= wallHalfWidth) {
+				t = wallT;
+				object = 2;
+				normal = Vec3f32(0, 0, -1);
+			}
+
+			if (t < 0) {
+				res.gBuffer[loc] = Vec4f32(0, 0, 0, -1);
+				continue;
+			}
+
+			const Vec3f32 pos = camera.eye + dir * t;
+			const Vec3f32 color = truth(pos, object);
+			const f32 noise = 2 * f32(hashUint(hashUint(u32(y) * width + u32(x)) + frame) & 0xFFFF) / 0xFFFF;
+
+			res.gBuffer[loc] = Vec4f32(normal.x, normal.y, normal.z, std::sqrt(dot(dir * t, dir * t)));
+			res.hits[loc] = Vec4f32(pos.x, pos.y, pos.z, asFloat(object));
+			res.lighting[loc] = Vec4f32(color.x * noise, color.y * noise, color.z * noise, 0);
+			expected[loc] = Vec4f32(color.x, color.y, color.z, 0);
+		}
+
+	return res;
+}
+
+static f64 rmse(const DenoiseImage &a, const DenoiseImage &b, const DenoiseImage &gBuffer) {
+
+	f64 sum{};
+	usz count{};
+
+	for (usz i = 0; i < a.pixels.size(); ++i)
+		if (gBuffer.pixels[i].w >= 0) {
+			const Vec4f32 d = a.pixels[i] - b.pixels[i];
+			sum += f64(d.x) * d.x + f64(d.y) * d.y + f64(d.z) * d.z;
+			count += 3;
+		}
+
+	return count ? std::sqrt(sum / count) : 0;
+}
+
+static u32 historyLength(const DenoiseState &state, const Vec2i32 &loc) {
+	u32 surface;
+	std::memcpy(&surface, &state.moments[loc].w, sizeof(surface));
+	return surface >> 24;
+}
+
+RT_TEST(denoiseDifference) {
+
+	DenoiseImage a({ 4, 4 }), b({ 4, 4 });
+
+	for (Vec4f32 &pixel : b.pixels)
+		pixel = Vec4f32(1, 1, 1, 5);
+
+	RT_CHECK(denoiseDifference(a, a) == 0);
+	RT_CHECK_NEAR(denoiseDifference(a, b), 1, 1e-9);		//Alpha is ignored
+
+	b.pixels[0] = Vec4f32(4, 1, 1, 0);
+	RT_CHECK_NEAR(denoiseDifference(a, b), std::sqrt((16 + 47) / 48.0), 1e-6);
+}
+
+//A camera moving sideways for a few frames; history has to follow the surfaces
+//The last frame is compared against tests/data/denoise_reference.pfm
+
+RT_TEST(denoise) {
+
+	DenoiseState state;
+	DenoiseImage result, expected;
+	DenoiseFrame frame;
+	DenoiseCamera previous{};
+
+	static constexpr u32 frames = 6;
+
+	f64 noisyError{}, denoisedError{};
+
+	for (u32 i = 0; i < frames; ++i) {
+
+		const DenoiseCamera camera = cameraAt(f32(i) * 0.02f);
+		frame = renderFrame(camera, i, expected);
+
+		result = denoiseReference(frame, i ? &previous : nullptr, state);
+		previous = camera;
+
+		if (!i) {
+
+			//Nothing to reproject; every surface starts over and the sky isn't filtered
+
+			RT_CHECK(historyLength(state, Vec2i32(width / 2, height - 1)) == 1);
+			RT_CHECK(result[Vec2i32(0, 0)].x == 0);
+
+			noisyError = rmse(frame.lighting, expected, frame.gBuffer);
+		}
+	}
+
+	denoisedError = rmse(result, expected, frame.gBuffer);
+
+	//Floor in the bottom center is seen every frame, the sky never is
+
+	RT_CHECK(historyLength(state, Vec2i32(width / 2, height - 1)) == frames);
+	RT_CHECK(historyLength(state, Vec2i32(0, 0)) == 0);
+
+	RT_CHECK(denoisedError < noisyError * 0.5);
+
+	tests::ReferenceImage image{ width, height, {} };
+	image.rgb.reserve(usz(width) * height * 3);
+
+	for (const Vec4f32 &pixel : result.pixels)
+		image.rgb.insert(image.rgb.end(), { pixel.x, pixel.y, pixel.z });
+
+	tests::writeReferenceImage(tests::outputPath("denoise.pfm"), image);
+
+	const f64 difference = tests::compareReferenceImage("denoise_reference.pfm", image);
+
+	RT_CHECK(difference >= 0);
+	RT_CHECK(difference <= 1e-4);
+}
\ No newline at end of file
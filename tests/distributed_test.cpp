@@ -0,0 +1,154 @@
+#include "tests.hpp"
+#include "rt/distributed.hpp"
+#include "rt/sampler.hpp"
+#include "rt/parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+
+using namespace igx::rt;
+
+//Stand-in for a worker's render: every pixel integrates an edge and a smooth lobe with its range of the sequence
+
+static PartialAccumulation renderPartial(u32 width, u32 height, const Vec2u32 &range) {
+
+	const u32 seed = hashUint(0);
+
+	PartialAccumulation partial{ width, height, range.x, range.y - range.x, List<f32>(usz(width) * height * 4) };
+
+	for (u32 y = 0; y < height; ++y)
+		for (u32 x = 0; x < width; ++x) {
+
+			const Vec2f32 rotation = hashedRotation(Vec2u32(x, y), SAMPLE_DIMENSION_PRIMARY);
+			const f32 angle = f32(hashUint(y * width + x) & 0xFFFF) / 0x10000 * 6.2831853f;
+
+			f32 *sum = partial.sum.data() + (usz(y) * width + x) * 4;
+
+			for (u32 i = range.x; i < range.y; ++i) {
+
+				const Vec2f32 u = sample2D(rotation, i, SAMPLE_DIMENSION_PRIMARY, seed);
+
+				const f32 edge = std::cos(angle) * (u.x - 0.5f) + std::sin(angle) * (u.y - 0.5f) > 0 ? 1.f : 0.f;
+				const f32 lobe = std::exp(-4 * ((u.x - 0.3f) * (u.x - 0.3f) + (u.y - 0.6f) * (u.y - 0.6f)));
+
+				sum[0] += edge;
+				sum[1] += lobe;
+				sum[2] += edge * lobe;
+				sum[3] += 1;
+			}
+		}
+
+	return partial;
+}
+
+//Partials of disjoint sample ranges add up to the single worker result; the coordinator writes their mean
+
+RT_TEST(distributedMerge) {
+
+	static constexpr u32 width = 64, height = 48, samples = 100;
+
+	const PartialAccumulation reference = renderPartial(width, height, Vec2u32(0, samples));
+
+	for (u32 workers = 2; workers <= 8; workers <<= 1) {
+
+		const String output = tests::outputPath("distributed/merge" + std::to_string(workers));
+
+		for (u32 i = 0; i < workers; ++i) {
+
+			const PartialAccumulation partial = renderPartial(width, height, workerSampleRange(samples, i, workers));
+			RT_CHECK(writePartialAccumulation(partialAccumulationPath(output, i), partial));
+
+			PartialAccumulation read;
+			RT_CHECK(readPartialAccumulation(partialAccumulationPath(output, i), read));
+			RT_CHECK(read.sampleStart == partial.sampleStart && read.samples == partial.samples && read.sum == partial.sum);
+		}
+
+		RT_CHECK(mergeDistributedExport(output, workers));
+
+		tests::ReferenceImage merged;
+		RT_CHECK(tests::readReferenceImage(output + "_merged.pfm", merged) && merged.width == width && merged.height == height);
+
+		f64 maxError{};
+
+		for (usz i = 0; i < usz(width) * height && i * 3 < merged.rgb.size(); ++i)
+			for (usz c = 0; c < 3; ++c)
+				maxError = std::max(maxError, f64(std::abs(merged.rgb[i * 3 + c] - reference.sum[i * 4 + c] / samples)));
+
+		RT_CHECK(maxError < 1e-5);
+
+		std::error_code ec;
+
+		for (u32 i = 0; i < workers; ++i)
+			std::filesystem::remove(partialAccumulationPath(output, i), ec);
+
+		std::filesystem::remove(output + "_merged.pfm", ec);
+	}
+}
+
+//Overlapping sample ranges would count samples twice and partials of another size can't be added
+
+RT_TEST(distributedMergeRejects) {
+
+	const PartialAccumulation a = renderPartial(8, 8, Vec2u32(0, 10));
+
+	PartialAccumulation merged;
+
+	RT_CHECK(!mergePartialAccumulations({}, merged));
+	RT_CHECK(!mergePartialAccumulations({ a, renderPartial(8, 8, Vec2u32(5, 15)) }, merged));
+	RT_CHECK(!mergePartialAccumulations({ a, renderPartial(8, 4, Vec2u32(10, 20)) }, merged));
+
+	RT_CHECK(mergePartialAccumulations({ renderPartial(8, 8, Vec2u32(10, 20)), a }, merged));
+	RT_CHECK(merged.sampleStart == 0 && merged.samples == 20);
+
+	for (u32 i = 0; i < 7; ++i) {
+		const Vec2u32 range = workerSampleRange(1000, i, 7), next = workerSampleRange(1000, i + 1, 7);
+		RT_CHECK(range.y == (i == 6 ? 1000 : next.x) && range.y > range.x);
+	}
+}
+
+//Workers as threads, each writing its own file like separate processes would; only with enough cores to scale
+
+RT_TEST(distributedScaling) {
+
+	static constexpr u32 width = 256, height = 256, samples = 128, workers = 4;
+
+	if (std::thread::hardware_concurrency() < workers)
+		return;
+
+	const String output = tests::outputPath("distributed/scaling");
+
+	auto run = [&](u32 count) {
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		parallelFor(count, count, [&](u32 begin, u32 end) {
+			for (u32 i = begin; i < end; ++i)
+				writePartialAccumulation(
+					partialAccumulationPath(output, i), renderPartial(width, height, workerSampleRange(samples, i, count))
+				);
+		});
+
+		List<PartialAccumulation> partials(count);
+
+		for (u32 i = 0; i < count; ++i)
+			readPartialAccumulation(partialAccumulationPath(output, i), partials[i]);
+
+		PartialAccumulation merged;
+		RT_CHECK(mergePartialAccumulations(partials, merged) && merged.samples == samples);
+
+		const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		std::error_code ec;
+
+		for (u32 i = 0; i < count; ++i)
+			std::filesystem::remove(partialAccumulationPath(output, i), ec);
+
+		return ms;
+	};
+
+	const f64 single = run(1), split = run(workers);
+
+	RT_CHECK(single / split > workers * 0.5);
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "tests.hpp"
+#include "rt/environment_map.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace igx::rt;
+
+static constexpr f64 pi = 3.14159265358979;
+
+static f64 luminance(const f32 *rgb) {
+	return rgb[0] * 0.2126 + rgb[1] * 0.7152 + rgb[2] * 0.0722;
+}
+
+//Deterministic low discrepancy points, so the result doesn't depend on a seed
+
+static f32 radicalInverse2(u32 i) {
+	i = (i << 16) | (i >> 16);
+	i = ((i & 0x00FF00FFu) << 8) | ((i & 0xFF00FF00u) >> 8);
+	i = ((i & 0x0F0F0F0Fu) << 4) | ((i & 0xF0F0F0F0u) >> 4);
+	i = ((i & 0x33333333u) << 2) | ((i & 0xCCCCCCCCu) >> 2);
+	i = ((i & 0x55555555u) << 1) | ((i & 0xAAAAAAAAu) >> 1);
+	return f32(i >> 8) / f32(1 << 24);
+}
+
+//Samples of the test sky (sun + gradient) binned per cell against its luminance distribution
+//There are only a few samples per dim cell, so most of the total variation is rounding to whole samples
+//Samples right on a cell edge can round into the neighbour, so a few pdf mismatches are allowed
+
+RT_TEST(environmentSampling) {
+
+	static constexpr u32 width = 1024, height = 512, samples = 1 << 22;
+
+	const List<f32> rgb = generateTestSky(width, height);
+
+	EnvironmentMap map;
+	map.build(rgb, width, height);
+
+	const u32 w = map.getWidth(), h = map.getHeight();
+
+	//Expected probability and luminance per cell (pixels are cells here)
+
+	List<f64> expected(usz(w) * h), lum(usz(w) * h);
+	f64 total{}, integral{};
+
+	for (u32 y = 0; y < h; ++y) {
+
+		const f64 psi0 = (f64(y) / h - 0.5) * pi, psi1 = (f64(y + 1) / h - 0.5) * pi;
+		const f64 cosLatitude = std::cos(((y + 0.5) / h - 0.5) * pi);
+
+		for (u32 x = 0; x < w; ++x) {
+
+			const usz i = usz(y) * w + x;
+
+			lum[i] = luminance(rgb.data() + i * 3);
+			expected[i] = lum[i] * cosLatitude;
+			total += expected[i];
+
+			integral += lum[i] * (2 * pi / w) * (std::sin(psi1) - std::sin(psi0));
+		}
+	}
+
+	List<u32> histogram(usz(w) * h);
+	f64 estimate{};
+	u32 mismatches{};
+
+	for (u32 i = 0; i < samples; ++i) {
+
+		f32 pdf;
+		const Vec3f32 dir = map.sample(Vec2f32((f32(i) + 0.5f) / f32(samples), radicalInverse2(i)), pdf);
+
+		if (pdf <= 0)
+			continue;
+
+		if (std::abs(map.pdf(dir) / pdf - 1) > 1e-3f)
+			++mismatches;
+
+		const Vec2f32 uv = equirectUv(dir);
+
+		const u32 x = std::min(u32(std::max(uv.x, 0.f) * f32(w)), w - 1);
+		const u32 y = std::min(u32(std::max(uv.y, 0.f) * f32(h)), h - 1);
+
+		++histogram[usz(y) * w + x];
+		estimate += lum[usz(y) * w + x] / pdf;
+	}
+
+	f64 totalVariation{}, maxCellError{};
+
+	for (usz i = 0; i < expected.size(); ++i) {
+
+		const f64 p = expected[i] / total, q = f64(histogram[i]) / samples;
+		totalVariation += std::abs(p - q) * 0.5;
+
+		if (p * samples >= 1024)
+			maxCellError = std::max(maxCellError, std::abs(q / p - 1));
+	}
+
+	RT_CHECK(totalVariation < 0.03);
+	RT_CHECK(maxCellError < 1e-3);
+	RT_CHECK(f64(mismatches) / samples < 1e-4);
+	RT_CHECK(std::abs(estimate / samples / integral - 1) < 1e-4);
+}
+
+//The solid angle pdf integrates to 1 over the sphere and is 0 where the sky is black
+
+RT_TEST(environmentPdf) {
+
+	static constexpr u32 width = 256, height = 128, steps = 1024;
+
+	List<f32> rgb = generateTestSky(width, height);
+
+	for (u32 x = 0; x < width; ++x)
+		for (u32 c = 0; c < 3; ++c)
+			rgb[(usz(height - 1) * width + x) * 3 + c] = 0;
+
+	EnvironmentMap map;
+	map.build(rgb, width, height);
+
+	f64 integral{};
+
+	for (u32 y = 0; y < steps; ++y) {
+
+		const f64 psi0 = (f64(y) / steps - 0.5) * pi, psi1 = (f64(y + 1) / steps - 0.5) * pi;
+		const f64 solidAngle = (2 * pi / (steps * 2)) * (std::sin(psi1) - std::sin(psi0));
+
+		for (u32 x = 0; x < steps * 2; ++x)
+			integral += map.pdf(equirectDirection(Vec2f32((f32(x) + 0.5f) / f32(steps * 2), (f32(y) + 0.5f) / f32(steps)))) * solidAngle;
+	}
+
+	RT_CHECK_NEAR(integral, 1, 1e-3);
+	RT_CHECK(map.pdf(Vec3f32(0, -1, 0)) == 0);
+	RT_CHECK(map.pdf(Vec3f32(0, 0.8f, 0.6f)) > 0);
+}
\ No newline at end of file
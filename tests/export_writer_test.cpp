@@ -0,0 +1,116 @@
+#include "tests.hpp"
+#include "rt/export_writer.hpp"
+#include "rt/parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace igx::rt;
+
+//Same work as an export; opaque alpha over row bands and a raw write
+
+static bool writeTestExport(List<u8> &data, u32 width, u32 height, const String &path) {
+
+	parallelFor(height, 0, [&](u32 start, u32 end) {
+		for (usz i = usz(start) * width; i < usz(end) * width; ++i)
+			data[i * 4 + 3] = 255;
+	});
+
+	std::ofstream out(std::filesystem::path(path), std::ios::binary);
+	out.write((const c8*) data.data(), std::streamsize(data.size()));
+	return bool(out);
+}
+
+//Time the render thread is blocked by an 8K rgba8 export
+//Synchronous: finalize + write on the calling thread, async: only handing it to the writer
+
+RT_TEST(exportStall) {
+
+	static constexpr u32 width = 7680, height = 4320;
+
+	const String path = tests::outputPath("stall_test.bin");
+
+	List<u8> image(usz(width) * height * 4);
+
+	for (usz i = 0; i < image.size(); ++i)
+		image[i] = u8(i * 31 + (i >> 12));
+
+	f64 syncMs, asyncMs;
+
+	{
+		List<u8> data = image;
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		RT_CHECK(writeTestExport(data, width, height, path));
+		syncMs = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	bool written{};
+
+	{
+		ExportWriter writer;
+		List<u8> data = image;
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		writer.push({
+			path,
+			[data = std::move(data), path]() mutable {
+				return writeTestExport(data, width, height, path);
+			},
+			[&written](const String&, bool success, f64) { written = success; }
+		});
+
+		asyncMs = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		writer.wait();
+	}
+
+	RT_CHECK(written);
+	RT_CHECK(std::filesystem::file_size(path) == image.size());
+	RT_CHECK(asyncMs * 10 < syncMs);
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
+
+//Jobs are written in order; push blocks while the queue is full and the destructor still writes everything
+
+RT_TEST(exportWriterQueue) {
+
+	static constexpr u32 jobs = 16;
+
+	List<u32> order;
+	usz maxPending{};
+
+	{
+		ExportWriter writer(1);
+
+		for (u32 i = 0; i < jobs; ++i) {
+
+			writer.push({
+				std::to_string(i),
+				[i]() { return i % 2 == 0; },
+				[&order, i](const String &path, bool success, f64) {
+					RT_CHECK(path == std::to_string(i) && success == (i % 2 == 0));
+					order.push_back(i);
+				}
+			});
+
+			maxPending = std::max(maxPending, writer.pending());
+		}
+
+		writer.wait();
+		RT_CHECK(writer.pending() == 0);
+		RT_CHECK(order.size() == jobs);
+
+		writer.push({ "last", []() { return true; }, [&order](const String&, bool, f64) { order.push_back(jobs); } });
+	}
+
+	RT_CHECK(maxPending <= 2);
+	RT_CHECK(order.size() == jobs + 1);
+
+	for (u32 i = 0; i < order.size(); ++i)
+		RT_CHECK(order[i] == i);
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "tests.hpp"
+#include "rt/frame_governor.hpp"
+#include "rt/camera_path.hpp"
+#include "rt/sampler.hpp"
+
+using namespace igx::rt;
+
+//What a level really costs; there's a fixed part (recording, presenting) that doesn't scale
+//It isn't the governor's estimate, so it has to correct itself
+
+static f64 simulatedCost(u32 level) {
+	const FrameBudget &budget = getFrameBudget(level);
+	const f64 pixels = f64(budget.resolutionScale) * budget.resolutionScale;
+	return 0.1 + 0.9 * pixels * (0.5 + 0.3 * budget.shadowSamples + 0.2 * budget.cloudSamples);
+}
+
+//Cheaper levels have to be cheaper, both estimated and simulated
+
+RT_TEST(frameBudgetLevels) {
+
+	RT_CHECK(frameBudgetLevels() > 1);
+	RT_CHECK(frameBudgetCost(0) == 1);
+
+	for (u32 i = 1; i < frameBudgetLevels(); ++i)
+		RT_CHECK(frameBudgetCost(i) < frameBudgetCost(i - 1) && simulatedCost(i) < simulatedCost(i - 1));
+
+	RT_CHECK(&getFrameBudget(1000) == &getFrameBudget(frameBudgetLevels() - 1));
+
+	RT_CHECK(budgetSamples(0, 0.25f) == 0);
+	RT_CHECK(budgetSamples(1, 0.25f) == 1);
+	RT_CHECK(budgetSamples(8, 0.5f) == 4);
+}
+
+//Simulated frames; a load that changes every 4 seconds (light, heavy and right at the target) with noise and hitches
+
+RT_TEST(frameGovernor) {
+
+	static constexpr f64 phases[] = { 0.6, 2.0, 1.05, 1.4, 0.8, 1.15 };
+	static constexpr u32 phaseFrames = 60 * 4, frames = 60 * 120;
+
+	const FrameGovernorInfo info;
+	FrameGovernor governor(info);
+
+	u32 state = hashUint(1);
+
+	auto random01 = [&]() {
+		state = hashUint(state);
+		return f64(state & 0xFFFFFF) / 0x1000000;
+	};
+
+	List<f64> frameMs;
+	frameMs.reserve(frames);
+
+	u32 changes{}, raisesUndone{}, raisedAt{}, overTarget{};
+	bool hasRaised{};
+	f64 resolutionScale{};
+
+	for (u32 i = 0; i < frames; ++i) {
+
+		const u32 level = governor.getLevel();
+		const f64 load = phases[(i / phaseFrames) % _countof(phases)];
+
+		f64 ms = info.targetMs * load * simulatedCost(level) * (0.9 + 0.2 * random01());
+
+		if (random01() < 0.01)
+			ms *= 4;
+
+		frameMs.push_back(ms);
+		overTarget += ms > info.targetMs;
+		resolutionScale += governor.getBudget().resolutionScale;
+
+		if (!governor.update(ms))
+			continue;
+
+		++changes;
+
+		//Undone; dropped again within a second
+
+		if (governor.getLevel() < level) {
+			raisedAt = i;
+			hasRaised = true;
+		}
+
+		else {
+			raisesUndone += hasRaised && i - raisedAt <= 60;
+			hasRaised = false;
+		}
+	}
+
+	const FrameTimeStats stats = frameTimeStats(std::move(frameMs));
+
+	RT_CHECK(changes < 100 && raisesUndone <= 2);
+	RT_CHECK(f64(overTarget) / frames < 0.15);
+	RT_CHECK(stats.p50Ms < info.targetMs && stats.p95Ms < info.targetMs * 1.25);
+	RT_CHECK(resolutionScale / frames > 0.85);
+}
+
+//A light load never drops; a constant heavy one drops until it fits and stays there
+
+RT_TEST(frameGovernorSteady) {
+
+	static constexpr f64 targetMs = 1000.0 / 60;
+
+	FrameGovernor light, heavy;
+
+	u32 lightChanges{}, lastHeavyChange{};
+
+	for (u32 i = 0; i < 60 * 30; ++i) {
+
+		lightChanges += light.update(targetMs * 0.7);
+
+		if (heavy.update(targetMs * 1.8 * simulatedCost(heavy.getLevel())))
+			lastHeavyChange = i;
+	}
+
+	RT_CHECK(lightChanges == 0 && light.getLevel() == 0);
+	RT_CHECK(heavy.getLevel() > 0 && lastHeavyChange < 60 * 5);
+	RT_CHECK(1.8 * simulatedCost(heavy.getLevel()) < 1.1);
+}
\ No newline at end of file
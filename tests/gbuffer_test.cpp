@@ -0,0 +1,83 @@
+#include "tests.hpp"
+#include "rt/gbuffer.hpp"
+#include "rt/sampler.hpp"
+#include <algorithm>
+
+using namespace igx::rt;
+
+static f32 random01(u32 &state) {
+	state = hashUint(state);
+	return f32(state & 0xFFFFFF) / 0x1000000;
+}
+
+//Round trip of random normals and uvs; normals are off by at most the snorm16 step (~3e-5 per axis) and uvs by half a half ulp
+
+RT_TEST(gBufferAccuracy) {
+
+	static constexpr u32 samples = 1 << 18;
+
+	u32 state = 1;
+	f64 maxNormalError{}, avgNormalError{}, maxUvError{};
+
+	for (u32 i = 0; i < samples; ++i) {
+
+		//Uniform direction on the sphere
+
+		const f32 z = random01(state) * 2 - 1, phi = random01(state) * 6.2831853f, rad = std::sqrt(1 - z * z);
+
+		const GBufferTexel texel{
+			random01(state) * 1000,
+			Vec3f32(rad * std::cos(phi), rad * std::sin(phi), z),
+			Vec2f32(random01(state), random01(state)),
+			i
+		};
+
+		const GBufferTexel dec = decodeGBuffer(encodeGBuffer(texel));
+
+		//Depth and object are stored as is
+
+		RT_CHECK(dec.hitT == texel.hitT);
+		RT_CHECK(dec.object == texel.object);
+
+		//Angle from the cross product; acos of a float dot can't resolve angles this small
+
+		const f64
+			cx = f64(texel.normal.y) * dec.normal.z - f64(texel.normal.z) * dec.normal.y,
+			cy = f64(texel.normal.z) * dec.normal.x - f64(texel.normal.x) * dec.normal.z,
+			cz = f64(texel.normal.x) * dec.normal.y - f64(texel.normal.y) * dec.normal.x;
+
+		const f64 normalError = std::asin(std::min(std::sqrt(cx * cx + cy * cy + cz * cz), 1.0));
+
+		maxNormalError = std::max(maxNormalError, normalError);
+		avgNormalError += normalError;
+
+		maxUvError = std::max({
+			maxUvError, f64(std::abs(dec.uv.x - texel.uv.x)), f64(std::abs(dec.uv.y - texel.uv.y))
+		});
+	}
+
+	avgNormalError /= samples;
+
+	RT_CHECK(maxNormalError < 1e-4);
+	RT_CHECK(avgNormalError < 3e-5);
+	RT_CHECK(maxUvError <= 1.0 / 4096);
+}
+
+//Axes and the octahedron's folds are where the encoding is most likely to flip a sign
+
+RT_TEST(gBufferNormalEdges) {
+
+	static const Vec3f32 normals[] = {
+		{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+		{ 0.70710678f, 0, -0.70710678f }, { 0, -0.70710678f, -0.70710678f }, { -0.70710678f, 0.70710678f, 0 }
+	};
+
+	for (const Vec3f32 &n : normals) {
+
+		const Vec3f32 dec = decodeOctNormal(encodeOctNormal(n));
+
+		RT_CHECK_NEAR(dec.x, n.x, 1e-4);
+		RT_CHECK_NEAR(dec.y, n.y, 1e-4);
+		RT_CHECK_NEAR(dec.z, n.z, 1e-4);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "tests.hpp"
+#include "rt/hdr_export.hpp"
+#include "rt/half.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+using namespace igx::rt;
+
+//HDR range with subnormals, overflow and every rounding case
+
+static List<f32> hdrImage(u32 width, u32 height) {
+
+	List<f32> image(usz(width) * height * 4);
+
+	for (usz i = 0; i < image.size(); ++i) {
+		const u32 x = u32(i * 2654435761u);
+		image[i] = std::ldexp(f32(x & 0xFFFFFF) / 0x1000000, i32(x >> 26) - 30) * (x & 0x1000000 ? -1 : 1);
+	}
+
+	return image;
+}
+
+//The F16C path and the threaded split have to match the scalar toHalf bit for bit
+
+RT_TEST(halfConversion) {
+
+	static constexpr u32 width = 1920, height = 1080;
+
+	List<f32> image = hdrImage(width, height);
+
+	image[0] = 65520;		//Rounds to inf
+	image[1] = 65519;		//Rounds to the max
+	image[2] = std::numeric_limits<f32>::infinity();
+	image[3] = -0.f;
+
+	List<u16> reference(image.size()), simd(image.size()), threaded(image.size());
+
+	for (usz i = 0; i < image.size(); ++i)
+		reference[i] = toHalf(image[i]);
+
+	convertToHalf(image.data(), simd.data(), image.size());
+	convertToHalf(image.data(), threaded.data(), width, height);
+
+	usz mismatches{};
+
+	for (usz i = 0; i < image.size(); ++i)
+		mismatches += usz(reference[i] != simd[i]) + usz(reference[i] != threaded[i]);
+
+	RT_CHECK(mismatches == 0);
+	RT_CHECK(reference[0] == 0x7C00 && reference[1] == 0x7BFF && reference[2] == 0x7C00 && reference[3] == 0x8000);
+}
+
+//Only if the cpu has F16C; best of a few runs over a 4K image
+
+RT_TEST(halfConversionSpeed) {
+
+	static constexpr u32 width = 3840, height = 2160, tries = 4;
+
+	if (!hasHalfConversion())
+		return;
+
+	const List<f32> image = hdrImage(width, height);
+	List<u16> out(image.size());
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	f64 scalarMs{}, simdMs{};
+
+	for (u32 i = 0; i < tries; ++i) {
+
+		auto start = Clock::now();
+
+		for (usz j = 0; j < image.size(); ++j)
+			out[j] = toHalf(image[j]);
+
+		const f64 scalar = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+		start = Clock::now();
+		convertToHalf(image.data(), out.data(), image.size());
+
+		const f64 simd = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+		scalarMs = i ? std::min(scalarMs, scalar) : scalar;
+		simdMs = i ? std::min(simdMs, simd) : simd;
+	}
+
+	RT_CHECK(simdMs * 2 < scalarMs);
+}
\ No newline at end of file
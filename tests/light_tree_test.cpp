@@ -0,0 +1,170 @@
+#include "tests.hpp"
+#include "rt/light_tree.hpp"
+#include "rt/sampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace igx::rt;
+
+static f32 random01(u32 &state) {
+	state = hashUint(state);
+	return f32(state & 0xFFFFFF) / 0x1000000;
+}
+
+static f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//Same falloff as light.glsl; n faces away from the light like in the shaders
+
+static f32 contribution(const LightTreeInput &light, const Vec3f32 &pos, const Vec3f32 &n) {
+
+	const Vec3f32 d(pos.x - light.pos.x, pos.y - light.pos.y, pos.z - light.pos.z);
+	const f32 dist = std::sqrt(dot(d, d));
+
+	if (dist >= light.range)
+		return 0;
+
+	const f32 NdotL = std::max(dot(n, d) / dist, 0.f);
+	const f32 t = 1 - dist / light.range, falloff = t * t * (3 - 2 * t);
+
+	return light.power * NdotL * falloff / std::max(dist * dist, 0.01f);
+}
+
+//Venue of 200x200m, lights hanging 3-8m above the floor
+
+static List<LightTreeInput> venue(u32 lightCount, u32 &state) {
+
+	List<LightTreeInput> lights(lightCount);
+
+	for (LightTreeInput &light : lights)
+		light = LightTreeInput{
+			Vec3f32(random01(state) * 200 - 100, 3 + random01(state) * 5, random01(state) * 200 - 100), 4 + random01(state) * 20,
+			Vec3f32(0, 0, 1), -1,
+			std::pow(10.f, random01(state) * 2 - 1)
+		};
+
+	return lights;
+}
+
+//Picks have to be unbiased; the mean of contribution / pdf converges to the sum over all lights
+
+RT_TEST(lightTreeUnbiased) {
+
+	u32 state = 1;
+
+	const List<LightTreeInput> lights = venue(256, state);
+
+	LightTree tree;
+	tree.build(lights);
+
+	const Vec3f32 n(0, -1, 0);
+	u32 tested{};
+
+	for (u32 j = 0; j < 16; ++j) {
+
+		const Vec3f32 pos(random01(state) * 200 - 100, 0, random01(state) * 200 - 100);
+
+		f64 exact{};
+
+		for (const LightTreeInput &light : lights)
+			exact += contribution(light, pos, n);
+
+		if (exact <= 0)
+			continue;
+
+		static constexpr u32 samples = 1 << 16;
+
+		f64 estimate{};
+
+		for (u32 i = 0; i < samples; ++i) {
+
+			f32 pdf;
+			const u32 light = tree.pick(pos, n, (f32(i) + 0.5f) / samples, pdf);
+
+			if (light != LightTree::noLight)
+				estimate += contribution(lights[light], pos, n) / pdf;
+		}
+
+		RT_CHECK_NEAR(estimate / samples / exact, 1, 0.01);
+		++tested;
+	}
+
+	RT_CHECK(tested > 0);
+}
+
+//Relative RMSE of direct lighting at random floor points; light picked uniformly vs through the tree, with 1 to 64 samples
+
+RT_TEST(lightTreeVariance) {
+
+	static constexpr u32 lightCount = 4096, points = 64, trials = 8;
+	static constexpr usz steps = 7;
+
+	u32 state = 2;
+
+	const List<LightTreeInput> lights = venue(lightCount, state);
+
+	LightTree tree;
+	tree.build(lights);
+
+	f64 uniformError[steps]{}, treeError[steps]{};
+
+	const Vec3f32 n(0, -1, 0);
+	u32 litPoints{};
+
+	for (u32 j = 0; j < points; ++j) {
+
+		const Vec3f32 pos(random01(state) * 200 - 100, 0, random01(state) * 200 - 100);
+
+		f64 exact{};
+
+		for (const LightTreeInput &light : lights)
+			exact += contribution(light, pos, n);
+
+		if (exact <= 0)
+			continue;
+
+		++litPoints;
+
+		for (usz step = 0; step < steps; ++step) {
+
+			const u32 samples = 1u << step;
+
+			for (u32 k = 0; k < trials; ++k) {
+
+				f64 uniform{}, picked{};
+
+				for (u32 i = 0; i < samples; ++i) {
+
+					const u32 light = std::min(u32(random01(state) * f32(lightCount)), lightCount - 1);
+					uniform += f64(contribution(lights[light], pos, n)) * lightCount;
+
+					f32 pdf;
+					const u32 treeLight = tree.pick(pos, n, random01(state), pdf);
+
+					if (treeLight != LightTree::noLight)
+						picked += contribution(lights[treeLight], pos, n) / pdf;
+				}
+
+				uniformError[step] += std::pow(uniform / samples / exact - 1, 2) / trials;
+				treeError[step] += std::pow(picked / samples / exact - 1, 2) / trials;
+			}
+		}
+	}
+
+	RT_CHECK(litPoints > points / 2);
+
+	for (usz step = 0; step < steps; ++step) {
+		uniformError[step] = std::sqrt(uniformError[step] / litPoints);
+		treeError[step] = std::sqrt(treeError[step] / litPoints);
+	}
+
+	//Uniform picks mostly miss and sometimes hit something close by, so its error is all over the place
+	//The tree's falls off like 1 / sqrt(samples) and is well below from 8 samples on
+
+	for (usz step = 3; step < steps; ++step)
+		RT_CHECK(treeError[step] * 2 < uniformError[step]);
+
+	RT_CHECK(treeError[6] < 0.35);
+	RT_CHECK(treeError[6] * 4 < treeError[0]);
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "tests.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+//CPU tests of the library (references, mirrors of the shaders and measurements with thresholds)
+//Usage: rtigx_tests [test...] [--update]; every test if none are named, --update rewrites the stored references
+
+#ifndef RTIGX_TEST_DATA
+	#define RTIGX_TEST_DATA "./tests/data"
+#endif
+
+#ifndef RTIGX_TEST_OUTPUT
+	#define RTIGX_TEST_OUTPUT "./output/tests"
+#endif
+
+namespace igx::rt::tests {
+
+	struct RegisteredTest {
+		const c8 *name;
+		TestFunction function;
+	};
+
+	static List<RegisteredTest> &registeredTests() {
+		static List<RegisteredTest> tests;
+		return tests;
+	}
+
+	static u32 failures{};
+	static bool isUpdating{};
+
+	Test::Test(const c8 *name, TestFunction function) {
+		registeredTests().push_back({ name, function });
+	}
+
+	void fail(const c8 *file, int line, const String &what) {
+		std::printf("  %s(%i): %s\n", file, line, what.c_str());
+		++failures;
+	}
+
+	String dataPath(const String &file) {
+		return String(RTIGX_TEST_DATA) + "/" + file;
+	}
+
+	String outputPath(const String &file) {
+
+		const std::filesystem::path path = std::filesystem::path(RTIGX_TEST_OUTPUT) / file;
+
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		return path.string();
+	}
+
+	bool shouldUpdateReferences() {
+		return isUpdating;
+	}
+
+	//Bottom to top and little endian (negative scale), like the exports
+
+	bool readReferenceImage(const String &path, ReferenceImage &image) {
+
+		std::ifstream in(std::filesystem::path(path), std::ios::binary);
+
+		String magic;
+		f64 scale{};
+
+		if (!(in >> magic >> image.width >> image.height >> scale) || magic != "PF" || scale >= 0)
+			return false;
+
+		in.get();
+
+		const usz row = usz(image.width) * 3;
+		image.rgb.resize(row * image.height);
+
+		for (u32 y = image.height; y > 0; --y)
+			if (!in.read((c8*) (image.rgb.data() + row * (y - 1)), row * sizeof(f32)))
+				return false;
+
+		return true;
+	}
+
+	bool writeReferenceImage(const String &path, const ReferenceImage &image) {
+
+		std::ofstream out(std::filesystem::path(path), std::ios::binary);
+
+		if (!out)
+			return false;
+
+		out << "PF\n" << image.width << " " << image.height << "\n-1.0\n";
+
+		const usz row = usz(image.width) * 3;
+
+		for (u32 y = image.height; y > 0; --y)
+			out.write((const c8*) (image.rgb.data() + row * (y - 1)), row * sizeof(f32));
+
+		return bool(out);
+	}
+
+	f64 compareReferenceImage(const String &file, const ReferenceImage &image) {
+
+		if (isUpdating) {
+
+			if (!writeReferenceImage(dataPath(file), image))
+				return -1;
+
+			std::printf("  Updated %s\n", dataPath(file).c_str());
+		}
+
+		ReferenceImage reference;
+
+		if (
+			!readReferenceImage(dataPath(file), reference) || 
+			reference.width != image.width || reference.height != image.height
+		)
+			return -1;
+
+		f64 sum{};
+
+		for (usz i = 0, j = image.rgb.size(); i < j; ++i) {
+			const f64 d = f64(image.rgb[i]) - reference.rgb[i];
+			sum += d * d;
+		}
+
+		return image.rgb.empty() ? 0 : std::sqrt(sum / image.rgb.size());
+	}
+
+}
+
+using namespace igx::rt::tests;
+
+int main(int argc, char *argv[]) {
+
+	List<String> selected;
+
+	for (int i = 1; i < argc; ++i)
+		if (!std::strcmp(argv[i], "--update"))
+			isUpdating = true;
+
+		else selected.push_back(argv[i]);
+
+	u32 ran{}, failed{};
+
+	for (const RegisteredTest &test : registeredTests()) {
+
+		if (!selected.empty() && std::find(selected.begin(), selected.end(), test.name) == selected.end())
+			continue;
+
+		const u32 previous = failures;
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		std::printf("%s\n", test.name);
+		test.function();
+
+		const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		const bool hasFailed = failures != previous;
+
+		std::printf("%s %s (%.1f ms)\n", hasFailed ? "[FAIL]" : "[ OK ]", test.name, ms);
+
+		++ran;
+		failed += hasFailed;
+	}
+
+	if (!ran) {
+		std::printf("No tests matched\n");
+		return 1;
+	}
+
+	std::printf("%u/%u tests passed\n", ran - failed, ran);
+	return failed ? 1 : 0;
+}
\ No newline at end of file
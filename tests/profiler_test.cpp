@@ -0,0 +1,76 @@
+#include "tests.hpp"
+#include "rt/profiler.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace igx::rt;
+
+//The history rolls over at its capacity; summaries are per name and track, in order of first appearance
+
+RT_TEST(profilerSummary) {
+
+	Profiler profiler(4);
+
+	const Profiler::Clock::time_point now = Profiler::Clock::now();
+
+	profiler.add("Lost", Profiler::CPU, now, 100);
+	profiler.add("Update", Profiler::CPU, now, 1);
+	profiler.add("Shadows", Profiler::GPU, now, 4);
+	profiler.add("Update", Profiler::CPU, now, 3);
+	profiler.add("Update", Profiler::GPU, now, 2);
+
+	RT_CHECK(profiler.size() == 4);
+
+	const List<Profiler::Summary> summaries = profiler.summarize();
+
+	RT_CHECK(summaries.size() == 3);
+	RT_CHECK(summaries[0].name == "Update" && summaries[0].track == Profiler::CPU && summaries[0].count == 2);
+	RT_CHECK_NEAR(summaries[0].averageMs, 2, 1e-9);
+	RT_CHECK_NEAR(summaries[0].maxMs, 3, 1e-9);
+	RT_CHECK_NEAR(summaries[0].lastMs, 3, 1e-9);
+	RT_CHECK(summaries[1].name == "Shadows" && summaries[2].name == "Update" && summaries[2].track == Profiler::GPU);
+
+	RT_CHECK(profiler.report(Profiler::GPU) == "Shadows: 4.000 / 4.000\nUpdate: 2.000 / 2.000\n");
+
+	profiler.clear();
+	RT_CHECK(profiler.size() == 0 && profiler.summarize().empty());
+}
+
+//Cost of a scope and of dumping a full history; names are escaped in the trace
+
+RT_TEST(profilerOverhead) {
+
+	static constexpr u32 scopes = 1000000;
+
+	const String path = tests::outputPath("trace_test.json");
+
+	Profiler profiler;
+	const String name = "Update";
+
+	auto start = Profiler::Clock::now();
+
+	for (u32 i = 0; i < scopes; ++i)
+		auto scope = profiler.scope(name);
+
+	const f64 scopeNs = std::chrono::duration<f64, std::nano>(Profiler::Clock::now() - start).count() / scopes;
+
+	profiler.add("A \"quoted\" pass", Profiler::GPU, Profiler::Clock::now(), 1);
+
+	start = Profiler::Clock::now();
+	RT_CHECK(profiler.writeChromeTrace(path));
+	const f64 traceMs = std::chrono::duration<f64, std::milli>(Profiler::Clock::now() - start).count();
+
+	std::ifstream in{ std::filesystem::path(path) };
+	const String trace{ std::istreambuf_iterator<c8>(in), std::istreambuf_iterator<c8>() };
+
+	RT_CHECK(scopeNs < 1000);
+	RT_CHECK(traceMs < 100);
+	RT_CHECK(trace.find("\"A \\\"quoted\\\" pass\"") != String::npos);
+	RT_CHECK(trace.size() > 8192 * 64 && trace.substr(trace.size() - 4) == "\n]}\n");
+
+	in.close();
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "tests.hpp"
+#include "rt/sampler.hpp"
+#include <cmath>
+
+using namespace igx::rt;
+
+static f32 random01(u32 &state) {
+	state = hashUint(state);
+	return f32(state & 0xFFFFFF) / 0x1000000;
+}
+
+static f32 fract(f32 v) {
+	return v - std::floor(v);
+}
+
+//rand(vec2) from rand_util.glsl; the hashed jitter the shaders used before (rand(loc + seed.randomXY))
+
+static f32 rand1(f32 x, f32 y) {
+	return fract(std::sin(x * 12.9898f + y * 78.233f) * 43758.5453f);
+}
+
+static Vec2f32 rand2(f32 x, f32 y) {
+	return Vec2f32(rand1(x, y), rand1(x * 1103515245.f + 12345, y * 1103515245.f + 12345));
+}
+
+//Half plane edge through the pixel, on top of a smooth lobe
+
+struct PixelIntegrand {
+
+	f32 nx, ny, d, cx, cy, sharpness;
+
+	f64 operator()(f32 u, f32 v) const {
+		const f64 edge = u * nx + v * ny < d ? 1 : 0.25;
+		return edge * std::exp(-((u - cx) * (u - cx) + (v - cy) * (v - cy)) * sharpness);
+	}
+};
+
+//Every power of two prefix of a scrambled sequence is stratified; 16 samples put one in every 4x4 cell
+
+RT_TEST(sobolStratification) {
+
+	for (u32 seed = 0; seed < 8; ++seed)
+		for (u32 dimension = 0; dimension < 3; ++dimension) {
+
+			u32 cells[16]{};
+
+			for (u32 i = 0; i < 16; ++i) {
+				const Vec2f32 s = sobolOwen2D(i, dimension, hashUint(seed));
+				++cells[u32(s.x * 4) + u32(s.y * 4) * 4];
+			}
+
+			for (u32 cell : cells)
+				RT_CHECK(cell == 1);
+		}
+}
+
+//The rotation's blue noise is tiled and shifted per dimension
+
+RT_TEST(blueNoiseTexel) {
+
+	const Vec2u32 size(128, 128);
+
+	RT_CHECK(blueNoiseTexel(Vec2u32(3, 5), 0, size).x == 3 && blueNoiseTexel(Vec2u32(3, 5), 0, size).y == 5);
+	RT_CHECK(blueNoiseTexel(Vec2u32(130, 256), 0, size).x == 2 && blueNoiseTexel(Vec2u32(130, 256), 0, size).y == 0);
+	RT_CHECK(blueNoiseTexel(Vec2u32(0, 0), 1, size).x == 47 && blueNoiseTexel(Vec2u32(0, 0), 1, size).y == 17);
+}
+
+//RMSE of pixel integrals (edges and smooth lobes) against a dense reference
+//Sobol converges faster than the hashed jitter, so it has to pull ahead as samples go up
+
+RT_TEST(samplerError) {
+
+	static constexpr u32 maxSamples = 1024, pixels = 256, referenceRes = 256;
+	static constexpr usz steps = 11;
+
+	f64 previousRmse[steps]{}, sobolRmse[steps]{};
+
+	const u32 seed = hashUint(0);
+	u32 state = 1;
+
+	for (u32 j = 0; j < pixels; ++j) {
+
+		const f32 angle = random01(state) * 6.2831853f;
+
+		const PixelIntegrand f{
+			std::cos(angle), std::sin(angle), random01(state) - 0.5f + 0.5f * (std::cos(angle) + std::sin(angle)),
+			random01(state), random01(state), 0.5f + random01(state) * 7.5f
+		};
+
+		f64 reference{};
+
+		for (u32 y = 0; y < referenceRes; ++y)
+			for (u32 x = 0; x < referenceRes; ++x)
+				reference += f((f32(x) + 0.5f) / referenceRes, (f32(y) + 0.5f) / referenceRes);
+
+		reference /= referenceRes * referenceRes;
+
+		const Vec2u32 loc(j % 16, j / 16);
+		const Vec2f32 rotation = hashedRotation(loc, SAMPLE_DIMENSION_PRIMARY);
+		const Vec2f32 cpuOffset(random01(state) * 2000 - 1000, random01(state) * 2000 - 1000);
+
+		f64 previous{}, sobol{};
+		usz step = 0;
+
+		for (u32 i = 1; i <= maxSamples; ++i) {
+
+			const Vec2f32 random = rand2(cpuOffset.x + f32(i), cpuOffset.y + f32(i));
+			const Vec2f32 legacy = rand2(f32(loc.x) + random.x, f32(loc.y) + random.y);
+			const Vec2f32 current = sample2D(rotation, i - 1, SAMPLE_DIMENSION_PRIMARY, seed);
+
+			previous += f(legacy.x, legacy.y);
+			sobol += f(current.x, current.y);
+
+			if (i != 1u << step)
+				continue;
+
+			const f64 previousError = previous / i - reference, sobolError = sobol / i - reference;
+
+			previousRmse[step] += previousError * previousError;
+			sobolRmse[step] += sobolError * sobolError;
+			++step;
+		}
+	}
+
+	for (usz i = 0; i < steps; ++i) {
+		previousRmse[i] = std::sqrt(previousRmse[i] / pixels);
+		sobolRmse[i] = std::sqrt(sobolRmse[i] / pixels);
+	}
+
+	//From 16 samples on it's at least twice as accurate, and at 1024 it's past 5x
+	//Hashed jitter converges as 1 / sqrt(n); 64x the samples should be more than 8x less error
+
+	for (usz i = 4; i < steps; ++i)
+		RT_CHECK(sobolRmse[i] * 2 < previousRmse[i]);
+
+	RT_CHECK(sobolRmse[10] * 5 < previousRmse[10]);
+	RT_CHECK(sobolRmse[10] * 16 < sobolRmse[4]);
+}
\ No newline at end of file
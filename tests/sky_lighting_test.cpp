@@ -0,0 +1,162 @@
+#include "tests.hpp"
+#include "rt/sky_lighting.hpp"
+#include "rt/environment_map.hpp"
+#include <cmath>
+
+using namespace igx::rt;
+
+static constexpr f32 pi = 3.14159265f;
+static constexpr u32 width = 512, height = 256, directions = 64;
+
+static f32 dot(const Vec3f32 &a, const Vec3f32 &b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static f32 luminance(const Vec3f32 &c) {
+	return c.x * 0.2126f + c.y * 0.7152f + c.z * 0.0722f;
+}
+
+static f32 ggx(f32 NdotH, f32 a2) {
+	const f32 denom = NdotH * NdotH * (a2 - 1) + 1;
+	return a2 / (pi * denom * denom);
+}
+
+//Fibonacci sphere
+
+static List<Vec3f32> sphereDirections() {
+
+	List<Vec3f32> dirs(directions);
+
+	for (u32 i = 0; i < directions; ++i) {
+		const f32 y = 1 - 2 * (f32(i) + 0.5f) / f32(directions), r = std::sqrt(1 - y * y);
+		const f32 phi = f32(i) * 2.39996323f;
+		dirs[i] = Vec3f32(std::cos(phi) * r, y, std::sin(phi) * r);
+	}
+
+	return dirs;
+}
+
+//Brute force over every pixel of the test sky
+
+static Vec3f32 referenceIrradiance(const List<f32> &rgb, const Vec3f32 &n) {
+
+	f64 sum[3]{};
+
+	for (u32 y = 0; y < height; ++y) {
+
+		const f32 v = (f32(y) + 0.5f) / f32(height);
+		const f64 solidAngle = (2 * f64(pi) / width) * (f64(pi) / height) * std::cos((v - 0.5f) * pi);
+
+		for (u32 x = 0; x < width; ++x) {
+
+			const f32 NdotL = dot(n, equirectDirection(Vec2f32((f32(x) + 0.5f) / f32(width), v)));
+
+			if (NdotL <= 0)
+				continue;
+
+			for (u32 c = 0; c < 3; ++c)
+				sum[c] += rgb[(usz(y) * width + x) * 3 + c] * NdotL * solidAngle;
+		}
+	}
+
+	return Vec3f32(f32(sum[0] / pi), f32(sum[1] / pi), f32(sum[2] / pi));
+}
+
+static Vec3f32 referencePrefilter(const List<f32> &rgb, const Vec3f32 &n, f32 roughness) {
+
+	const f32 alpha = roughness * roughness, a2 = alpha * alpha;
+
+	f64 sum[3]{}, weight{};
+
+	for (u32 y = 0; y < height; ++y) {
+
+		const f32 v = (f32(y) + 0.5f) / f32(height);
+		const f64 solidAngle = std::cos((v - 0.5f) * pi);
+
+		for (u32 x = 0; x < width; ++x) {
+
+			const Vec3f32 l = equirectDirection(Vec2f32((f32(x) + 0.5f) / f32(width), v));
+			const f32 NdotL = dot(n, l);
+
+			if (NdotL <= 0)
+				continue;
+
+			const f32 NdotH = dot(n, (n + l).normalize());
+			const f64 w = f64(ggx(NdotH, a2)) * NdotL * solidAngle;
+
+			for (u32 c = 0; c < 3; ++c)
+				sum[c] += rgb[(usz(y) * width + x) * 3 + c] * w;
+
+			weight += w;
+		}
+	}
+
+	return Vec3f32(f32(sum[0] / weight), f32(sum[1] / weight), f32(sum[2] / weight));
+}
+
+//Rms error over directions relative to the rms reference, so dark directions don't dominate
+
+template<typename Lookup, typename Reference>
+static f64 relativeError(const List<Vec3f32> &dirs, Lookup lookup, Reference reference) {
+
+	f64 error{}, sum{};
+
+	for (const Vec3f32 &n : dirs) {
+		const f32 ref = luminance(reference(n));
+		error += std::pow(luminance(lookup(n)) - ref, 2);
+		sum += f64(ref) * ref;
+	}
+
+	return std::sqrt(error / sum);
+}
+
+//SH9 can't represent the sun, so it's mostly checked without it
+
+RT_TEST(skyIrradiance) {
+
+	const List<Vec3f32> dirs = sphereDirections();
+
+	for (u32 k = 0; k < 2; ++k) {
+
+		const List<f32> rgb = generateTestSky(width, height, k == 0);
+
+		SkyLighting sky;
+		sky.build(rgb, width, height);
+
+		const f64 error = relativeError(
+			dirs,
+			[&](const Vec3f32 &n) { return sky.irradiance(n); },
+			[&](const Vec3f32 &n) { return referenceIrradiance(rgb, n); }
+		);
+
+		RT_CHECK(error < (k ? 0.01 : 0.15));
+	}
+}
+
+//Prefiltering only takes a few samples, so the sun shows up as noise in the rough levels
+
+RT_TEST(skyPrefilter) {
+
+	const List<Vec3f32> dirs = sphereDirections();
+
+	for (u32 k = 0; k < 2; ++k) {
+
+		const List<f32> rgb = generateTestSky(width, height, k == 0);
+
+		SkyLighting sky;
+		sky.build(rgb, width, height);
+
+		for (u32 i = 1; i < SkyLighting::levels; ++i) {
+
+			const f32 roughness = f32(i) / f32(SkyLighting::levels - 1);
+
+			const f64 error = relativeError(
+				dirs,
+				[&](const Vec3f32 &n) { return sky.prefiltered(i, n); },
+				[&](const Vec3f32 &n) { return referencePrefilter(rgb, n, roughness); }
+			);
+
+			RT_CHECK(error < (k ? 0.03 : 0.25));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+#include "types/types.hpp"
+#include <cmath>
+#include <string>
+
+#define RT_TEST(name)																\
+	static void name##Test();														\
+	static const igx::rt::tests::Test name##Registration(#name, &name##Test);		\
+	static void name##Test()
+
+#define RT_CHECK(...)																\
+	do {																			\
+		if (!(__VA_ARGS__))															\
+			igx::rt::tests::fail(__FILE__, __LINE__, #__VA_ARGS__);				\
+	} while(false)
+
+#define RT_CHECK_NEAR(a, b, epsilon)												\
+	do {																			\
+		const f64 rtCheckA = f64(a), rtCheckB = f64(b);								\
+		if (!(std::abs(rtCheckA - rtCheckB) <= (epsilon)))							\
+			igx::rt::tests::fail(													\
+				__FILE__, __LINE__,													\
+				String(#a " ~ " #b " (") + std::to_string(rtCheckA) + " vs " + std::to_string(rtCheckB) + ")"	\
+			);																		\
+	} while(false)
+
+namespace igx::rt::tests {
+
+	//Every test registers itself; a failed check is logged and the test keeps going, so one run shows every failure
+
+	using TestFunction = void(*)();
+
+	struct Test {
+		Test(const c8 *name, TestFunction function);
+	};
+
+	void fail(const c8 *file, int line, const String &what);
+
+	//Checked in references (tests/data) and scratch files (in the build directory)
+
+	String dataPath(const String &file);
+	String outputPath(const String &file);
+
+	//rtigx_tests --update writes the references instead of comparing against them
+
+	bool shouldUpdateReferences();
+
+	//Row major rgb32f, stored as pfm
+
+	struct ReferenceImage {
+		u32 width{}, height{};
+		List<f32> rgb;
+	};
+
+	bool readReferenceImage(const String &path, ReferenceImage &image);
+	bool writeReferenceImage(const String &path, const ReferenceImage &image);
+
+	//Root mean square difference against tests/data/<file>; -1 if it's missing or the size differs
+	f64 compareReferenceImage(const String &file, const ReferenceImage &image);
+
+}
\ No newline at end of file
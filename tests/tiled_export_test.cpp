@@ -0,0 +1,158 @@
+#include "tests.hpp"
+#include "rt/tiled_export.hpp"
+#include "rt/export_writer.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+using namespace igx::rt;
+
+static u8 testValue(u32 x, u32 y, u32 c) {
+	return u8(x * 7 + y * 13 + c * 101);
+}
+
+//Tiles cover the image exactly once; edge tiles are cropped
+
+RT_TEST(exportTilePlan) {
+
+	const Vec2u32 size(1000, 700), tileSize(256, 256);
+	const List<ExportTile> tiles = planExportTiles(size, tileSize);
+
+	RT_CHECK(tiles.size() == 4 * 3);
+
+	List<u8> covered(usz(size.x) * size.y);
+
+	for (const ExportTile &tile : tiles)
+		for (u32 y = 0; y < tile.size.y; ++y)
+			for (u32 x = 0; x < tile.size.x; ++x)
+				++covered[usz(tile.offset.y + y) * size.x + tile.offset.x + x];
+
+	for (u8 count : covered)
+		RT_CHECK(count == 1);
+
+	RT_CHECK(tiles.back().size.x == 1000 - 768 && tiles.back().size.y == 700 - 512);
+}
+
+//CPU side of a tiled export: readback copies of each tile are handed to the export writer, which crops and streams them into a PPM
+//Only the tiles in the queue, the one being written and the one being pushed can be alive at once
+
+RT_TEST(tiledExport) {
+
+	static constexpr u32 width = 2000, height = 1500, tileSize = 512;
+
+	const String path = tests::outputPath("tiled_test.ppm");
+
+	const List<ExportTile> tiles = planExportTiles(Vec2u32(width, height), Vec2u32(tileSize, tileSize));
+	const usz tileBytes = usz(tileSize) * tileSize * 4;
+
+	std::atomic<usz> alive{}, peak{};
+	std::atomic<u32> failures{};
+
+	{
+		auto file = std::make_shared<TiledImageFile>(path, width, height, false);
+		RT_CHECK(file->isValid());
+
+		ExportWriter writer;
+
+		//Written in reverse, since the file is sized up front
+
+		for (usz i = tiles.size(); i > 0; --i) {
+
+			const ExportTile tile = tiles[i - 1];
+
+			List<u8> data(tileBytes);
+
+			for (u32 y = 0; y < tile.size.y; ++y)
+				for (u32 x = 0; x < tile.size.x; ++x)
+					for (u32 c = 0; c < 4; ++c)
+						data[(usz(y) * tileSize + x) * 4 + c] = testValue(tile.offset.x + x, tile.offset.y + y, c);
+
+			const usz now = alive += tileBytes;
+			usz prev = peak;
+
+			while (prev < now && !peak.compare_exchange_weak(prev, now)) {}
+
+			writer.push({
+				path,
+				[data = std::move(data), file, tile, &alive]() mutable {
+					const bool success = file->writeTile(data.data(), tileSize, tile);
+					alive -= data.size();
+					List<u8>().swap(data);
+					return success;
+				},
+				[&failures](const String&, bool success, f64) { failures += !success; }
+			});
+		}
+
+		writer.wait();
+	}
+
+	RT_CHECK(failures == 0);
+	RT_CHECK(peak <= tileBytes * 4);
+
+	std::ifstream in(std::filesystem::path(path), std::ios::binary);
+
+	String magic;
+	u32 w{}, h{}, maxValue{};
+
+	RT_CHECK(in >> magic >> w >> h >> maxValue && magic == "P6" && w == width && h == height && maxValue == 255);
+	in.get();
+
+	List<u8> rgb(usz(width) * height * 3);
+	RT_CHECK(in.read((c8*) rgb.data(), std::streamsize(rgb.size())) && in.peek() == EOF);
+
+	usz mismatches{};
+
+	for (u32 y = 0; y < height; ++y)
+		for (u32 x = 0; x < width; ++x)
+			for (u32 c = 0; c < 3; ++c)
+				mismatches += rgb[(usz(y) * width + x) * 3 + c] != testValue(x, y, c);
+
+	RT_CHECK(mismatches == 0);
+
+	in.close();
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
+
+//PFM is stored bottom row first
+
+RT_TEST(tiledExportFloat) {
+
+	static constexpr u32 width = 300, height = 200, tileSize = 128;
+
+	const String path = tests::outputPath("tiled_test.pfm");
+
+	{
+		TiledImageFile file(path, width, height, true);
+
+		for (const ExportTile &tile : planExportTiles(Vec2u32(width, height), Vec2u32(tileSize, tileSize))) {
+
+			List<f32> data(usz(tileSize) * tileSize * 4);
+
+			for (u32 y = 0; y < tile.size.y; ++y)
+				for (u32 x = 0; x < tile.size.x; ++x)
+					for (u32 c = 0; c < 4; ++c)
+						data[(usz(y) * tileSize + x) * 4 + c] = f32(tile.offset.x + x) + f32(tile.offset.y + y) * 1000 + f32(c) * 0.25f;
+
+			RT_CHECK(file.writeTile((const u8*) data.data(), tileSize, tile));
+		}
+	}
+
+	tests::ReferenceImage image;
+	RT_CHECK(tests::readReferenceImage(path, image) && image.width == width && image.height == height);
+
+	usz mismatches{};
+
+	for (u32 y = 0; y < image.height; ++y)
+		for (u32 x = 0; x < image.width; ++x)
+			for (u32 c = 0; c < 3; ++c)
+				mismatches += image.rgb[(usz(y) * width + x) * 3 + c] != f32(x) + f32(y) * 1000 + f32(c) * 0.25f;
+
+	RT_CHECK(mismatches == 0);
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
\ No newline at end of file
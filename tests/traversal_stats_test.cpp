@@ -0,0 +1,138 @@
+#include "tests.hpp"
+#include "rt/traversal_stats.hpp"
+#include "rt/sampler.hpp"
+#include <cmath>
+#include <limits>
+
+using namespace igx::rt;
+
+static constexpr f32 noHit = std::numeric_limits<f32>::max();
+static constexpr u32 noRayHit = 0xFFFFFFFF;
+
+static f32 random01(u32 &state) {
+	state = hashUint(state);
+	return f32(state & 0xFFFFFF) / 0x1000000;
+}
+
+//Spheres and triangles scattered in front of the camera, some cubes and a ground plane
+
+static TraversalScene generateScene(u32 spheres, u32 triangles) {
+
+	TraversalScene scene;
+	u32 state = 1;
+
+	for (u32 i = 0; i < triangles; ++i) {
+
+		const Vec3f32 center(random01(state) * 20 - 10, random01(state) * 10 - 2, random01(state) * 20 + 5);
+
+		for (u32 k = 0; k < 3; ++k)
+			scene.triangles.push_back(center + Vec3f32(random01(state) - 0.5f, random01(state) - 0.5f, random01(state) - 0.5f));
+	}
+
+	for (u32 i = 0; i < spheres; ++i)
+		scene.spheres.push_back(Vec4f32(
+			random01(state) * 20 - 10, random01(state) * 10 - 2, random01(state) * 20 + 5, random01(state) * 0.8f + 0.2f
+		));
+
+	for (u32 i = 0; i < 8; ++i) {
+		const Vec3f32 start(random01(state) * 20 - 10, -2, random01(state) * 20 + 5);
+		scene.cubes.push_back(start);
+		scene.cubes.push_back(start + Vec3f32(1, 1 + random01(state) * 3, 1));
+	}
+
+	scene.planes.push_back(Vec4f32(0, 1, 0, -2));
+	return scene;
+}
+
+//Primaries and a shadow ray per hit towards a point light
+//Every ray walks every list, so the counts have to add up to exactly that
+
+RT_TEST(traversalCounts) {
+
+	static constexpr u32 width = 128, height = 128, spheres = 64, triangles = 256;
+
+	const TraversalScene scene = generateScene(spheres, triangles);
+	const Vec3f32 eye(0, 1, -5), light(4, 12, 10);
+
+	TraversalTracer tracer(scene);
+	u64 hits{}, occluded{};
+
+	for (u32 y = 0; y < height; ++y)
+		for (u32 x = 0; x < width; ++x) {
+
+			const Vec3f32 dir = Vec3f32(
+				(f32(x) + 0.5f) / f32(width) * 2 - 1,
+				1 - (f32(y) + 0.5f) / f32(height) * 2,
+				1.5f
+			).normalize();
+
+			u32 object;
+			const f32 hitT = tracer.traceGeometry(eye, dir, noRayHit, object);
+
+			if (hitT == noHit) {
+				RT_CHECK(object == noRayHit);
+				continue;
+			}
+
+			++hits;
+
+			const Vec3f32 hitPos = eye + dir * hitT;
+			const Vec3f32 toLight(light.x - hitPos.x, light.y - hitPos.y, light.z - hitPos.z);
+			const f32 dist = std::sqrt(toLight.x * toLight.x + toLight.y * toLight.y + toLight.z * toLight.z);
+
+			occluded += tracer.traceOcclusion(hitPos, toLight * (1 / dist), dist, object);
+		}
+
+	const u64 rays = u64(width) * height + hits;
+	const u64 primitives = triangles + spheres + scene.cubes.size() / 2 + scene.planes.size();
+
+	TraversalCounters expected;
+	expected[STAT_RAYS] = u64(width) * height;
+	expected[STAT_SHADOW_RAYS] = hits;
+	expected[STAT_PRIMITIVE_TESTS] = rays * primitives;
+	expected[STAT_NODES_VISITED] = rays * 4;
+
+	RT_CHECK(tracer.counters == expected);
+
+	//The lower half sees the ground, some of it in shadow
+
+	RT_CHECK(hits > u64(width) * height / 2 && occluded > 0 && occluded < hits);
+
+	const TraversalRates rates = traversalRates(tracer.counters, 0.5);
+
+	RT_CHECK_NEAR(rates.raysPerSecond, f64(rays) * 2, 1e-6);
+	RT_CHECK_NEAR(rates.testsPerRay, f64(primitives), 1e-9);
+	RT_CHECK_NEAR(rates.nodesPerRay, 4, 1e-9);
+	RT_CHECK_NEAR(rates.shadowRaysPerPrimary, f64(hits) / (width * height), 1e-9);
+}
+
+//Object ids are in the order of trace.glsl; triangles, spheres, cubes and planes
+
+RT_TEST(traversalObjects) {
+
+	TraversalScene scene;
+	scene.triangles = { Vec3f32(-1, -1, 5), Vec3f32(1, -1, 5), Vec3f32(0, 1, 5) };
+	scene.spheres = { Vec4f32(0, 0, 3, 0.5f) };
+	scene.cubes = { Vec3f32(4, -1, 4), Vec3f32(6, 1, 6) };
+	scene.planes = { Vec4f32(0, 1, 0, -2) };
+
+	TraversalTracer tracer(scene);
+	u32 object;
+
+	RT_CHECK_NEAR(tracer.traceGeometry(Vec3f32(0, 0, 0), Vec3f32(0, 0, 1), noRayHit, object), 2.5, 1e-5);
+	RT_CHECK(object == 1);
+
+	RT_CHECK_NEAR(tracer.traceGeometry(Vec3f32(0, 0, 0), Vec3f32(0, 0, 1), 1, object), 5, 1e-5);
+	RT_CHECK(object == 0);
+
+	RT_CHECK_NEAR(tracer.traceGeometry(Vec3f32(5, 0, 0), Vec3f32(0, 0, 1), noRayHit, object), 4, 1e-5);
+	RT_CHECK(object == 2);
+
+	RT_CHECK_NEAR(tracer.traceGeometry(Vec3f32(0, 0, 0), Vec3f32(0, -1, 0), noRayHit, object), 2, 1e-5);
+	RT_CHECK(object == 3);
+
+	RT_CHECK(tracer.traceGeometry(Vec3f32(0, 0, 0), Vec3f32(0, 1, 0), noRayHit, object) == noHit && object == noRayHit);
+
+	RT_CHECK(tracer.traceOcclusion(Vec3f32(0, 0, 0), Vec3f32(0, 0, 1), 10, noRayHit));
+	RT_CHECK(!tracer.traceOcclusion(Vec3f32(0, 0, 0), Vec3f32(0, 0, 1), 2, noRayHit));
+}
\ No newline at end of file